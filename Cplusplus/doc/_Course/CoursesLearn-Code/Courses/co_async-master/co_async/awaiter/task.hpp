@@ -337,15 +337,14 @@ struct TaskPromiseCommonBase {
     TaskPromiseCommonBase() = default;
     TaskPromiseCommonBase(TaskPromiseCommonBase &&) = delete;
 
-#if CO_ASYNC_ALLOC
+    // frames never come from currentAllocator: they may outlive it
     void *operator new(std::size_t size) {
-        return std::pmr::get_default_resource()->allocate(size);
+        return FrameAllocator::allocate(size);
     }
 
     void operator delete(void *ptr, std::size_t size) noexcept {
-        std::pmr::get_default_resource()->deallocate(ptr, size);
+        FrameAllocator::deallocate(ptr, size);
     }
-#endif
 };
 
 template <class TaskPromise>
@@ -16,6 +16,7 @@
 #include <co_async/generic/generic_io.hpp>
 #include <co_async/generic/io_context.hpp>
 #include <co_async/generic/io_context_mt.hpp>
+#include <co_async/generic/io_context_pool.hpp>
 #include <co_async/generic/mutex.hpp>
 #include <co_async/generic/queue.hpp>
 #include <co_async/generic/semaphore.hpp>
@@ -34,12 +35,15 @@
 #include <co_async/iostream/string_stream.hpp>
 #include <co_async/iostream/zlib_stream.hpp>
 #include <co_async/net/http_client.hpp>
+#include <co_async/net/http_parser.hpp>
 #include <co_async/net/http_protocol.hpp>
+#include <co_async/net/http_router.hpp>
 #include <co_async/net/http_server.hpp>
 #include <co_async/net/http_server_utils.hpp>
 #include <co_async/net/http_string_utils.hpp>
 #include <co_async/net/socket_proxy.hpp>
 #include <co_async/net/uri.hpp>
+#include <co_async/net/websocket_mask.hpp>
 #include <co_async/platform/error_handling.hpp>
 #include <co_async/platform/fs.hpp>
 #include <co_async/platform/fs_watch.hpp>
@@ -1,6 +1,18 @@
 #include <co_async/std.hpp>
 #include <co_async/generic/allocator.hpp>
 
+#if defined(__SANITIZE_ADDRESS__)
+# define CO_ASYNC_FRAME_CACHE 0
+#elif defined(__has_feature)
+# if __has_feature(address_sanitizer)
+#  define CO_ASYNC_FRAME_CACHE 0
+# endif
+#endif
+#ifndef CO_ASYNC_FRAME_CACHE
+// recycled frames would hide use-after-free from the sanitizer
+# define CO_ASYNC_FRAME_CACHE 1
+#endif
+
 namespace co_async {
 thread_local std::pmr::memory_resource *currentAllocator =
     std::pmr::new_delete_resource();
@@ -8,17 +20,32 @@ thread_local std::pmr::memory_resource *currentAllocator =
 #if CO_ASYNC_ALLOC
 namespace {
 inline struct DefaultResource : std::pmr::memory_resource {
+    // every block starts with the resource that served it, so that it goes
+    // back there even if currentAllocator has been replaced since
+    static std::size_t headerSize(std::size_t align) noexcept {
+        return std::max(align, alignof(std::max_align_t));
+    }
+
     void *do_allocate(size_t size, size_t align) override {
-        return currentAllocator->allocate(size, align);
+        auto header = headerSize(align);
+        auto resource = currentAllocator;
+        auto p = static_cast<char *>(
+            resource->allocate(size + header, std::max(align, header)));
+        p += header;
+        reinterpret_cast<std::pmr::memory_resource **>(p)[-1] = resource;
+        return p;
     }
 
     void do_deallocate(void *p, size_t size, size_t align) override {
-        return currentAllocator->deallocate(p, size, align);
+        auto header = headerSize(align);
+        auto resource = reinterpret_cast<std::pmr::memory_resource **>(p)[-1];
+        resource->deallocate(static_cast<char *>(p) - header, size + header,
+                             std::max(align, header));
     }
 
     bool do_is_equal(
         std::pmr::memory_resource const &other) const noexcept override {
-        return currentAllocator->is_equal(other);
+        return this == &other;
     }
 
     DefaultResource() noexcept {
@@ -29,4 +56,213 @@ inline struct DefaultResource : std::pmr::memory_resource {
 } defaultResource;
 } // namespace
 #endif
+
+#if CO_ASYNC_FRAME_CACHE
+namespace {
+constexpr std::size_t kFrameClasses =
+    FrameAllocator::kMaxSize / FrameAllocator::kGranularity;
+
+struct FrameCache {
+    struct Node {
+        Node *mNext;
+    };
+
+    Node *mHeads[kFrameClasses];
+    std::uint32_t mCounts[kFrameClasses];
+    bool mArmed;
+    bool mClosed;
+};
+
+// trivially destructible, so still usable by frames freed while the thread
+// is being torn down
+constinit thread_local FrameCache frameCache{};
+
+struct FrameCacheDrain {
+    void arm() noexcept {
+        frameCache.mArmed = true;
+    }
+
+    ~FrameCacheDrain() {
+        frameCache.mClosed = true;
+        for (std::size_t c = 0; c < kFrameClasses; ++c) {
+            while (auto node = frameCache.mHeads[c]) {
+                frameCache.mHeads[c] = node->mNext;
+                ::operator delete(node, (c + 1) * FrameAllocator::kGranularity);
+            }
+            frameCache.mCounts[c] = 0;
+        }
+    }
+};
+
+thread_local FrameCacheDrain frameCacheDrain;
+} // namespace
+
+void *FrameAllocator::allocate(std::size_t size) {
+    if (size > kMaxSize) [[unlikely]] {
+        return ::operator new(size);
+    }
+    auto c = (size - 1) / kGranularity;
+    auto &cache = frameCache;
+    if (auto node = cache.mHeads[c]) [[likely]] {
+        cache.mHeads[c] = node->mNext;
+        --cache.mCounts[c];
+        return node;
+    }
+    return ::operator new((c + 1) * kGranularity);
+}
+
+void FrameAllocator::deallocate(void *p, std::size_t size) noexcept {
+    if (size > kMaxSize) [[unlikely]] {
+        ::operator delete(p, size);
+        return;
+    }
+    auto c = (size - 1) / kGranularity;
+    auto &cache = frameCache;
+    if (cache.mClosed || cache.mCounts[c] == kMaxCached) [[unlikely]] {
+        ::operator delete(p, (c + 1) * kGranularity);
+        return;
+    }
+    if (!cache.mArmed) [[unlikely]] {
+        frameCacheDrain.arm();
+    }
+    auto node = static_cast<FrameCache::Node *>(p);
+    node->mNext = cache.mHeads[c];
+    cache.mHeads[c] = node;
+    ++cache.mCounts[c];
+}
+#else
+void *FrameAllocator::allocate(std::size_t size) {
+    return ::operator new(size);
+}
+
+void FrameAllocator::deallocate(void *p, std::size_t size) noexcept {
+    ::operator delete(p, size);
+}
+#endif
+
+#if CO_ASYNC_FRAME_CACHE
+namespace {
+struct ChunkCache {
+    struct Node {
+        Node *mNext;
+    };
+
+    Node *mHead;
+    std::size_t mCount;
+    bool mArmed;
+    bool mClosed;
+};
+
+// same arrangement as frameCache: arenas destroyed during thread teardown
+// may still hand their chunks in
+constinit thread_local ChunkCache chunkCache{};
+
+struct ChunkCacheDrain {
+    void arm() noexcept {
+        chunkCache.mArmed = true;
+    }
+
+    ~ChunkCacheDrain() {
+        chunkCache.mClosed = true;
+        while (auto node = chunkCache.mHead) {
+            chunkCache.mHead = node->mNext;
+            std::pmr::new_delete_resource()->deallocate(
+                node, ArenaResource::kDefaultChunkSize,
+                alignof(std::max_align_t));
+        }
+        chunkCache.mCount = 0;
+    }
+};
+
+thread_local ChunkCacheDrain chunkCacheDrain;
+} // namespace
+#endif
+
+bool ArenaResource::cacheable() const noexcept {
+#if CO_ASYNC_FRAME_CACHE
+    return mChunkSize == kDefaultChunkSize &&
+           mUpstream == std::pmr::new_delete_resource();
+#else
+    return false;
+#endif
+}
+
+ArenaResource::~ArenaResource() {
+    reset();
+}
+
+void ArenaResource::useChunk(Chunk *chunk) noexcept {
+    mCurrent = chunk;
+    mPtr = reinterpret_cast<char *>(chunk + 1);
+    mEnd = reinterpret_cast<char *>(chunk) + chunk->mSize;
+}
+
+void ArenaResource::reset() noexcept {
+    bool cache = cacheable();
+    while (auto chunk = mFirst) {
+        mFirst = chunk->mNext;
+#if CO_ASYNC_FRAME_CACHE
+        if (cache && chunk->mSize == kDefaultChunkSize &&
+            !chunkCache.mClosed && chunkCache.mCount < kMaxCachedChunks)
+            [[likely]] {
+            if (!chunkCache.mArmed) [[unlikely]] {
+                chunkCacheDrain.arm();
+            }
+            auto node = reinterpret_cast<ChunkCache::Node *>(chunk);
+            node->mNext = chunkCache.mHead;
+            chunkCache.mHead = node;
+            ++chunkCache.mCount;
+            continue;
+        }
+#endif
+        mUpstream->deallocate(chunk, chunk->mSize, alignof(std::max_align_t));
+    }
+    mCurrent = nullptr;
+    mPtr = nullptr;
+    mEnd = nullptr;
+}
+
+void *ArenaResource::do_allocate(std::size_t size, std::size_t align) {
+    while (true) {
+        if (mCurrent) {
+            auto p = reinterpret_cast<char *>(
+                (reinterpret_cast<std::uintptr_t>(mPtr) + align - 1) &
+                ~(align - 1));
+            if (p <= mEnd && size <= std::size_t(mEnd - p)) [[likely]] {
+                mPtr = p + size;
+                return p;
+            }
+        }
+        auto bytes = std::max(mChunkSize, sizeof(Chunk) + size + align);
+        Chunk *chunk;
+#if CO_ASYNC_FRAME_CACHE
+        if (bytes == kDefaultChunkSize && chunkCache.mHead && cacheable()) {
+            auto node = chunkCache.mHead;
+            chunkCache.mHead = node->mNext;
+            --chunkCache.mCount;
+            chunk = reinterpret_cast<Chunk *>(node);
+        } else
+#endif
+        {
+            chunk = static_cast<Chunk *>(
+                mUpstream->allocate(bytes, alignof(std::max_align_t)));
+        }
+        chunk->mNext = nullptr;
+        chunk->mSize = bytes;
+        if (mCurrent) {
+            mCurrent->mNext = chunk;
+        } else {
+            mFirst = chunk;
+        }
+        useChunk(chunk);
+    }
+}
+
+void ArenaResource::do_deallocate(void *p, std::size_t size,
+                                  std::size_t align) {}
+
+bool ArenaResource::do_is_equal(
+    std::pmr::memory_resource const &other) const noexcept {
+    return this == &other;
+}
 } // namespace co_async
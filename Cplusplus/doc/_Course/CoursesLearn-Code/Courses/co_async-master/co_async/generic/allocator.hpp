@@ -30,4 +30,62 @@ private:
     std::pmr::memory_resource *lastAllocator;
 };
 
+// Size-class cache for coroutine frames: a freed frame is kept on a
+// thread-local free list and handed to the next frame of its class created
+// on that thread, so steady-state coroutine calls never reach malloc. Frames
+// may be freed on another thread than the one that allocated them; they then
+// join that thread's lists. Frames larger than kMaxSize bypass the cache.
+struct FrameAllocator {
+    static constexpr std::size_t kGranularity = 64;
+    static constexpr std::size_t kMaxSize = 4096;
+    // frames kept per class and thread before they go back to operator delete
+    static constexpr std::size_t kMaxCached = 256;
+
+    static void *allocate(std::size_t size);
+    static void deallocate(void *p, std::size_t size) noexcept;
+};
+
+// Bump allocator over chunks obtained from an upstream resource. deallocate
+// is a no-op; reset() frees every chunk at once, so an arena between two
+// uses holds no memory. Default-sized chunks from new_delete_resource go to
+// a thread-local free list instead of upstream, and the next arena to grow
+// on that thread takes them from there.
+struct ArenaResource : std::pmr::memory_resource {
+    static constexpr std::size_t kDefaultChunkSize = 16384;
+    // chunks kept per thread before they go back upstream
+    static constexpr std::size_t kMaxCachedChunks = 64;
+
+    explicit ArenaResource(std::size_t chunkSize = kDefaultChunkSize,
+                           std::pmr::memory_resource *upstream =
+                               std::pmr::new_delete_resource()) noexcept
+        : mChunkSize(chunkSize),
+          mUpstream(upstream) {}
+
+    ArenaResource(ArenaResource &&) = delete;
+    ~ArenaResource() override;
+
+    void reset() noexcept;
+
+private:
+    struct Chunk {
+        Chunk *mNext;
+        std::size_t mSize;
+    };
+
+    Chunk *mFirst = nullptr;
+    Chunk *mCurrent = nullptr;
+    char *mPtr = nullptr;
+    char *mEnd = nullptr;
+    std::size_t mChunkSize;
+    std::pmr::memory_resource *mUpstream;
+
+    bool cacheable() const noexcept;
+    void useChunk(Chunk *chunk) noexcept;
+    void *do_allocate(std::size_t size, std::size_t align) override;
+    void do_deallocate(void *p, std::size_t size,
+                       std::size_t align) override;
+    bool do_is_equal(
+        std::pmr::memory_resource const &other) const noexcept override;
+};
+
 } // namespace co_async
@@ -14,8 +14,37 @@ namespace co_async {
 GenericIOContext::GenericIOContext() = default;
 GenericIOContext::~GenericIOContext() = default;
 
+void GenericIOContext::setupTimerWheel(
+    std::chrono::steady_clock::duration tick) {
+    mWheel = std::make_unique<TimerWheel<TimerNode>>();
+    mWheelTick = tick;
+    mWheelOrigin = std::chrono::steady_clock::now();
+}
+
+std::optional<std::chrono::steady_clock::duration>
+GenericIOContext::runWheel() {
+    auto now = std::chrono::steady_clock::now();
+    // every timer due by the tick now falls in fires in one batch; a tick
+    // not yet complete is left for the next call
+    auto elapsed = std::uint64_t((now - mWheelOrigin) / mWheelTick);
+    mWheel->advance(elapsed, [](TimerNode &promise) {
+        promise.mCancelled = false;
+        std::coroutine_handle<TimerNode>::from_promise(promise).resume();
+    });
+    auto next = mWheel->nextTick();
+    if (!next) {
+        return std::nullopt;
+    }
+    auto expires = mWheelOrigin + std::int64_t(*next) * mWheelTick;
+    return std::max(expires - std::chrono::steady_clock::now(),
+                    std::chrono::steady_clock::duration::zero());
+}
+
 std::optional<std::chrono::steady_clock::duration>
 GenericIOContext::runDuration() {
+    if (mWheelTick.count()) {
+        return runWheel();
+    }
     while (true) {
         if (!mTimers.empty()) {
             auto &promise = mTimers.front();
@@ -10,19 +10,27 @@
 #include <co_async/utils/rbtree.hpp>
 #include <co_async/utils/ring_queue.hpp>
 #include <co_async/utils/spin_mutex.hpp>
+#include <co_async/utils/timer_wheel.hpp>
 #include <co_async/utils/uninitialized.hpp>
 
 namespace co_async {
 struct IOContext;
 
 struct GenericIOContext {
+    // queued in the rb-tree or in the timer wheel, whichever the context
+    // was set up with
     struct TimerNode : CustomPromise<Expected<>, TimerNode>,
-                       RbTree<TimerNode>::NodeType {
-        using RbTree<TimerNode>::NodeType::erase_from_parent;
+                       RbTree<TimerNode>::NodeType,
+                       TimerWheel<TimerNode>::NodeType {
         std::chrono::steady_clock::time_point mExpires;
         CancelToken mCancelToken;
         bool mCancelled = false;
 
+        void erase_from_parent() {
+            RbTree<TimerNode>::NodeType::erase_from_parent();
+            TimerWheel<TimerNode>::NodeType::erase_from_parent();
+        }
+
         void doCancel() {
             mCancelled = true;
             erase_from_parent();
@@ -61,9 +69,18 @@ struct GenericIOContext {
     // }
 
     [[gnu::hot]] void enqueueTimerNode(TimerNode &promise) {
-        mTimers.insert(promise);
+        if (mWheelTick.count()) {
+            mWheel->insert(promise, wheelTickAt(promise.mExpires));
+        } else {
+            mTimers.insert(promise);
+        }
     }
 
+    // moves timers from the rb-tree to a timer wheel of this granularity:
+    // O(1) to arm and cancel, but timers fire on the first tick at or after
+    // their expiry, so up to one tick late; call before any timer is armed
+    void setupTimerWheel(std::chrono::steady_clock::duration tick);
+
     GenericIOContext();
     ~GenericIOContext();
 
@@ -72,6 +89,21 @@ struct GenericIOContext {
 
 private:
     RbTree<TimerNode> mTimers;
+    std::unique_ptr<TimerWheel<TimerNode>> mWheel;
+    std::chrono::steady_clock::duration mWheelTick{};
+    std::chrono::steady_clock::time_point mWheelOrigin;
+
+    // the first wheel tick at or after time
+    std::uint64_t wheelTickAt(std::chrono::steady_clock::time_point time) const {
+        if (time <= mWheelOrigin) {
+            return 0;
+        }
+        return std::uint64_t((time - mWheelOrigin + mWheelTick -
+                              std::chrono::steady_clock::duration(1)) /
+                             mWheelTick);
+    }
+
+    std::optional<std::chrono::steady_clock::duration> runWheel();
 };
 
 inline void GenericIOContext::TimerNode::Awaiter::await_suspend(
@@ -5,6 +5,7 @@
 #include <co_async/platform/futex.hpp>
 #include <co_async/platform/platform_io.hpp>
 #include <co_async/utils/cacheline.hpp>
+#include <sys/eventfd.h>
 
 namespace co_async {
 
@@ -19,47 +20,87 @@ IOContext::IOContext(IOContextOptions options) {
         PlatformIOContext::schedSetThreadAffinity(*options.threadAffinity);
     }
     mPlatformIO.setup(options.queueEntries);
+    if (options.providedBuffers) {
+        mPlatformIO.setupProvidedBuffers(options.providedBuffers,
+                                         options.providedBufferSize);
+    }
+    if (options.timerWheelTick.count()) {
+        mGenericIO.setupTimerWheel(options.timerWheelTick);
+    }
     mMaxSleep = options.maxSleep;
+    if (options.crossThreadWakeUp) {
+        mWakeFd = throwingErrorErrno(eventfd(0, EFD_CLOEXEC));
+        auto watchDog = watchDogTask();
+        mWatchDog = watchDog.release();
+        mWatchDog.resume();
+    }
 }
 
 IOContext::~IOContext() {
+    // the watch dog may still be parked on its eventfd read when the loop
+    // stopped before reaping it; the ring teardown cancels the read
+    if (mWatchDog) {
+        mWatchDog.destroy();
+    }
+    if (mWakeFd != -1) {
+        close(mWakeFd);
+    }
     IOContext::instance = nullptr;
     GenericIOContext::instance = nullptr;
     PlatformIOContext::instance = nullptr;
 }
 
 void IOContext::run() {
-    while (runOnce())
+    while (!mStopRequested.load(std::memory_order_relaxed) && runOnce())
         ;
 }
 
 bool IOContext::runOnce() {
+    mInbox.drain([](std::coroutine_handle<> coroutine) {
+        coroutine.resume();
+    });
     auto duration = mGenericIO.runDuration();
-    if (!duration && !mPlatformIO.hasPendingEvents()) [[unlikely]] {
+    if (!duration && !mPlatformIO.hasPendingEvents() && mInbox.empty())
+        [[unlikely]] {
         return false;
     }
-    if (!duration || *duration > mMaxSleep) {
+    if (!mInbox.empty()) {
+        duration = std::chrono::steady_clock::duration::zero();
+    } else if (!duration || *duration > mMaxSleep) {
         duration = mMaxSleep;
     }
     mPlatformIO.waitEventsFor(duration);
     return true;
 }
 
+void IOContext::requestStop() {
+    mStopRequested.store(true, std::memory_order_relaxed);
+    wakeUp();
+}
+
 thread_local IOContext *IOContext::instance;
 
-// void IOContext::wakeUp() {
-//     if (mWake.fetch_add(1, std::memory_order_relaxed) == 0)
-//         futex_notify_sync(&mWake, 1);
-// }
-//
-// Task<void, IgnoreReturnPromise<AutoDestroyFinalAwaiter>>
-// IOContext::watchDogTask() {
-//     // helps wake up main loop when IOContext::spawn called
-//     while (true) {
-//         while (mWake.load(std::memory_order_relaxed) == 0)
-//             (void)co_await futex_wait(&mWake, 0);
-//         mWake.store(0, std::memory_order_relaxed);
-//     }
-// }
+void IOContext::wakeUp() {
+    // one eventfd write per sleep is enough: the flag is cleared by the
+    // watch dog before the loop drains the inbox again
+    if (mWakeFd != -1 && !mWakePending.exchange(true)) {
+        std::uint64_t one = 1;
+        (void)!write(mWakeFd, &one, sizeof(one));
+    }
+}
+
+Task<void, IgnoreReturnPromise<AutoDestroyFinalAwaiter>>
+IOContext::watchDogTask() {
+    // helps wake up main loop when IOContext::spawn called
+    while (!mStopRequested.load(std::memory_order_relaxed)) {
+        (void)co_await UringOp().prep_read(
+            mWakeFd,
+            std::span<char>(reinterpret_cast<char *>(&mWakeValue),
+                            sizeof(mWakeValue)),
+            0);
+        mWakePending.store(false);
+    }
+    mWatchDog = nullptr;
+}
 
 } // namespace co_async
@@ -4,6 +4,8 @@
 #include <co_async/generic/generic_io.hpp>
 #include <co_async/platform/platform_io.hpp>
 #include <co_async/utils/cacheline.hpp>
+#include <co_async/utils/concurrent_queue.hpp>
+#include <co_async/utils/uninitialized.hpp>
 
 namespace co_async {
 struct IOContextOptions {
@@ -11,6 +13,17 @@ struct IOContextOptions {
         std::chrono::milliseconds(200);
     std::optional<std::size_t> threadAffinity = std::nullopt;
     std::size_t queueEntries = 512;
+    // keep an eventfd read armed so that spawn() from other threads wakes
+    // the reactor at once instead of after up to maxSleep
+    bool crossThreadWakeUp = false;
+    // size of the kernel provided buffer ring socket streams receive into,
+    // 0 to give each stream its own private buffer instead
+    std::size_t providedBuffers = 0;
+    std::size_t providedBufferSize = 8192;
+    // keep timers in a hierarchical timer wheel of this granularity instead
+    // of an rb-tree: cheaper when many timeouts are armed and cancelled,
+    // but timers fire up to one tick late; zero to keep the rb-tree
+    std::chrono::steady_clock::duration timerWheelTick{};
 };
 
 struct alignas(hardware_destructive_interference_size) IOContext {
@@ -18,6 +31,15 @@ private:
     GenericIOContext mGenericIO;
     PlatformIOContext mPlatformIO;
     std::chrono::steady_clock::duration mMaxSleep;
+    ConcurrentMPSCQueue<std::coroutine_handle<>> mInbox;
+    std::atomic<bool> mWakePending{false};
+    std::atomic<bool> mStopRequested{false};
+    int mWakeFd = -1;
+    std::uint64_t mWakeValue = 0;
+    std::coroutine_handle<> mWatchDog;
+
+    void wakeUp();
+    Task<void, IgnoreReturnPromise<AutoDestroyFinalAwaiter>> watchDogTask();
 
 public:
     explicit IOContext(IOContextOptions options = {});
@@ -27,21 +49,31 @@ public:
     [[gnu::hot]] void run();
     [[gnu::hot]] bool runOnce();
 
-    // [[gnu::hot]] void spawn(std::coroutine_handle<> coroutine) {
-    //     coroutine.resume();
-    // }
-    //
-    // template <class T, class P>
-    // void spawn(Task<T, P> task) {
-    //     auto wrapped = coSpawnStarter(std::move(task));
-    //     wrapped.get().resume();
-    //     wrapped.release();
-    // }
-    //
-    // template <class T, class P>
-    // T join(Task<T, P> task) {
-    //     return contextJoin(*this, std::move(task));
-    // }
+    // makes run() return after the current iteration /* MT-safe */
+    void requestStop();
+
+    [[nodiscard]] bool stopRequested() const noexcept /* MT-safe */ {
+        return mStopRequested.load(std::memory_order_relaxed);
+    }
+
+    // resumes coroutine on this context's thread /* MT-safe */
+    [[gnu::hot]] void spawn(std::coroutine_handle<> coroutine) {
+        mInbox.push(std::move(coroutine));
+        if (instance != this) {
+            wakeUp();
+        }
+    }
+
+    template <class T, class P>
+    void spawn(Task<T, P> task) /* MT-safe */ {
+        auto wrapped = coSpawnStarter(std::move(task));
+        spawn(std::coroutine_handle<>(wrapped.release()));
+    }
+
+    // runs task on this context and blocks the calling thread until it
+    // finishes; must not be called from this context's own thread
+    template <class T, class P>
+    T join(Task<T, P> task) /* MT-safe */;
 
     static thread_local IOContext *instance;
 };
@@ -66,71 +98,77 @@ inline void co_main(Task<> main) {
     ctx.run();
 }
 
-// template <class T, class P>
-// inline Task<> contextJoinHelper(Task<T, P> task, std::condition_variable &cv,
-//                                 Uninitialized<T> &result
-// #if CO_ASYNC_EXCEPT
-//                                 ,
-//                                 std::exception_ptr exception
-// #endif
-// ) {
-// #if CO_ASYNC_EXCEPT
-//     try {
-// #endif
-//         result.emplace((co_await task, Void()));
-// #if CO_ASYNC_EXCEPT
-//     } catch (...) {
-// # if CO_ASYNC_DEBUG
-//         std::cerr << "WARNING: exception occurred in IOContext::join\n";
-// # endif
-//         exception = std::current_exception();
-//     }
-// #endif
-//     cv.notify_one();
-// }
-//
-// template <class T, class P>
-// T contextJoin(IOContext &context, Task<T, P> task) {
-//     std::condition_variable cv;
-//     std::mutex mtx;
-//     Uninitialized<T> result;
-// #if CO_ASYNC_EXCEPT
-//     std::exception_ptr exception;
-// #endif
-//     context.spawn(contextJoinHelper(std::move(task), cv, result
-// #if CO_ASYNC_EXCEPT
-//                                     ,
-//                                     exception
-// #endif
-//                                     ));
-//     std::unique_lock lck(mtx);
-//     cv.wait(lck);
-//     lck.unlock();
-// #if CO_ASYNC_EXCEPT
-//     if (exception) [[unlikely]] {
-//         std::rethrow_exception(exception);
-//     }
-// #endif
-//     if constexpr (!std::is_void_v<T>) {
-//         return result.move();
-//     }
-// }
-//
-// inline auto co_resume_on(IOContext &context) {
-//     struct ResumeOnAwaiter {
-//         bool await_ready() const noexcept {
-//             return false;
-//         }
-//
-//         void await_suspend(std::coroutine_handle<> coroutine) const {
-//             mContext.spawn(coroutine);
-//         }
-//
-//         void await_resume() const noexcept {}
-//
-//         IOContext &mContext;
-//     };
-//
-//     return ResumeOnAwaiter(context);
-// }
+template <class T, class P>
+inline Task<> contextJoinHelper(Task<T, P> task, std::mutex &mtx,
+                                std::condition_variable &cv, bool &done,
+                                Uninitialized<T> &result
+#if CO_ASYNC_EXCEPT
+                                ,
+                                std::exception_ptr &exception
+#endif
+) {
+#if CO_ASYNC_EXCEPT
+    try {
+#endif
+        result.emplace((co_await task, Void()));
+#if CO_ASYNC_EXCEPT
+    } catch (...) {
+# if CO_ASYNC_DEBUG
+        std::cerr << "WARNING: exception occurred in IOContext::join\n";
+# endif
+        exception = std::current_exception();
+    }
+#endif
+    std::lock_guard lck(mtx);
+    done = true;
+    cv.notify_one();
+}
+
+template <class T, class P>
+T IOContext::join(Task<T, P> task) {
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool done = false;
+    Uninitialized<T> result;
+#if CO_ASYNC_EXCEPT
+    std::exception_ptr exception;
+#endif
+    spawn(contextJoinHelper(std::move(task), mtx, cv, done, result
+#if CO_ASYNC_EXCEPT
+                            ,
+                            exception
+#endif
+                            ));
+    std::unique_lock lck(mtx);
+    cv.wait(lck, [&done] { return done; });
+    lck.unlock();
+#if CO_ASYNC_EXCEPT
+    if (exception) [[unlikely]] {
+        std::rethrow_exception(exception);
+    }
+#endif
+    if constexpr (!std::is_void_v<T>) {
+        return result.move();
+    }
+}
+
+// migrates the awaiting coroutine to context: everything after the
+// co_await runs on that context's thread
+inline auto co_resume_on(IOContext &context) {
+    struct ResumeOnAwaiter {
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> coroutine) const {
+            mContext.spawn(coroutine);
+        }
+
+        void await_resume() const noexcept {}
+
+        IOContext &mContext;
+    };
+
+    return ResumeOnAwaiter(context);
+}
 } // namespace co_async
@@ -0,0 +1,78 @@
+#include <co_async/std.hpp>
+#include <co_async/generic/io_context.hpp>
+#include <co_async/generic/io_context_pool.hpp>
+
+namespace co_async {
+IOContextPool::IOContextPool(IOContextPoolOptions options) {
+    std::size_t numCores = std::thread::hardware_concurrency();
+    if (!numCores) [[unlikely]] {
+        numCores = 1;
+    }
+    std::size_t numWorkers = options.numWorkers ? options.numWorkers : numCores;
+    std::size_t firstCore = options.context.threadAffinity.value_or(0);
+
+    mContexts.resize(numWorkers, nullptr);
+    mThreads.reserve(numWorkers);
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::size_t numReady = 0;
+    std::exception_ptr failure;
+
+    for (std::size_t i = 0; i < numWorkers; ++i) {
+        IOContextOptions contextOptions = options.context;
+        contextOptions.crossThreadWakeUp = true;
+        if (options.pinThreads) {
+            contextOptions.threadAffinity = (firstCore + i) % numCores;
+        } else {
+            contextOptions.threadAffinity = std::nullopt;
+        }
+        mThreads.emplace_back([this, i, contextOptions, &mtx, &cv, &numReady,
+                               &failure] {
+            std::optional<IOContext> ctx;
+            try {
+                ctx.emplace(contextOptions);
+            } catch (...) {
+                std::lock_guard lck(mtx);
+                failure = std::current_exception();
+                ++numReady;
+                cv.notify_one();
+                return;
+            }
+            {
+                std::lock_guard lck(mtx);
+                mContexts[i] = &*ctx;
+                ++numReady;
+                cv.notify_one();
+            }
+            ctx->run();
+            // stop() may still be signalling this context
+            mStopIssued.wait(false);
+        });
+    }
+
+    std::unique_lock lck(mtx);
+    cv.wait(lck, [&] { return numReady == numWorkers; });
+    lck.unlock();
+    if (failure) [[unlikely]] {
+        stop();
+        std::rethrow_exception(failure);
+    }
+}
+
+IOContextPool::~IOContextPool() {
+    stop();
+}
+
+void IOContextPool::stop() {
+    for (auto *context: mContexts) {
+        if (context) {
+            context->requestStop();
+        }
+    }
+    mStopIssued.store(true);
+    mStopIssued.notify_all();
+    mThreads.clear();
+    std::fill(mContexts.begin(), mContexts.end(), nullptr);
+}
+} // namespace co_async
@@ -0,0 +1,65 @@
+#pragma once
+#include <co_async/std.hpp>
+#include <co_async/awaiter/task.hpp>
+#include <co_async/generic/io_context.hpp>
+
+namespace co_async {
+struct IOContextPoolOptions {
+    // 0 means one reactor per hardware thread
+    std::size_t numWorkers = 0;
+    // pin reactor i to core (context.threadAffinity.value_or(0) + i) %
+    // hardware threads
+    bool pinThreads = true;
+    IOContextOptions context = {};
+};
+
+// N io_uring reactors, one thread and one IOContext each. Work is posted to a
+// reactor through its lock-free inbox and the reactor is woken through its
+// eventfd, so spawn(), join() and co_resume_on() are safe from any thread.
+struct IOContextPool {
+private:
+    std::vector<IOContext *> mContexts;
+    std::vector<std::jthread> mThreads;
+    std::atomic<std::size_t> mNext{0};
+    std::atomic<bool> mStopIssued{false};
+
+public:
+    explicit IOContextPool(IOContextPoolOptions options = {});
+    IOContextPool(IOContextPool &&) = delete;
+    ~IOContextPool();
+
+    std::size_t size() const noexcept {
+        return mContexts.size();
+    }
+
+    IOContext &context(std::size_t index) const noexcept {
+        return *mContexts[index];
+    }
+
+    // round robin /* MT-safe */
+    IOContext &next() noexcept {
+        return *mContexts[mNext.fetch_add(1, std::memory_order_relaxed) %
+                          mContexts.size()];
+    }
+
+    template <class T, class P>
+    void spawn(Task<T, P> task) /* MT-safe */ {
+        next().spawn(std::move(task));
+    }
+
+    template <class T, class P>
+    void spawn(std::size_t index, Task<T, P> task) /* MT-safe */ {
+        context(index).spawn(std::move(task));
+    }
+
+    template <class T, class P>
+    T join(Task<T, P> task) /* MT-safe */ {
+        return next().join(std::move(task));
+    }
+
+    // asks every reactor to stop and waits for their threads to exit; any
+    // coroutines still suspended on them are abandoned and nothing may be
+    // spawned afterwards
+    void stop();
+};
+} // namespace co_async
@@ -1,132 +1,235 @@
 #include <co_async/awaiter/task.hpp>
 #include <co_async/generic/thread_pool.hpp>
 #include <co_async/platform/futex.hpp>
+#include <co_async/utils/cacheline.hpp>
 
 namespace co_async {
 
-struct ThreadPool::Thread {
-    std::function<void()> mTask;
-    std::condition_variable mCV;
-    std::mutex mMutex;
-    ThreadPool *mPool;
+// lives in the frame of the coroutine awaiting it, so submitting a job
+// allocates nothing; mNext links it into a worker queue first and into its
+// port's finished list after it ran
+struct ThreadPool::Job {
+    Job *mNext = nullptr;
+    void (*mInvoke)(void *);
+    void *mArg;
+    std::exception_ptr mException;
+    std::coroutine_handle<> mWaiter;
+    Port *mPort = nullptr;
+};
+
+struct alignas(hardware_destructive_interference_size) ThreadPool::Worker {
+    SpinMutex mMutex;
+    Job *mHead = nullptr;
+    Job *mTail = nullptr;
     std::jthread mThread;
 
-    ~Thread() {
-        mThread.request_stop();
-        mCV.notify_one();
-        mThread.join();
+    void push(Job &job) {
+        std::lock_guard lock(mMutex);
+        job.mNext = nullptr;
+        if (mTail) {
+            mTail->mNext = &job;
+        } else {
+            mHead = &job;
+        }
+        mTail = &job;
     }
 
-    void startMain(std::stop_token stop) {
-        while (!stop.stop_requested()) [[likely]] {
-            std::unique_lock lock(mMutex);
-            mCV.wait(lock,
-                     [&] { return mTask != nullptr || stop.stop_requested(); });
-            if (stop.stop_requested()) [[unlikely]] {
-                return;
+    Job *pop() {
+        std::lock_guard lock(mMutex);
+        Job *job = mHead;
+        if (job) {
+            mHead = job->mNext;
+            if (!mHead) {
+                mTail = nullptr;
             }
-            auto task = std::exchange(mTask, nullptr);
-            lock.unlock();
-            task();
-            lock.lock();
-            mTask = nullptr;
-            std::unique_lock workingLock(mPool->mWorkingMutex);
-            mPool->mWorkingThreads.remove(this);
-            workingLock.unlock();
-            std::lock_guard freeLock(mPool->mFreeMutex);
-            mPool->mFreeThreads.push_back(this);
         }
+        return job;
     }
+};
 
-    explicit Thread(ThreadPool *pool) {
-        mPool = pool;
-        mThread =
-            std::jthread([this](std::stop_token stop) { startMain(stop); });
-    }
+// where the workers hand finished jobs back to one IOContext: a lock-free
+// stack only the first job of a batch has to wake the context for, and a
+// collector coroutine on that context resuming every waiter of a batch at
+// once; the collector keeps a futex wait pending, and so the context
+// running, while the context has jobs in flight
+struct ThreadPool::Port {
+    std::atomic<Job *> mFinished{nullptr};
+    FutexAtomic<std::uint32_t> mPosted{0};
+    // only touched on the context's own thread
+    std::size_t mInFlight = 0;
+    bool mCollecting = false;
+};
 
-    Thread(Thread &&) = delete;
+struct ThreadPool::JobAwaiter {
+    ThreadPool *mPool;
+    Job &mJob;
 
-    void workOn(std::function<void()> func) {
-        std::lock_guard lock(mMutex);
-        mTask = std::move(func);
-        mCV.notify_one();
+    bool await_ready() const noexcept {
+        return false;
     }
+
+    void await_suspend(std::coroutine_handle<> coroutine) const {
+        mJob.mWaiter = coroutine;
+        mPool->submitJob(mJob);
+    }
+
+    void await_resume() const noexcept {}
 };
 
-ThreadPool::Thread *ThreadPool::submitJob(std::function<void()> func) {
-    std::unique_lock freeLock(mFreeMutex);
-    if (mFreeThreads.empty()) {
-        freeLock.unlock();
-        std::unique_lock threadsLock(mThreadsMutex);
-        // list 保证插入后元素的指针和引用永远不会失效
-        // 所以在这里获取地址并存入其他链表是安全的：
-        Thread *newThread = &mThreads.emplace_back(this);
-        threadsLock.unlock();
-        newThread->workOn(std::move(func));
-        std::lock_guard workingLock(mWorkingMutex);
-        mWorkingThreads.push_back(newThread);
-        return newThread;
-    } else {
-        Thread *freeThread = std::move(mFreeThreads.front());
-        mFreeThreads.pop_front();
-        freeLock.unlock();
-        freeThread->workOn(std::move(func));
-        std::lock_guard workingLock(mWorkingMutex);
-        mWorkingThreads.push_back(freeThread);
-        return freeThread;
+namespace {
+thread_local ThreadPool *currentPool = nullptr;
+thread_local std::size_t currentWorker = 0;
+} // namespace
+
+void ThreadPool::submitJob(Job &job) {
+    std::unique_lock portsLock(mPortsMutex);
+    auto &port = mPorts[IOContext::instance];
+    if (!port) {
+        port = std::make_unique<Port>();
+    }
+    portsLock.unlock();
+    job.mPort = port.get();
+    ++port->mInFlight;
+    if (!port->mCollecting) {
+        port->mCollecting = true;
+        co_spawn(collectJobs(*port));
+    }
+    // a job submitted from a worker stays on that worker's queue, others
+    // are spread round robin and rebalanced by stealing
+    auto target = currentPool == this
+                      ? currentWorker
+                      : mNextWorker.fetch_add(1, std::memory_order_relaxed) %
+                            mNumWorkers;
+    mWorkers[target].push(job);
+    mSignal.fetch_add(1, std::memory_order_seq_cst);
+    if (mSleepers.load(std::memory_order_seq_cst) != 0) {
+        (void)futex_notify_sync(&mSignal, 1);
     }
 }
 
-Task<Expected<>> ThreadPool::rawRun(std::function<void()> func) {
-    auto ready = std::make_shared<FutexAtomic<bool>>(false);
-    std::exception_ptr ep;
-    submitJob([ready, func = std::move(func), &ep]() mutable {
+ThreadPool::Job *ThreadPool::takeJob(std::size_t self) {
+    for (std::size_t i = 0; i < mNumWorkers; ++i) {
+        if (Job *job = mWorkers[(self + i) % mNumWorkers].pop()) {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void ThreadPool::workerMain(std::size_t self, std::stop_token stop) {
+    currentPool = this;
+    currentWorker = self;
+    while (true) {
+        // read before looking for work: a submit after the look changes it,
+        // and the futex wait below then returns at once
+        auto signal = mSignal.load(std::memory_order_seq_cst);
+        Job *job = takeJob(self);
+        if (!job) {
+            if (stop.stop_requested()) {
+                return;
+            }
+            mSleepers.fetch_add(1, std::memory_order_seq_cst);
+            (void)futex_wait_sync(&mSignal, signal);
+            mSleepers.fetch_sub(1, std::memory_order_relaxed);
+            continue;
+        }
+        mWorkingCount.fetch_add(1, std::memory_order_relaxed);
         try {
-            func();
+            job->mInvoke(job->mArg);
         } catch (...) {
-            ep = std::current_exception();
+            job->mException = std::current_exception();
+        }
+        mWorkingCount.fetch_sub(1, std::memory_order_relaxed);
+        postJob(*job);
+    }
+}
+
+void ThreadPool::postJob(Job &job) {
+    Port &port = *job.mPort;
+    auto head = port.mFinished.load(std::memory_order_relaxed);
+    do {
+        job.mNext = head;
+    } while (!port.mFinished.compare_exchange_weak(
+        head, &job, std::memory_order_release, std::memory_order_relaxed));
+    // the job may be resumed and gone from here on
+    if (!head) {
+        port.mPosted.fetch_add(1, std::memory_order_release);
+        (void)futex_notify_sync(&port.mPosted, 1);
+    }
+}
+
+Task<> ThreadPool::collectJobs(Port &port) {
+    while (port.mInFlight != 0) {
+        // read before taking the batch: a job posted after the exchange
+        // changes it, and the futex wait below then returns at once
+        auto posted = port.mPosted.load(std::memory_order_acquire);
+        Job *batch = port.mFinished.exchange(nullptr, std::memory_order_acquire);
+        if (!batch) {
+            (void)co_await futex_wait(&port.mPosted, posted);
+            continue;
+        }
+        // the stack holds the batch newest first
+        Job *ordered = nullptr;
+        while (batch) {
+            auto next = batch->mNext;
+            batch->mNext = ordered;
+            ordered = batch;
+            batch = next;
+        }
+        while (ordered) {
+            auto next = ordered->mNext;
+            if (--port.mInFlight == 0) {
+                // the last waiter may well destroy the pool, port included:
+                // stop collecting before handing it control
+                port.mCollecting = false;
+                ordered->mWaiter.resume();
+                co_return;
+            }
+            ordered->mWaiter.resume();
+            ordered = next;
         }
-        ready->store(true, std::memory_order_release);
-        (void)futex_notify_sync(ready.get());
-    });
-    while (ready->load(std::memory_order_acquire) == false) {
-        (void)co_await futex_wait(ready.get(), false);
     }
-    if (ep) [[unlikely]] {
-        std::rethrow_exception(ep);
+    port.mCollecting = false;
+}
+
+Task<Expected<>> ThreadPool::rawRun(std::function<void()> func) {
+    Job job;
+    job.mInvoke = [](void *arg) {
+        (*static_cast<std::function<void()> *>(arg))();
+    };
+    job.mArg = &func;
+    co_await JobAwaiter{this, job};
+    if (job.mException) [[unlikely]] {
+        std::rethrow_exception(job.mException);
     }
     co_return {};
 }
 
 Task<Expected<>> ThreadPool::rawRun(std::function<void(std::stop_token)> func,
                                     CancelToken cancel) {
-    auto ready = std::make_shared<FutexAtomic<bool>>(false);
     std::stop_source stop;
     bool stopped = false;
-    std::exception_ptr ep;
-    submitJob([ready, func = std::move(func), stop = stop.get_token(),
-               &ep]() mutable {
-        try {
-            func(stop);
-        } catch (...) {
-            ep = std::current_exception();
-        }
-        ready->store(true, std::memory_order_release);
-        (void)futex_notify_sync(ready.get());
-    });
+    struct Call {
+        std::function<void(std::stop_token)> &func;
+        std::stop_token stop;
+    } call{func, stop.get_token()};
+    Job job;
+    job.mInvoke = [](void *arg) {
+        auto &call = *static_cast<Call *>(arg);
+        call.func(call.stop);
+    };
+    job.mArg = &call;
 
     {
         CancelCallback _(cancel, [&] {
             stopped = true;
             stop.request_stop();
         });
-        while (ready->load(std::memory_order_acquire) == false) {
-            (void)co_await futex_wait(ready.get(), false);
-        }
+        co_await JobAwaiter{this, job};
     }
 
-    if (ep) [[unlikely]] {
-        std::rethrow_exception(ep);
+    if (job.mException) [[unlikely]] {
+        std::rethrow_exception(job.mException);
     }
     if (stopped) {
         co_return std::errc::operation_canceled;
@@ -135,16 +238,33 @@ Task<Expected<>> ThreadPool::rawRun(std::function<void(std::stop_token)> func,
 }
 
 std::size_t ThreadPool::threads_count() {
-    std::lock_guard lock(mThreadsMutex);
-    return mThreads.size();
+    return mNumWorkers;
 }
 
 std::size_t ThreadPool::working_threads_count() {
-    std::lock_guard lock(mWorkingMutex);
-    return mWorkingThreads.size();
+    return mWorkingCount.load(std::memory_order_relaxed);
 }
 
-ThreadPool::ThreadPool() = default;
-ThreadPool::~ThreadPool() = default;
+ThreadPool::ThreadPool(std::size_t threads)
+    : mNumWorkers(threads ? threads
+                          : std::max<std::size_t>(
+                                std::thread::hardware_concurrency(), 4)) {
+    mWorkers = std::make_unique<Worker[]>(mNumWorkers);
+    for (std::size_t i = 0; i < mNumWorkers; ++i) {
+        mWorkers[i].mThread = std::jthread(
+            [this, i](std::stop_token stop) { workerMain(i, stop); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    for (std::size_t i = 0; i < mNumWorkers; ++i) {
+        mWorkers[i].mThread.request_stop();
+    }
+    mSignal.fetch_add(1, std::memory_order_seq_cst);
+    (void)futex_notify_sync(&mSignal);
+    for (std::size_t i = 0; i < mNumWorkers; ++i) {
+        mWorkers[i].mThread.join();
+    }
+}
 
 } // namespace co_async
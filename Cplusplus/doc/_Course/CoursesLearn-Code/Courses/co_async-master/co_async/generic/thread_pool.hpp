@@ -4,22 +4,36 @@
 #include <co_async/awaiter/task.hpp>
 #include <co_async/generic/condition_variable.hpp>
 #include <co_async/generic/io_context.hpp>
+#include <co_async/platform/futex.hpp>
 #include <co_async/utils/spin_mutex.hpp>
 
 namespace co_async {
 
+// a fixed set of worker threads for blocking calls: each worker has its own
+// job queue and steals from the others when it runs dry, and finished jobs
+// are handed back to the IOContext that submitted them in batches
 struct ThreadPool {
 private:
-    struct Thread;
+    struct Job;
+    struct Worker;
+    struct Port;
+    struct JobAwaiter;
 
-    SpinMutex mWorkingMutex;
-    std::list<Thread *> mWorkingThreads;
-    SpinMutex mFreeMutex;
-    std::list<Thread *> mFreeThreads;
-    SpinMutex mThreadsMutex;
-    std::list<Thread> mThreads;
+    std::unique_ptr<Worker[]> mWorkers;
+    std::size_t mNumWorkers;
+    std::atomic<std::size_t> mNextWorker{0};
+    std::atomic<std::size_t> mWorkingCount{0};
+    // bumped on every submit, idle workers futex-wait on it
+    FutexAtomic<std::uint32_t> mSignal{0};
+    std::atomic<std::size_t> mSleepers{0};
+    std::mutex mPortsMutex;
+    std::map<IOContext *, std::unique_ptr<Port>> mPorts;
 
-    Thread *submitJob(std::function<void()> func);
+    void submitJob(Job &job);
+    Job *takeJob(std::size_t self);
+    void workerMain(std::size_t self, std::stop_token stop);
+    static void postJob(Job &job);
+    static Task<> collectJobs(Port &port);
 
 public:
     Task<Expected<>> rawRun(std::function<void()> func) /* MT-safe */;
@@ -69,7 +83,9 @@ public:
     std::size_t threads_count() /* MT-safe */;
     std::size_t working_threads_count() /* MT-safe */;
 
-    ThreadPool();
+    // threads = 0 picks one per core, but at least 4 like libuv's pool: the
+    // jobs mostly block rather than compute
+    explicit ThreadPool(std::size_t threads = 0);
     ~ThreadPool();
     ThreadPool &operator=(ThreadPool &&) = delete;
 };
@@ -16,7 +16,11 @@ co_sleep(std::chrono::steady_clock::time_point expires) {
     auto task = coSleep(expires);
     CancelCallback _(co_await co_cancel, [p = &task.promise()] {
         p->doCancel();
-        std::coroutine_handle<GenericIOContext::TimerNode>::from_promise(*p).resume();
+        // resuming right here would run the sleeper to completion from
+        // within the canceller, e.g. the when_any that is cancelling it,
+        // and free frames still on the stack; defer to the context loop
+        IOContext::instance->spawn(
+            std::coroutine_handle<GenericIOContext::TimerNode>::from_promise(*p));
     });
     co_return co_await task;
 }
@@ -9,6 +9,29 @@
 namespace co_async {
 struct SocketStream : Stream {
     Task<Expected<std::size_t>> raw_read(std::span<char> buffer) override {
+        // bytes already claimed by the multishot recv must come out first
+        if (mReceiver && (mReceiver->pending() || mLeftover)) [[unlikely]] {
+            if (!mLeftover) {
+                auto buf = co_await raw_read_provided();
+                if (buf.has_value()) [[likely]] {
+                    if (buf->size() == 0) [[unlikely]] {
+                        co_return 0;
+                    }
+                    mLeftover = std::move(*buf);
+                } else if (buf.error() != std::errc::no_buffer_space) {
+                    co_return CO_ASYNC_ERROR_FORWARD(buf);
+                }
+            }
+            if (mLeftover) {
+                auto n = std::min(buffer.size(), mLeftover.size());
+                std::memcpy(buffer.data(), mLeftover.data(), n);
+                mLeftover.remove_prefix(n);
+                if (mLeftover.size() == 0) {
+                    mLeftover = ProvidedBuffer();
+                }
+                co_return n;
+            }
+        }
         auto ret =
             co_await socket_read(mFile, buffer, mTimeout, co_await co_cancel);
         if (ret == std::make_error_code(std::errc::operation_canceled))
@@ -29,6 +52,49 @@ struct SocketStream : Stream {
         co_return ret;
     }
 
+    Task<Expected<std::size_t>>
+    raw_writev(std::span<std::span<char const> const> buffers) override {
+        std::array<struct iovec, 8> iov;
+        std::size_t n = std::min(buffers.size(), iov.size());
+        for (std::size_t i = 0; i < n; ++i) {
+            iov[i].iov_base = const_cast<char *>(buffers[i].data());
+            iov[i].iov_len = buffers[i].size();
+        }
+        auto ret = co_await socket_writev(mFile, std::span(iov.data(), n),
+                                          mTimeout, co_await co_cancel);
+        if (ret == std::make_error_code(std::errc::operation_canceled))
+            [[unlikely]] {
+            co_return std::errc::stream_timeout;
+        }
+        co_return ret;
+    }
+
+    Task<Expected<>> raw_sendfile(std::span<char const> head,
+                                  FileHandle &file, std::uint64_t offset,
+                                  std::size_t size) override {
+        auto ret = co_await socket_sendfile(mFile, head, file, offset, size,
+                                            mTimeout, co_await co_cancel);
+        if (ret == std::make_error_code(std::errc::operation_canceled))
+            [[unlikely]] {
+            co_return std::errc::stream_timeout;
+        }
+        co_return ret;
+    }
+
+    Task<Expected<ProvidedBuffer>> raw_read_provided() override {
+        if (mLeftover) [[unlikely]] {
+            co_return std::move(mLeftover);
+        }
+        if (!mReceiver) {
+            auto *context = PlatformIOContext::instance;
+            if (!context || !context->providedBuffers()) {
+                co_return std::errc::not_supported;
+            }
+            mReceiver.emplace(mFile, context);
+        }
+        co_return co_await mReceiver->recv(mTimeout);
+    }
+
     SocketHandle release() noexcept {
         return std::move(mFile);
     }
@@ -46,6 +112,9 @@ struct SocketStream : Stream {
 private:
     SocketHandle mFile;
     std::chrono::steady_clock::duration mTimeout = std::chrono::seconds(30);
+    // declared after mFile: cancelled before the socket is closed
+    std::optional<MultishotReceiver> mReceiver;
+    ProvidedBuffer mLeftover;
 };
 
 inline Task<Expected<OwningStream>>
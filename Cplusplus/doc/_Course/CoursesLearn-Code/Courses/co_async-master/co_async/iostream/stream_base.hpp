@@ -3,6 +3,8 @@
 #include <co_async/awaiter/task.hpp>
 #include <co_async/generic/allocator.hpp>
 #include <co_async/iostream/bytes_buffer.hpp>
+#include <co_async/platform/fs.hpp>
+#include <co_async/platform/platform_io.hpp>
 #include <co_async/utils/expected.hpp>
 
 namespace co_async {
@@ -44,6 +46,32 @@ struct Stream {
         co_return std::errc::not_supported;
     }
 
+    // writes buffers back to back as one, returning how many bytes went out
+    virtual Task<Expected<std::size_t>>
+    raw_writev(std::span<std::span<char const> const> buffers) {
+        for (auto buffer: buffers) {
+            if (!buffer.empty()) {
+                co_return co_await raw_write(buffer);
+            }
+        }
+        co_return 0;
+    }
+
+    // writes head followed by file bytes [offset, offset + size), the latter
+    // without copying them through user space
+    virtual Task<Expected<>> raw_sendfile(std::span<char const> head,
+                                          FileHandle &file,
+                                          std::uint64_t offset,
+                                          std::size_t size) {
+        co_return std::errc::not_supported;
+    }
+
+    // reads into a buffer picked by the kernel (see ProvidedBufferRing)
+    // instead of one owned by the stream; an empty buffer means EOF
+    virtual Task<Expected<ProvidedBuffer>> raw_read_provided() {
+        co_return std::errc::not_supported;
+    }
+
     Stream &operator=(Stream &&) = delete;
     virtual ~Stream() = default;
 };
@@ -62,7 +90,7 @@ struct BorrowedStream {
             mInEnd = mInIndex = 0;
             co_await co_await fillbuf();
         }
-        char c = mInBuffer[mInIndex];
+        char c = inbuf()[mInIndex];
         ++mInIndex;
         co_return c;
     }
@@ -71,13 +99,13 @@ struct BorrowedStream {
         std::size_t start = mInIndex;
         while (true) {
             for (std::size_t i = start; i < mInEnd; ++i) {
-                if (mInBuffer[i] == eol) {
-                    s.append(mInBuffer.data() + start, i - start);
+                if (inbuf()[i] == eol) {
+                    s.append(inbuf() + start, i - start);
                     mInIndex = i + 1;
                     co_return {};
                 }
             }
-            s.append(mInBuffer.data() + start, mInEnd - start);
+            s.append(inbuf() + start, mInEnd - start);
             mInEnd = mInIndex = 0;
             co_await co_await fillbuf();
             start = 0;
@@ -88,7 +116,7 @@ struct BorrowedStream {
         std::size_t start = mInIndex;
         while (true) {
             for (std::size_t i = start; i < mInEnd; ++i) {
-                if (mInBuffer[i] == eol) {
+                if (inbuf()[i] == eol) {
                     mInIndex = i + 1;
                     co_return {};
                 }
@@ -107,7 +135,7 @@ struct BorrowedStream {
                 mInEnd = mInIndex = 0;
                 co_await co_await fillbuf();
             }
-            char c = mInBuffer[mInIndex];
+            char c = inbuf()[mInIndex];
             if (eol[i] == c) [[likely]] {
                 ++mInIndex;
             } else {
@@ -126,7 +154,7 @@ struct BorrowedStream {
                 mInEnd = mInIndex = 0;
                 co_await co_await fillbuf();
             }
-            char c = mInBuffer[mInIndex];
+            char c = inbuf()[mInIndex];
             if (eol[i] == c) [[likely]] {
                 ++mInIndex;
             } else {
@@ -155,13 +183,14 @@ struct BorrowedStream {
         while (true) {
             auto end = start + n;
             if (end <= mInEnd) {
-                p = std::copy(mInBuffer.data() + start, mInBuffer.data() + end,
+                p = std::copy(inbuf() + start, inbuf() + end,
                               p);
                 mInIndex = end;
                 co_return {};
             }
-            p = std::copy(mInBuffer.data() + start, mInBuffer.data() + mInEnd,
+            p = std::copy(inbuf() + start, inbuf() + mInEnd,
                           p);
+            n -= mInEnd - start;
             mInEnd = mInIndex = 0;
             co_await co_await fillbuf();
             start = 0;
@@ -189,13 +218,13 @@ struct BorrowedStream {
         while (true) {
             auto end = start + n;
             if (end <= mInEnd) {
-                s.append(mInBuffer.data() + mInIndex, n);
+                s.append(inbuf() + mInIndex, n);
                 mInIndex = end;
                 co_return {};
             }
             auto m = mInEnd - mInIndex;
             n -= m;
-            s.append(mInBuffer.data() + mInIndex, m);
+            s.append(inbuf() + mInIndex, m);
             mInEnd = mInIndex = 0;
             co_await co_await fillbuf();
             start = 0;
@@ -219,7 +248,7 @@ struct BorrowedStream {
     Task<Expected<>> getall(String &s) {
         std::size_t start = mInIndex;
         do {
-            s.append(mInBuffer.data() + start, mInEnd - start);
+            s.append(inbuf() + start, mInEnd - start);
             start = 0;
             mInEnd = mInIndex = 0;
         } while (co_await (co_await fillbuf()).transform([] { return true; }).or_else(eofError(), [] { return false; }));
@@ -248,7 +277,7 @@ struct BorrowedStream {
     }
 
     std::span<char const> peekbuf() const noexcept {
-        return {mInBuffer.data() + mInIndex, mInEnd - mInIndex};
+        return {inbuf() + mInIndex, mInEnd - mInIndex};
     }
 
     void seenbuf(std::size_t n) noexcept {
@@ -279,15 +308,15 @@ struct BorrowedStream {
             mInEnd = mInIndex = 0;
             co_await co_await fillbuf();
         }
-        co_return mInBuffer[mInIndex];
+        co_return inbuf()[mInIndex];
     }
 
     Task<Expected<>> peekn(String &s, std::size_t n) {
-        if (mInBuffer.size() - mInIndex < n) {
-            if (mInBuffer.size() < n) [[unlikely]] {
+        if (inbufsize() - mInIndex < n) {
+            if (inbufsize() < n) [[unlikely]] {
                 co_return std::errc::value_too_large;
             }
-            std::memmove(mInBuffer.data(), mInBuffer.data() + mInIndex,
+            std::memmove(inbuf(), inbuf() + mInIndex,
                          mInEnd - mInIndex);
             mInEnd -= mInIndex;
             mInIndex = 0;
@@ -295,7 +324,31 @@ struct BorrowedStream {
         while (mInEnd - mInIndex < n) {
             co_await co_await fillbuf();
         }
-        s.append(mInBuffer.data() + mInIndex, n);
+        s.append(inbuf() + mInIndex, n);
+        co_return {};
+    }
+
+    // reads more bytes in after those still unread, keeping peekbuf()
+    // contiguous; value_too_large once they fill the whole buffer
+    Task<Expected<>> fillmore() {
+        if (bufempty()) {
+            mInEnd = mInIndex = 0;
+            co_return co_await fillbuf();
+        }
+        if (mInIndex != 0) {
+            std::memmove(inbuf(), inbuf() + mInIndex, mInEnd - mInIndex);
+            mInEnd -= mInIndex;
+            mInIndex = 0;
+        }
+        if (mInEnd == inbufsize()) [[unlikely]] {
+            co_return std::errc::value_too_large;
+        }
+        auto n = co_await co_await mRaw->raw_read(
+            std::span(inbuf() + mInEnd, inbufsize() - mInEnd));
+        if (n == 0) [[unlikely]] {
+            co_return eofError();
+        }
+        mInEnd += n;
         co_return {};
     }
 
@@ -314,7 +367,33 @@ struct BorrowedStream {
     }
 
     Task<Expected<>> fillbuf() {
-        if (!mInBuffer) {
+        if (mInIndex == mInEnd && !mNoProvidedRead) {
+            // nothing left to keep: hand the consumed buffer back and let the
+            // kernel pick one only once data actually arrives
+            mInProvided = ProvidedBuffer();
+            mInIndex = mInEnd = 0;
+            // likewise the private buffer a dry ring made us fall back to:
+            // it is only allocated again if the ring is still dry
+            if (mInBuffer) {
+                mInBuffer = BytesBuffer();
+            }
+            auto buf = co_await mRaw->raw_read_provided();
+            if (buf.has_value()) [[likely]] {
+                if (buf->size() == 0) [[unlikely]] {
+                    co_return eofError();
+                }
+                mInEnd = buf->size();
+                mInProvided = std::move(*buf);
+                co_return {};
+            }
+            if (buf.error() == std::errc::not_supported) {
+                mNoProvidedRead = true;
+            } else if (buf.error() != std::errc::no_buffer_space)
+                [[unlikely]] {
+                co_return CO_ASYNC_ERROR_FORWARD(buf);
+            }
+        }
+        if (!mInProvided && !mInBuffer) {
             allocinbuf(kStreamBufferSize);
         }
         // #if CO_ASYNC_DEBUG
@@ -324,7 +403,7 @@ struct BorrowedStream {
         //         }
         // #endif
         auto n = co_await co_await mRaw->raw_read(std::span(
-            mInBuffer.data() + mInIndex, mInBuffer.size() - mInIndex));
+            inbuf() + mInIndex, inbufsize() - mInIndex));
         // auto n = co_await co_await mRaw->raw_read(mInBuffer);
         if (n == 0) [[unlikely]] {
             co_return eofError();
@@ -337,6 +416,14 @@ struct BorrowedStream {
         return mInIndex == mInEnd;
     }
 
+    char *inbuf() const noexcept {
+        return mInProvided ? mInProvided.data() : mInBuffer.data();
+    }
+
+    std::size_t inbufsize() const noexcept {
+        return mInProvided ? mInProvided.capacity() : mInBuffer.size();
+    }
+
     Task<Expected<>> putchar(char c) {
         if (buffull()) {
             co_await co_await flush();
@@ -347,6 +434,11 @@ struct BorrowedStream {
     }
 
     Task<Expected<>> putspan(std::span<char const> s) {
+        if (mOutBuffer && s.size() >= mOutBuffer.size()) {
+            // would take whole buffers of copying anyway: send the buffered
+            // bytes and s together in one gathered write instead
+            co_return co_await putspanDirect(s);
+        }
         auto p = s.data();
         auto const pe = s.data() + s.size();
     again:
@@ -370,6 +462,42 @@ struct BorrowedStream {
         co_return {};
     }
 
+    // flushes the buffered bytes, then sends file bytes [offset, offset +
+    // size) kernel-to-kernel when the stream can, else copies them through
+    Task<Expected<>> putfile(FileHandle &file, std::uint64_t offset,
+                             std::size_t size) {
+        if (!mOutBuffer) {
+            allocoutbuf(kStreamBufferSize);
+        }
+        auto ret = co_await mRaw->raw_sendfile(
+            std::span<char const>(mOutBuffer.data(), mOutIndex), file, offset,
+            size);
+        if (ret.has_value()) [[likely]] {
+            mOutIndex = 0;
+            co_return co_await mRaw->raw_flush();
+        }
+        if (ret.error() != std::errc::not_supported) [[unlikely]] {
+            co_return CO_ASYNC_ERROR_FORWARD(ret);
+        }
+        while (size) {
+            if (buffull()) {
+                co_await co_await flush();
+            }
+            auto n = co_await co_await fs_read(
+                file,
+                std::span(mOutBuffer.data() + mOutIndex,
+                          std::min(size, mOutBuffer.size() - mOutIndex)),
+                offset);
+            if (n == 0) [[unlikely]] {
+                co_return std::errc::io_error;
+            }
+            mOutIndex += n;
+            offset += n;
+            size -= n;
+        }
+        co_return {};
+    }
+
     std::size_t trywrite(std::span<char const> s) {
         if (!mOutBuffer) {
             allocoutbuf(kStreamBufferSize);
@@ -477,7 +605,7 @@ struct BorrowedStream {
     Task<Expected<std::size_t>> read(std::span<char> buffer) {
         if (!bufempty()) {
             auto n = std::min(mInEnd - mInIndex, buffer.size());
-            std::memcpy(buffer.data(), mInBuffer.data() + mInIndex, n);
+            std::memcpy(buffer.data(), inbuf() + mInIndex, n);
             mInIndex += n;
             co_return n;
         }
@@ -494,7 +622,7 @@ struct BorrowedStream {
 
     Task<Expected<std::size_t>> write(std::span<char const> buffer) {
         if (!buffull()) {
-            auto n = std::min(mInBuffer.size() - mInIndex, buffer.size());
+            auto n = std::min(mOutBuffer.size() - mOutIndex, buffer.size());
             co_await co_await putspan(buffer.subspan(0, n));
             co_return n;
         }
@@ -529,7 +657,26 @@ struct BorrowedStream {
     }
 
 private:
+    Task<Expected<>> putspanDirect(std::span<char const> s) {
+        std::span<char const> bufs[2] = {
+            std::span<char const>(mOutBuffer.data(), mOutIndex), s};
+        while (!bufs[0].empty() || !bufs[1].empty()) {
+            auto n = co_await co_await mRaw->raw_writev(bufs);
+            if (n == 0) [[unlikely]] {
+                co_return eofError();
+            }
+            auto m = std::min(n, bufs[0].size());
+            bufs[0] = bufs[0].subspan(m);
+            bufs[1] = bufs[1].subspan(n - m);
+        }
+        mOutIndex = 0;
+        co_return co_await mRaw->raw_flush();
+    }
+
     BytesBuffer mInBuffer;
+    // when set, the input bytes live in here rather than in mInBuffer
+    ProvidedBuffer mInProvided;
+    bool mNoProvidedRead = false;
     std::size_t mInIndex = 0;
     std::size_t mInEnd = 0;
     BytesBuffer mOutBuffer;
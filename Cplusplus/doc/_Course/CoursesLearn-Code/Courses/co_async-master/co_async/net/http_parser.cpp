@@ -0,0 +1,295 @@
+#include <co_async/net/http_parser.hpp>
+#if defined(__SSE2__)
+# include <immintrin.h>
+#endif
+
+namespace co_async {
+namespace {
+enum class Scan {
+    // method and header name: ends at any byte outside visible ASCII, or ':'
+    Name,
+    // request target: ends at a space or control byte
+    Target,
+    // header value: ends at a control byte other than tab
+    Value,
+};
+
+template <Scan kind>
+constexpr bool isScanEnd(unsigned char c) noexcept {
+    if constexpr (kind == Scan::Name) {
+        return c <= 0x20 || c >= 0x7f || c == ':';
+    } else if constexpr (kind == Scan::Target) {
+        return c <= 0x20 || c == 0x7f;
+    } else {
+        return (c < 0x20 && c != '\t') || c == 0x7f;
+    }
+}
+
+// first byte in [p, end) ending a field of this kind, or end
+template <Scan kind>
+inline char const *scanEnd(char const *p, char const *end) noexcept {
+#if defined(__AVX2__)
+    auto const del256 = _mm256_set1_epi8(0x7f);
+    for (; end - p >= 32; p += 32) {
+        auto v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p));
+        __m256i hit;
+        if constexpr (kind == Scan::Value) {
+            auto ctl = _mm256_cmpeq_epi8(
+                _mm256_min_epu8(v, _mm256_set1_epi8(0x1f)), v);
+            auto tab = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'));
+            hit = _mm256_or_si256(_mm256_andnot_si256(tab, ctl),
+                                  _mm256_cmpeq_epi8(v, del256));
+        } else {
+            hit = _mm256_cmpeq_epi8(
+                _mm256_min_epu8(v, _mm256_set1_epi8(0x20)), v);
+            if constexpr (kind == Scan::Name) {
+                hit = _mm256_or_si256(
+                    hit, _mm256_cmpeq_epi8(_mm256_max_epu8(v, del256), v));
+                hit = _mm256_or_si256(
+                    hit, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')));
+            } else {
+                hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(v, del256));
+            }
+        }
+        if (auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(hit)))
+        {
+            return p + std::countr_zero(mask);
+        }
+    }
+#endif
+#if defined(__SSE4_2__) && !defined(__AVX2__)
+    // pairs of inclusive byte ranges for pcmpestri to look for
+    __m128i r;
+    int numRanges;
+    if constexpr (kind == Scan::Name) {
+        r = _mm_setr_epi8(0x00, 0x20, ':', ':', 0x7f, -1, 0, 0, 0, 0, 0, 0, 0,
+                          0, 0, 0);
+        numRanges = 6;
+    } else if constexpr (kind == Scan::Target) {
+        r = _mm_setr_epi8(0x00, 0x20, 0x7f, 0x7f, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                          0, 0, 0);
+        numRanges = 4;
+    } else {
+        r = _mm_setr_epi8(0x00, 0x08, 0x0a, 0x1f, 0x7f, 0x7f, 0, 0, 0, 0, 0,
+                          0, 0, 0, 0, 0);
+        numRanges = 6;
+    }
+    for (; end - p >= 16; p += 16) {
+        auto v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+        int i = _mm_cmpestri(r, numRanges, v, 16,
+                             _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES |
+                                 _SIDD_LEAST_SIGNIFICANT);
+        if (i != 16) {
+            return p + i;
+        }
+    }
+#elif defined(__SSE2__)
+    // x86-64 baseline, and the tail of the AVX2 loop
+    auto const del = _mm_set1_epi8(0x7f);
+    for (; end - p >= 16; p += 16) {
+        auto v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+        __m128i hit;
+        if constexpr (kind == Scan::Value) {
+            auto ctl = _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1f)), v);
+            auto tab = _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'));
+            hit = _mm_or_si128(_mm_andnot_si128(tab, ctl),
+                               _mm_cmpeq_epi8(v, del));
+        } else {
+            hit = _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x20)), v);
+            if constexpr (kind == Scan::Name) {
+                hit = _mm_or_si128(hit,
+                                   _mm_cmpeq_epi8(_mm_max_epu8(v, del), v));
+                hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, _mm_set1_epi8(':')));
+            } else {
+                hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, del));
+            }
+        }
+        if (auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(hit))) {
+            return p + std::countr_zero(mask);
+        }
+    }
+#endif
+    static constexpr auto table = [] {
+        std::array<bool, 256> table{};
+        for (std::size_t c = 0; c < table.size(); ++c) {
+            table[c] = isScanEnd<kind>(static_cast<unsigned char>(c));
+        }
+        return table;
+    }();
+    while (p != end && !table[static_cast<unsigned char>(*p)]) {
+        ++p;
+    }
+    return p;
+}
+
+// steps over one part of a head each, returning false to stop parsing: with
+// mError set if the head is malformed, or with p cleared if the buffer ends
+// before the part does
+struct HeadParser {
+    char const *p;
+    char const *const end;
+    std::errc mError{};
+
+    bool fail(std::errc e) noexcept {
+        mError = e;
+        return false;
+    }
+
+    bool incomplete() noexcept {
+        p = nullptr;
+        return false;
+    }
+
+    // a space-terminated token of the request line
+    template <Scan kind>
+    bool word(std::string_view &out) noexcept {
+        auto wordEnd = scanEnd<kind>(p, end);
+        if (wordEnd == end) {
+            return incomplete();
+        }
+        if (*wordEnd != ' ' || wordEnd == p) [[unlikely]] {
+            return fail(std::errc::protocol_error);
+        }
+        out = std::string_view(p, std::size_t(wordEnd - p));
+        p = wordEnd + 1;
+        return true;
+    }
+
+    // "HTTP/1.x"
+    bool version() noexcept {
+        using namespace std::string_view_literals;
+        static constexpr auto prefix = "HTTP/1."sv;
+        auto n = std::min(prefix.size(), std::size_t(end - p));
+        if (std::string_view(p, n) != prefix.substr(0, n)) [[unlikely]] {
+            return fail(std::errc::protocol_error);
+        }
+        if (n == std::size_t(end - p)) {
+            return incomplete();
+        }
+        if (p[n] < '0' || p[n] > '9') [[unlikely]] {
+            return fail(std::errc::protocol_error);
+        }
+        p += n + 1;
+        return true;
+    }
+
+    // CRLF or a bare LF
+    bool lineEnd() noexcept {
+        if (p == end) {
+            return incomplete();
+        }
+        if (*p == '\n') {
+            ++p;
+            return true;
+        }
+        if (*p != '\r') [[unlikely]] {
+            return fail(std::errc::protocol_error);
+        }
+        if (end - p < 2) {
+            return incomplete();
+        }
+        if (p[1] != '\n') [[unlikely]] {
+            return fail(std::errc::protocol_error);
+        }
+        p += 2;
+        return true;
+    }
+
+    // "name: value" lines up to and including the empty one
+    bool fields(HTTPHead &head) noexcept {
+        head.numFields = 0;
+        while (true) {
+            if (p == end) {
+                return incomplete();
+            }
+            if (*p == '\r' || *p == '\n') {
+                return lineEnd();
+            }
+            if (head.numFields == HTTPHead::kMaxFields) [[unlikely]] {
+                return fail(std::errc::value_too_large);
+            }
+            auto nameEnd = scanEnd<Scan::Name>(p, end);
+            if (nameEnd == end) {
+                return incomplete();
+            }
+            // an empty name or a space before the colon, which also rejects
+            // obsolete line folding
+            if (*nameEnd != ':' || nameEnd == p) [[unlikely]] {
+                return fail(std::errc::protocol_error);
+            }
+            auto value = nameEnd + 1;
+            while (value != end && (*value == ' ' || *value == '\t')) {
+                ++value;
+            }
+            auto valueEnd = scanEnd<Scan::Value>(value, end);
+            auto name = p;
+            p = valueEnd;
+            if (!lineEnd()) {
+                return false;
+            }
+            while (valueEnd != value &&
+                   (valueEnd[-1] == ' ' || valueEnd[-1] == '\t')) {
+                --valueEnd;
+            }
+            head.fields[head.numFields++] = {
+                std::string_view(name, std::size_t(nameEnd - name)),
+                std::string_view(value, std::size_t(valueEnd - value)),
+            };
+        }
+    }
+
+    Expected<std::size_t> result(std::string_view buf) const noexcept {
+        if (mError != std::errc()) [[unlikely]] {
+            return mError;
+        }
+        if (!p) {
+            return std::size_t(0);
+        }
+        return std::size_t(p - buf.data());
+    }
+};
+} // namespace
+
+Expected<std::size_t> parseHTTPRequestHead(std::string_view buf,
+                                           HTTPHead &head) noexcept {
+    HeadParser parser{buf.data(), buf.data() + buf.size()};
+    head.status = 0;
+    parser.word<Scan::Name>(head.method) &&
+        parser.word<Scan::Target>(head.target) && parser.version() &&
+        parser.lineEnd() && parser.fields(head);
+    return parser.result(buf);
+}
+
+Expected<std::size_t> parseHTTPResponseHead(std::string_view buf,
+                                            HTTPHead &head) noexcept {
+    HeadParser parser{buf.data(), buf.data() + buf.size()};
+    head.method = {};
+    head.target = {};
+    if (!parser.version()) {
+        return parser.result(buf);
+    }
+    // " 200", then either the line end or " reason"
+    auto p = parser.p;
+    if (parser.end - p < 5) {
+        return std::size_t(0);
+    }
+    if (p[0] != ' ') [[unlikely]] {
+        return std::errc::protocol_error;
+    }
+    int status = 0;
+    for (int i = 1; i <= 3; ++i) {
+        if (p[i] < '0' || p[i] > '9') [[unlikely]] {
+            return std::errc::protocol_error;
+        }
+        status = status * 10 + (p[i] - '0');
+    }
+    head.status = status;
+    p += 4;
+    if (*p == ' ') {
+        p = scanEnd<Scan::Value>(p + 1, parser.end);
+    }
+    parser.p = p;
+    parser.lineEnd() && parser.fields(head);
+    return parser.result(buf);
+}
+} // namespace co_async
@@ -0,0 +1,41 @@
+#pragma once
+#include <co_async/std.hpp>
+#include <co_async/utils/expected.hpp>
+
+namespace co_async {
+struct HTTPHeaderField {
+    std::string_view key;
+    std::string_view value;
+};
+
+// an HTTP/1.x request or response head parsed in place: every view points
+// into the parsed buffer and must not outlive its contents
+struct HTTPHead {
+    static constexpr std::size_t kMaxFields = 64;
+
+    // request line, left empty when parsing a response
+    std::string_view method;
+    std::string_view target;
+    // status line, left 0 when parsing a request
+    int status = 0;
+
+    std::array<HTTPHeaderField, kMaxFields> fields;
+    std::size_t numFields = 0;
+
+    std::span<HTTPHeaderField const> headers() const noexcept {
+        return {fields.data(), numFields};
+    }
+};
+
+// Both parse a complete head from the start of buf and return its length,
+// including the empty line ending it. They return 0 if buf ends before the
+// head does, protocol_error if it is malformed, and value_too_large if it has
+// more than HTTPHead::kMaxFields header fields. Header names are returned as
+// sent, values with surrounding whitespace trimmed. Scanning uses AVX2 or
+// SSE4.2 when compiled for them (CO_ASYNC_NATIVE), SSE2 on any other x86-64
+// and a lookup table elsewhere.
+Expected<std::size_t> parseHTTPRequestHead(std::string_view buf,
+                                           HTTPHead &head) noexcept;
+Expected<std::size_t> parseHTTPResponseHead(std::string_view buf,
+                                            HTTPHead &head) noexcept;
+} // namespace co_async
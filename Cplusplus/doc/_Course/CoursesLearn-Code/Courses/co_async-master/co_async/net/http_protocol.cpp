@@ -30,6 +30,52 @@ HTTPProtocolVersion11::httpContentEncodingByName(std::string_view name) {
     return HTTPContentEncoding::Identity;
 }
 
+Task<Expected<bool>> HTTPProtocolVersion11::readHead(bool isRequest) {
+    // parse the whole head in place once it is in the stream buffer, only
+    // rescanning after newly read bytes bring a line break; false if it does
+    // not fit there, leaving it to be read line by line
+    std::size_t scanned = 0;
+    while (true) {
+        auto buf = sock.peekbuf();
+        std::string_view data(buf.data(), buf.size());
+        if (data.find('\n', scanned) != data.npos) {
+            auto n = isRequest ? parseHTTPRequestHead(data, mHead)
+                               : parseHTTPResponseHead(data, mHead);
+            if (n.has_error()) [[unlikely]] {
+                if (n.error() == std::errc::value_too_large) {
+                    co_return false;
+                }
+                co_return CO_ASYNC_ERROR_FORWARD(n);
+            }
+            if (*n != 0) {
+                sock.seenbuf(*n);
+                co_return true;
+            }
+        }
+        scanned = data.size();
+        if (auto e = co_await sock.fillmore(); e.has_error()) {
+            if (e.error() == std::errc::value_too_large) {
+                co_return false;
+            }
+            co_return CO_ASYNC_ERROR_FORWARD(e);
+        }
+    }
+}
+
+void HTTPProtocolVersion11::storeHeaders(HTTPHeaders &headers) {
+    using namespace std::string_view_literals;
+    for (auto const &field: mHead.headers()) {
+        String key(field.key);
+        for (auto &c: key) {
+            if (c >= 'A' && c <= 'Z') {
+                c += 'a' - 'A';
+            }
+        }
+        headers.insert_or_assign(std::move(key), String(field.value));
+    }
+    headers.erase("connection"sv);
+}
+
 Task<Expected<>> HTTPProtocolVersion11::parseHeaders(HTTPHeaders &headers) {
     using namespace std::string_view_literals;
     String line;
@@ -347,6 +393,21 @@ Task<Expected<>> HTTPProtocolVersion11::writeBody(std::string_view body) {
     co_return {};
 }
 
+Task<Expected<>> HTTPProtocolVersion11::writeBodyFile(FileHandle &file,
+                                                      std::uint64_t offset,
+                                                      std::size_t size) {
+    checkPhase(1, 0);
+    using namespace std::string_view_literals;
+    // always identity: the length is known upfront and the bytes go out
+    // straight from the page cache, which an encoder would defeat
+    co_await co_await sock.puts("content-length: "sv);
+    co_await co_await sock.puts(to_string(size));
+    co_await co_await sock.puts("\r\n\r\n"sv);
+    co_await co_await sock.putfile(file, offset, size);
+    co_await co_await sock.flush();
+    co_return {};
+}
+
 Task<Expected<>> HTTPProtocolVersion11::readBodyStream(BorrowedStream &body) {
     checkPhase(-1, 0);
     co_await co_await readEncoded(body);
@@ -377,6 +438,14 @@ void HTTPProtocolVersion11::initServerState() {
 #endif
 }
 
+void HTTPProtocolVersion11::finishServerState() {
+#if CO_ASYNC_ALLOC
+    // the request, and every string it owned, is gone by now; an idle
+    // keep-alive connection should not sit on its chunks
+    mRequestArena.reset();
+#endif
+}
+
 void HTTPProtocolVersion11::initClientState() {
 #if CO_ASYNC_DEBUG
     mPhase = 0;
@@ -386,6 +455,21 @@ void HTTPProtocolVersion11::initClientState() {
 Task<Expected<>> HTTPProtocolVersion11::readRequest(HTTPRequest &req) {
     checkPhase(0, -1);
     using namespace std::string_view_literals;
+    if (co_await co_await readHead(true)) [[likely]] {
+        {
+#if CO_ASYNC_ALLOC
+            // nothing suspends in here, so no other connection on this
+            // thread can allocate from the arena meanwhile
+            ReplaceAllocator _ = &mRequestArena;
+#endif
+            req.method = mHead.method;
+            req.uri = URI::parse(mHead.target);
+            storeHeaders(req.headers);
+        }
+        handleContentEncoding(req.headers);
+        handleAcceptEncoding(req.headers);
+        co_return {};
+    }
     String line;
     co_await co_await sock.getline(line, "\r\n"sv);
     auto pos = line.find(' ');
@@ -420,6 +504,12 @@ Task<Expected<>> HTTPProtocolVersion11::writeResponse(HTTPResponse const &res) {
 Task<Expected<>> HTTPProtocolVersion11::readResponse(HTTPResponse &res) {
     checkPhase(0, -1);
     using namespace std::string_view_literals;
+    if (co_await co_await readHead(false)) [[likely]] {
+        res.status = mHead.status;
+        storeHeaders(res.headers);
+        handleContentEncoding(res.headers);
+        co_return {};
+    }
     String line;
     co_await co_await sock.getline(line, "\r\n"sv);
     if (line.size() <= 9 || line.substr(0, 7) != "HTTP/1."sv || line[8] != ' ')
@@ -3,7 +3,9 @@
 #include <co_async/awaiter/task.hpp>
 #include <co_async/generic/allocator.hpp>
 #include <co_async/iostream/socket_stream.hpp>
+#include <co_async/net/http_parser.hpp>
 #include <co_async/net/uri.hpp>
+#include <co_async/platform/fs.hpp>
 #include <co_async/utils/expected.hpp>
 #include <co_async/utils/simple_map.hpp>
 
@@ -52,10 +54,15 @@ public:
     HTTPProtocol(HTTPProtocol &&) = delete;
     virtual ~HTTPProtocol() = default;
     virtual void initServerState() = 0;
+    // called once the request and its response are done with
+    virtual void finishServerState() = 0;
     virtual void initClientState() = 0;
     virtual Task<Expected<>> writeBodyStream(BorrowedStream &body) = 0;
     virtual Task<Expected<>> readBodyStream(BorrowedStream &body) = 0;
     virtual Task<Expected<>> writeBody(std::string_view body) = 0;
+    virtual Task<Expected<>> writeBodyFile(FileHandle &file,
+                                           std::uint64_t offset,
+                                           std::size_t size) = 0;
     virtual Task<Expected<>> readBody(String &body) = 0;
     virtual Task<Expected<>> writeRequest(HTTPRequest const &req) = 0;
     virtual Task<Expected<>> readRequest(HTTPRequest &req) = 0;
@@ -71,6 +78,14 @@ protected:
     String mAcceptEncoding;
     std::optional<std::size_t> mContentLength;
     HTTPContentEncoding httpContentEncodingByName(std::string_view name);
+    // scratch space for readHead, kept here instead of in every frame
+    HTTPHead mHead;
+#if CO_ASYNC_ALLOC
+    // strings of the request being served, freed by finishServerState
+    ArenaResource mRequestArena;
+#endif
+    Task<Expected<bool>> readHead(bool isRequest);
+    void storeHeaders(HTTPHeaders &headers);
     Task<Expected<>> parseHeaders(HTTPHeaders &headers);
     Task<Expected<>> dumpHeaders(HTTPHeaders const &headers);
     void handleContentEncoding(HTTPHeaders &headers);
@@ -97,10 +112,13 @@ private:
 public:
     Task<Expected<>> writeBodyStream(BorrowedStream &body) override;
     Task<Expected<>> writeBody(std::string_view body) override;
+    Task<Expected<>> writeBodyFile(FileHandle &file, std::uint64_t offset,
+                                   std::size_t size) override;
     Task<Expected<>> readBodyStream(BorrowedStream &body) override;
     Task<Expected<>> readBody(String &body) override;
     Task<Expected<>> writeRequest(HTTPRequest const &req) override;
     void initServerState() override;
+    void finishServerState() override;
     void initClientState() override;
     Task<Expected<>> readRequest(HTTPRequest &req) override;
     Task<Expected<>> writeResponse(HTTPResponse const &res) override;
@@ -0,0 +1,257 @@
+#include <co_async/net/http_router.hpp>
+#include <co_async/utils/string_utils.hpp>
+
+namespace co_async {
+HTTPRouter::HTTPRouter() : mNodes(1) {
+    for (std::string_view method: {"GET", "HEAD", "POST", "PUT", "DELETE",
+                                   "CONNECT", "OPTIONS", "TRACE", "PATCH"}) {
+        mMethods.emplace_back(method);
+    }
+    compile();
+}
+
+std::uint32_t HTTPRouter::methodBit(std::string_view method) const noexcept {
+    for (std::size_t i = 0; i < mMethods.size(); ++i) {
+        if (mMethods[i] == method) {
+            return std::uint32_t(1) << i;
+        }
+    }
+    return 0;
+}
+
+std::uint32_t HTTPRouter::methodMask(std::string_view methods) {
+    std::uint32_t mask = 0;
+    auto upper = upper_string(methods);
+    for (std::string_view method: split_string(upper, ' ')) {
+        if (method.empty()) {
+            continue;
+        }
+        auto bit = methodBit(method);
+        if (!bit) {
+            if (mMethods.size() == 32) [[unlikely]] {
+                throw std::invalid_argument("too many distinct HTTP methods");
+            }
+            bit = std::uint32_t(1) << mMethods.size();
+            mMethods.emplace_back(method);
+        }
+        mask |= bit;
+    }
+    return mask;
+}
+
+std::uint32_t HTTPRouter::findChild(Node const &node, char c) const noexcept {
+    auto i = node.mChildKeys.find(c);
+    if (i == node.mChildKeys.npos) {
+        return kNone;
+    }
+    return node.mChildren[i];
+}
+
+std::uint32_t HTTPRouter::insertStatic(std::uint32_t node,
+                                       std::string_view label) {
+    while (!label.empty()) {
+        auto c = findChild(mNodes[node], label.front());
+        if (c == kNone) {
+            auto leaf = static_cast<std::uint32_t>(mNodes.size());
+            mNodes.emplace_back().mLabel = label;
+            mNodes[node].mChildren.push_back(leaf);
+            mNodes[node].mChildKeys.push_back(label.front());
+            return leaf;
+        }
+        std::string_view childLabel = mNodes[c].mLabel;
+        auto n = static_cast<std::size_t>(
+            std::mismatch(childLabel.begin(), childLabel.end(), label.begin(),
+                          label.end())
+                .first -
+            childLabel.begin());
+        if (n < childLabel.size()) {
+            // split the edge: c keeps the common part and everything it
+            // owned moves down to a new node holding the rest of its label
+            Node tail;
+            tail.mLabel = childLabel.substr(n);
+            std::swap(tail.mChildren, mNodes[c].mChildren);
+            std::swap(tail.mChildKeys, mNodes[c].mChildKeys);
+            tail.mParamChild = std::exchange(mNodes[c].mParamChild, kNone);
+            tail.mExact = std::exchange(mNodes[c].mExact, kNone);
+            tail.mPrefix = std::exchange(mNodes[c].mPrefix, kNone);
+            tail.mParamNamesBegin = mNodes[c].mParamNamesBegin;
+            tail.mParamNamesCount =
+                std::exchange(mNodes[c].mParamNamesCount, 0);
+            mNodes[c].mLabel.resize(n);
+            auto tailIndex = static_cast<std::uint32_t>(mNodes.size());
+            mNodes.push_back(std::move(tail));
+            mNodes[c].mChildren.push_back(tailIndex);
+            mNodes[c].mChildKeys.push_back(mNodes[tailIndex].mLabel.front());
+        }
+        node = c;
+        label.remove_prefix(n);
+    }
+    return node;
+}
+
+std::optional<std::uint32_t> HTTPRouter::insert(std::string_view path,
+                                                std::uint32_t id) {
+    std::uint32_t node = 0;
+    auto namesBegin = static_cast<std::uint32_t>(mParamNames.size());
+    while (true) {
+        auto brace = path.find('{');
+        node = insertStatic(node, path.substr(0, brace));
+        if (brace == path.npos) {
+            break;
+        }
+        auto close = path.find('}', brace);
+        if (close == path.npos || (brace != 0 && path[brace - 1] != '/') ||
+            (close + 1 != path.size() && path[close + 1] != '/'))
+            [[unlikely]] {
+            throw std::invalid_argument(
+                "route parameter must be a whole {name} path segment");
+        }
+        if (mParamNames.size() - namesBegin ==
+            HTTPRouteParams::kMaxParams) [[unlikely]] {
+            throw std::invalid_argument("too many route parameters");
+        }
+        mParamNames.emplace_back(path.substr(brace + 1, close - brace - 1));
+        if (mNodes[node].mParamChild == kNone) {
+            auto param = static_cast<std::uint32_t>(mNodes.size());
+            mNodes.emplace_back();
+            mNodes[node].mParamChild = param;
+        }
+        node = mNodes[node].mParamChild;
+        path.remove_prefix(close + 1);
+    }
+    auto &leaf = mNodes[node];
+    leaf.mParamNamesBegin = namesBegin;
+    leaf.mParamNamesCount =
+        static_cast<std::uint32_t>(mParamNames.size()) - namesBegin;
+    auto old = std::exchange(leaf.mExact, id);
+    compile();
+    if (old == kNone) {
+        return std::nullopt;
+    }
+    return old;
+}
+
+std::optional<std::uint32_t> HTTPRouter::insertPrefix(std::string_view prefix,
+                                                      std::uint32_t id) {
+    auto old = std::exchange(mNodes[insertStatic(0, prefix)].mPrefix, id);
+    compile();
+    if (old == kNone) {
+        return std::nullopt;
+    }
+    return old;
+}
+
+void HTTPRouter::compile() {
+    mFlat.clear();
+    mLabels.clear();
+    mChildKeys.clear();
+    mChildIndices.clear();
+    mFlat.reserve(mNodes.size());
+    compileNode(0);
+}
+
+std::uint32_t HTTPRouter::compileNode(std::uint32_t node) {
+    auto index = static_cast<std::uint32_t>(mFlat.size());
+    auto const &n = mNodes[node];
+    mFlat.push_back({
+        .mLabelBegin = static_cast<std::uint32_t>(mLabels.size()),
+        .mLabelSize = static_cast<std::uint32_t>(n.mLabel.size()),
+        .mChildBegin = static_cast<std::uint32_t>(mChildKeys.size()),
+        .mChildCount = static_cast<std::uint32_t>(n.mChildren.size()),
+        .mParamChild = kNone,
+        .mExact = n.mExact,
+        .mPrefix = n.mPrefix,
+        .mParamNamesBegin = n.mParamNamesBegin,
+        .mParamNamesCount = n.mParamNamesCount,
+    });
+    mLabels.append(n.mLabel);
+    // reserve the child slots first so that siblings stay adjacent
+    mChildKeys.append(n.mChildKeys);
+    mChildIndices.resize(mChildIndices.size() + n.mChildren.size());
+    for (std::size_t i = 0; i < n.mChildren.size(); ++i) {
+        auto child = compileNode(n.mChildren[i]);
+        mChildIndices[mFlat[index].mChildBegin + i] = child;
+    }
+    if (n.mParamChild != kNone) {
+        auto child = compileNode(n.mParamChild);
+        mFlat[index].mParamChild = child;
+    }
+    return index;
+}
+
+bool HTTPRouter::matchFrom(std::uint32_t node, std::string_view path,
+                           HTTPRouteParams &params,
+                           std::uint32_t &id) const noexcept {
+    auto const &n = mFlat[node];
+    if (path.empty()) {
+        if (n.mExact == kNone) {
+            return false;
+        }
+        for (std::uint32_t i = 0; i < n.mParamNamesCount; ++i) {
+            params.mNames[i] = mParamNames[n.mParamNamesBegin + i];
+        }
+        id = n.mExact;
+        return true;
+    }
+    if (auto c = findChild(n, path.front()); c != kNone) {
+        auto edge = label(mFlat[c]);
+        if (path.starts_with(edge) &&
+            matchFrom(c, path.substr(edge.size()), params, id)) {
+            return true;
+        }
+    }
+    if (n.mParamChild != kNone &&
+        params.mSize < HTTPRouteParams::kMaxParams) {
+        auto segment = path.substr(0, path.find('/'));
+        if (!segment.empty()) {
+            params.mValues[params.mSize++] = segment;
+            if (matchFrom(n.mParamChild, path.substr(segment.size()), params,
+                          id)) {
+                return true;
+            }
+            --params.mSize;
+        }
+    }
+    return false;
+}
+
+std::optional<std::uint32_t>
+HTTPRouter::match(std::string_view path,
+                  HTTPRouteParams &params) const noexcept {
+    params.clear();
+    std::uint32_t id;
+    if (!matchFrom(0, path, params, id)) {
+        params.clear();
+        return std::nullopt;
+    }
+    return id;
+}
+
+std::optional<HTTPRouter::PrefixMatch>
+HTTPRouter::matchPrefix(std::string_view path) const noexcept {
+    std::optional<PrefixMatch> best;
+    std::uint32_t node = 0;
+    std::size_t length = 0;
+    while (true) {
+        auto const &n = mFlat[node];
+        if (n.mPrefix != kNone) {
+            best = PrefixMatch{n.mPrefix, length};
+        }
+        if (path.empty()) {
+            break;
+        }
+        auto c = findChild(n, path.front());
+        if (c == kNone) {
+            break;
+        }
+        auto edge = label(mFlat[c]);
+        if (!path.starts_with(edge)) {
+            break;
+        }
+        path.remove_prefix(edge.size());
+        length += edge.size();
+        node = c;
+    }
+    return best;
+}
+} // namespace co_async
@@ -0,0 +1,129 @@
+#pragma once
+#include <co_async/std.hpp>
+#include <co_async/generic/allocator.hpp>
+
+namespace co_async {
+// values captured for the {name} segments of the matched route, as views
+// into the request path
+struct HTTPRouteParams {
+    static constexpr std::size_t kMaxParams = 8;
+
+    std::string_view get(std::string_view name) const noexcept {
+        for (std::size_t i = 0; i < mSize; ++i) {
+            if (mNames[i] == name) {
+                return mValues[i];
+            }
+        }
+        return {};
+    }
+
+    std::size_t size() const noexcept {
+        return mSize;
+    }
+
+    void clear() noexcept {
+        mSize = 0;
+    }
+
+private:
+    std::array<std::string_view, kMaxParams> mNames;
+    std::array<std::string_view, kMaxParams> mValues;
+    std::size_t mSize = 0;
+
+    friend struct HTTPRouter;
+};
+
+// Radix tree over route paths: static edges are matched by their first byte,
+// a whole "{name}" segment matches any non-empty segment, static edges win
+// over parameters. Exact routes and prefix routes (plain string prefixes,
+// longest wins) share the tree. Every insert recompiles the tree into flat
+// depth-first arrays, so matching is O(path length), allocates nothing and
+// touches little memory; routes may only be inserted before the first match.
+struct HTTPRouter {
+    struct PrefixMatch {
+        std::uint32_t id;
+        std::size_t length;
+    };
+
+    // bit for one method name, 0 for a name never seen by methodMask
+    std::uint32_t methodBit(std::string_view method) const noexcept;
+    // bits for space separated method names, registering unknown ones
+    std::uint32_t methodMask(std::string_view methods);
+
+    // both return the id previously routed at that path, if any
+    std::optional<std::uint32_t> insert(std::string_view path,
+                                        std::uint32_t id);
+    std::optional<std::uint32_t> insertPrefix(std::string_view prefix,
+                                              std::uint32_t id);
+
+    std::optional<std::uint32_t> match(std::string_view path,
+                                       HTTPRouteParams &params) const noexcept;
+    std::optional<PrefixMatch>
+    matchPrefix(std::string_view path) const noexcept;
+
+    HTTPRouter();
+
+private:
+    static constexpr std::uint32_t kNone = static_cast<std::uint32_t>(-1);
+
+    struct Node {
+        String mLabel;
+        // static children, one per distinct first byte of their label, which
+        // is kept alongside in mChildKeys so lookups stay within this node
+        std::vector<std::uint32_t> mChildren;
+        String mChildKeys;
+        std::uint32_t mParamChild = kNone;
+        std::uint32_t mExact = kNone;
+        std::uint32_t mPrefix = kNone;
+        // names of the params along the path of mExact, in mParamNames
+        std::uint32_t mParamNamesBegin = 0;
+        std::uint32_t mParamNamesCount = 0;
+    };
+
+    // the compiled form of a Node, with every string stored in mLabels
+    struct FlatNode {
+        std::uint32_t mLabelBegin;
+        std::uint32_t mLabelSize;
+        // children are [mChildBegin, mChildBegin + mChildCount) of both
+        // mChildKeys and mChildIndices
+        std::uint32_t mChildBegin;
+        std::uint32_t mChildCount;
+        std::uint32_t mParamChild;
+        std::uint32_t mExact;
+        std::uint32_t mPrefix;
+        std::uint32_t mParamNamesBegin;
+        std::uint32_t mParamNamesCount;
+    };
+
+    std::vector<Node> mNodes;
+    std::vector<String> mParamNames;
+    std::vector<String> mMethods;
+
+    std::vector<FlatNode> mFlat;
+    String mLabels;
+    String mChildKeys;
+    std::vector<std::uint32_t> mChildIndices;
+
+    std::uint32_t insertStatic(std::uint32_t node, std::string_view label);
+    std::uint32_t findChild(Node const &node, char c) const noexcept;
+    void compile();
+    std::uint32_t compileNode(std::uint32_t node);
+
+    std::string_view label(FlatNode const &node) const noexcept {
+        return {mLabels.data() + node.mLabelBegin, node.mLabelSize};
+    }
+
+    std::uint32_t findChild(FlatNode const &node, char c) const noexcept {
+        auto keys = mChildKeys.data() + node.mChildBegin;
+        for (std::uint32_t i = 0; i < node.mChildCount; ++i) {
+            if (keys[i] == c) {
+                return mChildIndices[node.mChildBegin + i];
+            }
+        }
+        return kNone;
+    }
+
+    bool matchFrom(std::uint32_t node, std::string_view path,
+                   HTTPRouteParams &params, std::uint32_t &id) const noexcept;
+};
+} // namespace co_async
@@ -16,22 +16,21 @@ namespace co_async {
 struct HTTPServer::Impl {
     struct Route {
         HTTPHandler mHandler;
-        std::vector<String> mMethods;
+        // bits from HTTPRouter::methodMask
+        std::uint32_t mMethods;
 
-        bool checkMethod(std::string_view method) const {
-            return std::find(mMethods.begin(), mMethods.end(), method) !=
-                   mMethods.end();
+        bool checkMethod(std::uint32_t method) const {
+            return (mMethods & method) != 0;
         }
     };
 
     struct PrefixRoute {
         HTTPPrefixHandler mHandler;
         HTTPRouteMode mRouteMode;
-        std::vector<String> mMethods;
+        std::uint32_t mMethods;
 
-        bool checkMethod(std::string_view method) const {
-            return std::find(mMethods.begin(), mMethods.end(), method) !=
-                   mMethods.end();
+        bool checkMethod(std::uint32_t method) const {
+            return (mMethods & method) != 0;
         }
 
         bool checkSuffix(std::string_view &suffix) const {
@@ -79,8 +78,10 @@ struct HTTPServer::Impl {
         }
     };
 
-    SimpleMap<String, Route> mRoutes;
-    std::vector<std::pair<String, PrefixRoute>> mPrefixRoutes;
+    HTTPRouter mRouter;
+    // indexed by the ids mRouter matches
+    std::vector<Route> mRoutes;
+    std::vector<PrefixRoute> mPrefixRoutes;
     HTTPHandler mDefaultRoute = [](IO &io) -> Task<Expected<>> {
         co_return co_await make_error_response(io, 404);
     };
@@ -90,37 +91,38 @@ struct HTTPServer::Impl {
 #endif
 
     Task<Expected<>> doHandleRequest(IO &io) const {
-        if (auto route = mRoutes.at(io.request.uri.path)) {
-            if (!route->checkMethod(io.request.method)) [[unlikely]] {
+        auto path = std::string_view(io.request.uri.path);
+        auto method = mRouter.methodBit(io.request.method);
+        if (auto id = mRouter.match(path, io.params)) {
+            auto const &route = mRoutes[*id];
+            if (!route.checkMethod(method)) [[unlikely]] {
                 co_await co_await make_error_response(io, 405);
                 co_return {};
             }
-            co_await co_await route->mHandler(io);
+            co_await co_await route.mHandler(io);
             co_return {};
         }
-        for (auto const &[prefix, route]: mPrefixRoutes) {
-            if (io.request.uri.path.starts_with(prefix)) {
-                if (!route.checkMethod(io.request.method)) [[unlikely]] {
-                    co_await co_await make_error_response(io, 405);
-                    co_return {};
-                }
-                auto suffix = std::string_view(io.request.uri.path);
-                suffix.remove_prefix(prefix.size());
-                if (!route.checkSuffix(suffix)) [[unlikely]] {
-                    co_await co_await make_error_response(io, 405);
-                    co_return {};
-                }
+        if (auto prefix = mRouter.matchPrefix(path)) {
+            auto const &route = mPrefixRoutes[prefix->id];
+            if (!route.checkMethod(method)) [[unlikely]] {
+                co_await co_await make_error_response(io, 405);
+                co_return {};
+            }
+            auto suffix = path.substr(prefix->length);
+            if (!route.checkSuffix(suffix)) [[unlikely]] {
+                co_await co_await make_error_response(io, 405);
+                co_return {};
+            }
 #if CO_ASYNC_DEBUG
-                auto ret = co_await route.mHandler(io, suffix);
-                if (ret.has_error() && mLogRequests) {
-                    std::clog << "SERVER ERROR: " << ret.error() << '\n';
-                }
-                co_return ret;
+            auto ret = co_await route.mHandler(io, suffix);
+            if (ret.has_error() && mLogRequests) {
+                std::clog << "SERVER ERROR: " << ret.error() << '\n';
+            }
+            co_return ret;
 #else
-                co_await co_await route.mHandler(io, suffix);
-                co_return {};
+            co_await co_await route.mHandler(io, suffix);
+            co_return {};
 #endif
-            }
         }
         co_await co_await mDefaultRoute(io);
         co_return {};
@@ -185,6 +187,22 @@ Task<Expected<>> HTTPServer::IO::response(HTTPResponse resp,
     co_return {};
 }
 
+Task<Expected<>> HTTPServer::IO::response(HTTPResponse resp, FileHandle &file,
+                                          std::uint64_t offset,
+                                          std::size_t size) {
+#if CO_ASYNC_DEBUG
+    mResponseSavedForDebug = resp;
+#endif
+    if (!mBodyRead) {
+        co_await co_await request_body();
+    }
+    builtinHeaders(resp);
+    co_await co_await mHttp->writeResponse(resp);
+    co_await co_await mHttp->writeBodyFile(file, offset, size);
+    mBodyRead = false;
+    co_return {};
+}
+
 void HTTPServer::IO::builtinHeaders(HTTPResponse &res) {
     res.headers.insert("server"_s, "co_async/0.0.1"_s);
     res.headers.insert("accept"_s, "*/*"_s);
@@ -208,22 +226,24 @@ void HTTPServer::timeout(std::chrono::steady_clock::duration timeout) {
 
 void HTTPServer::route(std::string_view methods, std::string_view path,
                        HTTPHandler handler) {
-    mImpl->mRoutes.insert_or_assign(
-        String(path),
-        {handler, split_string(upper_string(methods), ' ').collect()});
+    Impl::Route route{handler, mImpl->mRouter.methodMask(methods)};
+    auto id = static_cast<std::uint32_t>(mImpl->mRoutes.size());
+    if (auto old = mImpl->mRouter.insert(path, id)) {
+        mImpl->mRoutes[*old] = std::move(route);
+    } else {
+        mImpl->mRoutes.push_back(std::move(route));
+    }
 }
 
 void HTTPServer::route(std::string_view methods, std::string_view prefix,
                        HTTPRouteMode mode, HTTPPrefixHandler handler) {
-    auto it = std::lower_bound(mImpl->mPrefixRoutes.begin(),
-                               mImpl->mPrefixRoutes.end(), prefix,
-                               [](auto const &item, auto const &prefix) {
-                                   return item.first.size() > prefix.size();
-                               });
-    mImpl->mPrefixRoutes.insert(
-        it,
-        {String(prefix),
-         {handler, mode, split_string(upper_string(methods), ' ').collect()}});
+    Impl::PrefixRoute route{handler, mode, mImpl->mRouter.methodMask(methods)};
+    auto id = static_cast<std::uint32_t>(mImpl->mPrefixRoutes.size());
+    if (auto old = mImpl->mRouter.insertPrefix(prefix, id)) {
+        mImpl->mPrefixRoutes[*old] = std::move(route);
+    } else {
+        mImpl->mPrefixRoutes.push_back(std::move(route));
+    }
 }
 
 void HTTPServer::route(HTTPHandler handler) {
@@ -254,10 +274,6 @@ HTTPServer::prepareHTTP(SocketHandle handle) const {
 }
 
 Task<Expected<>> HTTPServer::handle_http(SocketHandle handle) const {
-    // #if CO_ASYNC_ALLOC
-    //     std::pmr::unsynchronized_pool_resource pool{currentAllocator};
-    //     ReplaceAllocator _ = &pool;
-    // #endif
     /* int h = handle.fileNo(); */
 #if CO_ASYNC_DEBUG
     auto err =
@@ -276,29 +292,83 @@ Task<Expected<>> HTTPServer::handle_http(SocketHandle handle) const {
     co_return {};
 }
 
+Expected<> HTTPServer::serve_sharded(IOContextPool &pool,
+                                     SocketAddress const &addr,
+                                     HTTPShardOptions options) const {
+    std::vector<SocketListener> listeners;
+    listeners.reserve(pool.size());
+    for (std::size_t i = 0; i < pool.size(); ++i) {
+        auto listener =
+            pool.context(i).join(listener_bind(addr, options.backlog));
+        if (listener.has_error()) [[unlikely]] {
+            return CO_ASYNC_ERROR_FORWARD(listener);
+        }
+        listeners.push_back(std::move(*listener));
+    }
+    for (std::size_t i = 0; i < pool.size(); ++i) {
+        pool.spawn(i, co_catch(doAcceptShard(std::move(listeners[i]),
+                                             options.multishotAccept)));
+    }
+    return {};
+}
+
+Task<Expected<>> HTTPServer::doAcceptShard(SocketListener listener,
+                                           bool multishotAccept) const {
+    auto isTransient = [](std::error_code const &e) {
+        return e == std::errc::connection_aborted ||
+               e == std::errc::too_many_files_open ||
+               e == std::errc::too_many_files_open_in_system ||
+               e == std::errc::no_buffer_space ||
+               e == std::errc::not_enough_memory ||
+               e == std::errc::interrupted;
+    };
+    std::optional<MultishotAcceptor> acceptor;
+    if (multishotAccept) {
+        acceptor.emplace(listener);
+    }
+    while (true) {
+        Expected<SocketHandle> income;
+        if (acceptor) {
+            income = co_await acceptor->accept();
+        } else {
+            income = co_await listener_accept(listener);
+        }
+        if (income.has_error()) [[unlikely]] {
+            if (isTransient(income.error())) {
+                continue;
+            }
+            co_return CO_ASYNC_ERROR_FORWARD(income);
+        }
+        co_spawn(handle_http(std::move(*income)));
+    }
+}
+
 Task<Expected<>>
 HTTPServer::handle_http_redirect_to_https(SocketHandle handle) const {
     using namespace std::string_literals;
     auto http = co_await prepareHTTP(std::move(handle));
     while (true) {
-        IO io(http.get());
-        if (!co_await co_await io.readRequestHeader()) {
-            break;
-        }
-        if (auto host = io.request.headers.get("host")) {
-            auto location = "https://"_s + *host + io.request.uri.dump();
-            HTTPResponse res = {
-                .status = 302,
-                .headers =
-                    {
-                        {"location"_s, location},
-                        {"content-type"_s, "text/plain"_s},
-                    },
-            };
-            co_await co_await io.response(res, location);
-        } else {
-            co_await co_await make_error_response(io, 403);
+        {
+            IO io(http.get());
+            if (!co_await co_await io.readRequestHeader()) {
+                break;
+            }
+            if (auto host = io.request.headers.get("host")) {
+                auto location = "https://"_s + *host + io.request.uri.dump();
+                HTTPResponse res = {
+                    .status = 302,
+                    .headers =
+                        {
+                            {"location"_s, location},
+                            {"content-type"_s, "text/plain"_s},
+                        },
+                };
+                co_await co_await io.response(res, location);
+            } else {
+                co_await co_await make_error_response(io, 403);
+            }
         }
+        http->finishServerState();
     }
     co_return {};
 }
@@ -315,48 +385,55 @@ Task<Expected<>> HTTPServer::handle_https(SocketHandle handle,
 Task<Expected<>>
 HTTPServer::doHandleConnection(std::unique_ptr<HTTPProtocol> http) const {
     while (true) {
-        IO io(http.get());
-        if (!co_await co_await io.readRequestHeader()) {
-            break;
-        }
+        {
+            IO io(http.get());
+            if (!co_await co_await io.readRequestHeader()) {
+                break;
+            }
 #if CO_ASYNC_DEBUG
-        std::chrono::steady_clock::time_point t0;
-        if (mImpl->mLogRequests) {
-            std::clog << io.request.method + ' ' + io.request.uri.dump() + '\n';
-            for (auto [k, v]: io.request.headers) {
-                if (k == "cookie" || k == "set-cookie" ||
-                    k == "authorization") {
-                    v = "*****";
-                }
-                std::clog << "      " + capitalizeHTTPHeader(k) + ": " + v +
+            std::chrono::steady_clock::time_point t0;
+            if (mImpl->mLogRequests) {
+                std::clog << io.request.method + ' ' + io.request.uri.dump() +
                                  '\n';
+                for (auto [k, v]: io.request.headers) {
+                    if (k == "cookie" || k == "set-cookie" ||
+                        k == "authorization") {
+                        v = "*****";
+                    }
+                    std::clog << "      " + capitalizeHTTPHeader(k) + ": " + v +
+                                     '\n';
+                }
+                t0 = std::chrono::steady_clock::now();
             }
-            t0 = std::chrono::steady_clock::now();
-        }
 #endif
-        co_await co_await mImpl->doHandleRequest(io);
+            co_await co_await mImpl->doHandleRequest(io);
 #if CO_ASYNC_DEBUG
-        if (mImpl->mLogRequests) {
-            auto dt = std::chrono::steady_clock::now() - t0;
-            std::clog << io.request.method + ' ' + io.request.uri.dump() + ' ' +
-                             to_string(io.mResponseSavedForDebug.status) + ' ' +
-                             String(getHTTPStatusName(
-                                 io.mResponseSavedForDebug.status)) +
-                             ' ' +
-                             to_string(std::chrono::duration_cast<
-                                           std::chrono::milliseconds>(dt)
-                                           .count()) +
-                             "ms\n";
-            for (auto [k, v]: io.mResponseSavedForDebug.headers) {
-                if (k == "cookie" || k == "set-cookie" ||
-                    k == "authorization") {
-                    v = "*****";
+            if (mImpl->mLogRequests) {
+                auto dt = std::chrono::steady_clock::now() - t0;
+                std::clog << io.request.method + ' ' + io.request.uri.dump() +
+                                 ' ' +
+                                 to_string(io.mResponseSavedForDebug.status) +
+                                 ' ' +
+                                 String(getHTTPStatusName(
+                                     io.mResponseSavedForDebug.status)) +
+                                 ' ' +
+                                 to_string(std::chrono::duration_cast<
+                                               std::chrono::milliseconds>(dt)
+                                               .count()) +
+                                 "ms\n";
+                for (auto [k, v]: io.mResponseSavedForDebug.headers) {
+                    if (k == "cookie" || k == "set-cookie" ||
+                        k == "authorization") {
+                        v = "*****";
+                    }
+                    std::clog << "      " + capitalizeHTTPHeader(k) + ": " + v +
+                                     '\n';
                 }
-                std::clog << "      " + capitalizeHTTPHeader(k) + ": " + v +
-                                 '\n';
             }
-        }
 #endif
+        }
+        // io.request is gone, so the arena behind its strings can be too
+        http->finishServerState();
     }
     co_return {};
 }
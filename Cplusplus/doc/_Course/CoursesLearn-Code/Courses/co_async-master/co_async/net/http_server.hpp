@@ -1,9 +1,11 @@
 #pragma once
 #include <co_async/std.hpp>
 #include <co_async/awaiter/task.hpp>
+#include <co_async/generic/io_context_pool.hpp>
 #include <co_async/iostream/socket_stream.hpp>
 #include <co_async/iostream/ssl_socket_stream.hpp>
 #include <co_async/net/http_protocol.hpp>
+#include <co_async/net/http_router.hpp>
 #include <co_async/net/http_string_utils.hpp>
 #include <co_async/net/uri.hpp>
 #include <co_async/platform/fs.hpp>
@@ -25,16 +27,32 @@ struct SSLServerState {
     PImpl<SSLServerSessionCache> cache;
 };
 
+struct HTTPShardOptions {
+    int backlog = SOMAXCONN;
+    // keep one multishot accept SQE armed per shard instead of submitting one
+    // SQE per connection
+    bool multishotAccept = true;
+};
+
 struct HTTPServer {
+    // Under CO_ASYNC_ALLOC the strings of request live in an arena that is
+    // freed as soon as the response is done: copy them, rather than move
+    // them, into anything that outlives the handler.
     struct IO {
         explicit IO(HTTPProtocol *http) noexcept : mHttp(http) {}
 
         HTTPRequest request;
+        // the {name} segments of the matched route path
+        HTTPRouteParams params;
         Task<Expected<bool>> readRequestHeader();
         Task<Expected<String>> request_body();
         Task<Expected<>> request_body_stream(OwningStream &out);
         Task<Expected<>> response(HTTPResponse resp, std::string_view content);
         Task<Expected<>> response(HTTPResponse resp, OwningStream &body);
+        // sends file bytes [offset, offset + size) as the body, zero-copy
+        // over plain sockets
+        Task<Expected<>> response(HTTPResponse resp, FileHandle &file,
+                                  std::uint64_t offset, std::size_t size);
 
         BorrowedStream &extractSocket() const noexcept {
             return mHttp->sock;
@@ -76,6 +94,15 @@ struct HTTPServer {
                                   SSLServerState &https) const;
     Task<Expected<>>
     doHandleConnection(std::unique_ptr<HTTPProtocol> http) const;
+    // Sharded mode: every reactor of pool binds its own SO_REUSEPORT listener
+    // on addr and runs its own accept loop, and connections stay on the
+    // reactor that accepted them, so shards share nothing but the read-only
+    // routes. Returns once all listeners are bound; the shards then serve
+    // until the pool stops. Must not be called from a thread of pool.
+    Expected<> serve_sharded(IOContextPool &pool, SocketAddress const &addr,
+                             HTTPShardOptions options = {}) const;
+    Task<Expected<>> doAcceptShard(SocketListener listener,
+                                   bool multishotAccept) const;
     static Task<Expected<>> make_error_response(IO &io, int status);
 
 private:
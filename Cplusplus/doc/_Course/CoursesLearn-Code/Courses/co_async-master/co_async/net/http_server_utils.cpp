@@ -81,7 +81,7 @@ Task<Expected<>> HTTPServerUtils::make_error_response(HTTPServer::IO &io,
 
 Task<Expected<>> HTTPServerUtils::make_response_from_file_or_directory(
     HTTPServer::IO &io, std::filesystem::path path) {
-    auto stat = co_await fs_stat(path, STATX_MODE);
+    auto stat = co_await fs_stat(path, STATX_MODE | STATX_SIZE);
     if (!stat) [[unlikely]] {
         co_return co_await make_error_response(io, 404);
     }
@@ -99,16 +99,16 @@ Task<Expected<>> HTTPServerUtils::make_response_from_file_or_directory(
                  guessContentTypeByExtension(path.extension().string())},
             },
     };
-    auto f = co_await co_await file_open(path, OpenMode::Read);
-    co_await co_await io.response(res, f);
-    co_await f.close();
+    auto f = co_await co_await fs_open(path, OpenMode::Read);
+    co_await co_await io.response(res, f, 0, stat->size());
+    co_await co_await fs_close(std::move(f));
     co_return {};
 }
 
 Task<Expected<>>
 HTTPServerUtils::make_response_from_path(HTTPServer::IO &io,
                                          std::filesystem::path path) {
-    auto stat = co_await fs_stat(path, STATX_MODE);
+    auto stat = co_await fs_stat(path, STATX_MODE | STATX_SIZE);
     if (!stat) [[unlikely]] {
         co_return co_await make_error_response(io, 404);
     }
@@ -129,16 +129,16 @@ HTTPServerUtils::make_response_from_path(HTTPServer::IO &io,
                  guessContentTypeByExtension(path.extension().string())},
             },
     };
-    auto f = co_await co_await file_open(path, OpenMode::Read);
-    co_await co_await io.response(res, f);
-    co_await f.close();
+    auto f = co_await co_await fs_open(path, OpenMode::Read);
+    co_await co_await io.response(res, f, 0, stat->size());
+    co_await co_await fs_close(std::move(f));
     co_return {};
 }
 
 Task<Expected<>>
 HTTPServerUtils::make_response_from_file(HTTPServer::IO &io,
                                          std::filesystem::path path) {
-    auto stat = co_await fs_stat(path, STATX_MODE);
+    auto stat = co_await fs_stat(path, STATX_MODE | STATX_SIZE);
     if (!stat || stat->is_directory()) [[unlikely]] {
         co_return co_await make_error_response(io, 404);
     }
@@ -153,9 +153,9 @@ HTTPServerUtils::make_response_from_file(HTTPServer::IO &io,
                  guessContentTypeByExtension(path.extension().string())},
             },
     };
-    auto f = co_await co_await file_open(path, OpenMode::Read);
-    co_await co_await io.response(res, f);
-    co_await f.close();
+    auto f = co_await co_await fs_open(path, OpenMode::Read);
+    co_await co_await io.response(res, f, 0, stat->size());
+    co_await co_await fs_close(std::move(f));
     co_return {};
 }
 } // namespace co_async
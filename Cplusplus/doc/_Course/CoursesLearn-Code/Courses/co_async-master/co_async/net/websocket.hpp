@@ -9,6 +9,7 @@
 #include <co_async/net/http_client.hpp>
 #include <co_async/net/http_server.hpp>
 #include <co_async/net/http_server_utils.hpp>
+#include <co_async/net/websocket_mask.hpp>
 #include <hashlib/hashlib.hpp>
 
 namespace co_async {
@@ -34,10 +35,11 @@ inline std::string websocketGenerateNonce() {
     return base64::encode_into<std::string>(buf, buf + 16);
 }
 
-inline std::string websocketSecretHash(std::string userKey) {
+inline std::string websocketSecretHash(std::string_view userKey) {
     // websocket 官方要求的神秘仪式
     SHA1 sha1;
-    std::string inKey = userKey + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    std::string inKey =
+        std::string(userKey) + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
     sha1.add(inKey.data(), inKey.size());
     uint8_t buf[SHA1::HashBytes];
     sha1.getHash(buf);
@@ -61,7 +63,7 @@ inline Task<Expected<bool>> httpUpgradeToWebSocket(HTTPServer::IO &io) {
         {
             {"connection", "Upgrade"},
             {"upgrade", "websocket"},
-            {"sec-websocket-accept", wsNewKey},
+            {"sec-websocket-accept", String(wsNewKey)},
         },
     };
     co_await co_await io.response(res, "");
@@ -70,6 +72,7 @@ inline Task<Expected<bool>> httpUpgradeToWebSocket(HTTPServer::IO &io) {
 
 struct WebSocketPacket {
     enum Opcode : uint8_t {
+        kOpcodeContinuation = 0,
         kOpcodeText = 1,
         kOpcodeBinary = 2,
         kOpcodeClose = 8,
@@ -81,47 +84,105 @@ struct WebSocketPacket {
     REFLECT(opcode, content);
 };
 
+// the head of a frame whose payload is still to be read from the stream,
+// see wsRecvFrameChunk
+struct WebSocketFrame {
+    WebSocketPacket::Opcode opcode;
+    bool fin;
+    bool masked;
+    std::array<char, 4> mask;
+    std::uint64_t length;
+    // how much of the payload was handed out so far
+    std::uint64_t received = 0;
+
+    bool done() const noexcept {
+        return received == length;
+    }
+};
+
+inline Task<Expected<WebSocketFrame>> wsRecvFrameHead(BorrowedStream &ws) {
+    WebSocketFrame frame;
+    char head[2];
+    co_await co_await ws.getspan(head);
+    uint8_t head0 = static_cast<uint8_t>(head[0]);
+    uint8_t head1 = static_cast<uint8_t>(head[1]);
+    frame.fin = (head0 & 0x80) != 0;
+    frame.opcode = static_cast<WebSocketPacket::Opcode>(head0 & 0x0F);
+    frame.masked = (head1 & 0x80) != 0;
+    uint8_t payloadLen8 = head1 & 0x7F;
+    if (frame.opcode >= 8 && (payloadLen8 >= 0x7E || !frame.fin)) [[unlikely]] {
+        co_return std::errc::protocol_error;
+    }
+    // the extended length and the mask, read in one go
+    std::size_t lengthSize =
+        payloadLen8 == 0x7F ? 8 : payloadLen8 == 0x7E ? 2 : 0;
+    char rest[12];
+    co_await co_await ws.getspan(
+        std::span<char>(rest, lengthSize + (frame.masked ? 4 : 0)));
+    if (lengthSize == 8) {
+        uint64_t payloadLen64;
+        std::memcpy(&payloadLen64, rest, sizeof(payloadLen64));
+        frame.length = byteswap_if_little(payloadLen64);
+    } else if (lengthSize == 2) {
+        uint16_t payloadLen16;
+        std::memcpy(&payloadLen16, rest, sizeof(payloadLen16));
+        frame.length = byteswap_if_little(payloadLen16);
+    } else {
+        frame.length = payloadLen8;
+    }
+    if (frame.masked) {
+        std::memcpy(frame.mask.data(), rest + lengthSize, frame.mask.size());
+    }
+    co_return frame;
+}
+
+// hands out the next piece of the payload of frame, unmasked in place in the
+// stream buffer, so no payload is copied on the way; the span is only valid
+// until the next read from ws, and empty once the whole payload was read
+inline Task<Expected<std::span<char const>>>
+wsRecvFrameChunk(BorrowedStream &ws, WebSocketFrame &frame) {
+    if (frame.done()) {
+        co_return std::span<char const>();
+    }
+    if (ws.bufempty()) {
+        co_await co_await ws.fillmore();
+    }
+    auto buf = ws.peekbuf();
+    auto n = static_cast<std::size_t>(
+        std::min<std::uint64_t>(buf.size(), frame.length - frame.received));
+    // the stream buffer itself is writable, peekbuf() just does not say so
+    std::span<char> chunk(const_cast<char *>(buf.data()), n);
+    if (frame.masked) {
+        websocketMask(chunk, frame.mask,
+                      static_cast<std::size_t>(frame.received));
+    }
+    ws.seenbuf(n);
+    frame.received += n;
+    co_return chunk;
+}
+
 inline Task<Expected<WebSocketPacket>> wsRecvPacket(BorrowedStream &ws) {
     WebSocketPacket packet;
-    auto head = co_await co_await ws.getn(2);
-    bool fin;
+    WebSocketFrame frame;
+    bool first = true;
     do {
-        uint8_t head0 = static_cast<uint8_t>(head[0]);
-        uint8_t head1 = static_cast<uint8_t>(head[1]);
-        fin = (head0 & 0x80) != 0;
-        packet.opcode = static_cast<WebSocketPacket::Opcode>(head0 & 0x0F);
-        bool masked = (head1 & 0x80) != 0;
-        uint8_t payloadLen8 = head1 & 0x7F;
-        size_t payloadLen;
-        if (packet.opcode >= 8 && packet.opcode <= 10 && payloadLen8 >= 0x7E) [[unlikely]] {
-            co_return std::errc::protocol_error;
+        frame = co_await co_await wsRecvFrameHead(ws);
+        if (first) {
+            packet.opcode = frame.opcode;
+            first = false;
         }
-        if (payloadLen8 == 0x7E) {
-            auto payloadLen16 = byteswap_if_little(co_await co_await ws.getstruct<uint16_t>());
-            payloadLen = static_cast<size_t>(payloadLen16);
-        } else if (payloadLen8 == 0x7F) {
-            auto payloadLen64 = byteswap_if_little(co_await co_await ws.getstruct<uint64_t>());
-            if constexpr (sizeof(uint64_t) > sizeof(size_t)) {
-                if (payloadLen64 > std::numeric_limits<size_t>::max()) {
-                    co_return std::errc::not_enough_memory;
-                }
-            }
-            payloadLen = static_cast<size_t>(payloadLen64);
-        } else {
-            payloadLen = static_cast<size_t>(payloadLen8);
-        }
-        std::string mask;
-        if (masked) {
-            mask = co_await co_await ws.getn(4);
+        if (frame.length > packet.content.max_size() - packet.content.size())
+            [[unlikely]] {
+            co_return std::errc::not_enough_memory;
         }
-        auto data = co_await co_await ws.getn(payloadLen);
-        if (masked) {
-            for (size_t i = 0; i != data.size(); ++i) {
-                data[i] ^= mask[i % 4];
+        while (true) {
+            auto chunk = co_await co_await wsRecvFrameChunk(ws, frame);
+            if (chunk.empty()) {
+                break;
             }
+            packet.content.append(chunk.data(), chunk.size());
         }
-        packet.content += data;
-    } while (!fin);
+    } while (!frame.fin);
     co_return std::move(packet);
 }
 
@@ -142,8 +203,8 @@ inline Task<Expected<>> wsSendPacket(BorrowedStream &ws, WebSocketPacket packet,
     head[0] = static_cast<uint8_t>(head0);
     head[1] = static_cast<uint8_t>(head1);
     co_await co_await ws.write(head);
-    if (packet.content.size() > 0x7E) {
-        if (packet.content.size() <= 0xFFFF) {
+    if (payloadLen8 >= 0x7E) {
+        if (payloadLen8 == 0x7E) {
             auto payloadLen16 = static_cast<uint16_t>(packet.content.size());
             co_await co_await ws.putstruct(byteswap_if_little(payloadLen16));
         } else {
@@ -158,9 +219,8 @@ inline Task<Expected<>> wsSendPacket(BorrowedStream &ws, WebSocketPacket packet,
         mask_buf[2] = (mask >> 8) & 0xFF;
         mask_buf[3] = mask & 0xFF;
         co_await co_await ws.write(mask_buf);
-        for (size_t i = 0; i != packet.content.size(); ++i) {
-            packet.content[i] ^= mask_buf[i % 4];
-        }
+        websocketMask(packet.content,
+                      {mask_buf[0], mask_buf[1], mask_buf[2], mask_buf[3]});
     }
     co_await co_await ws.write(packet.content);
     co_await co_await ws.flush();
@@ -172,6 +232,10 @@ struct WebSocket {
     std::function<Task<Expected<>>(std::string const &)> mOnMessage;
     std::function<Task<Expected<>>()> mOnClose;
     std::function<Task<Expected<>>(std::chrono::steady_clock::duration)> mOnPong;
+    std::function<Task<Expected<>>(WebSocketPacket::Opcode, std::span<char const>, bool)> mOnFragment;
+    // the message being assembled for mOnMessage, across its frames
+    std::string mMessage;
+    WebSocketPacket::Opcode mMessageOpcode = WebSocketPacket::kOpcodeText;
     bool mHalfClosed = false;
     bool mWaitingPong = true;
     std::chrono::steady_clock::time_point mLastPingTime{};
@@ -189,6 +253,14 @@ struct WebSocket {
         mOnMessage = std::move(onMessage);
     }
 
+    // streams messages instead of assembling them for on_message: the
+    // handler gets each piece of payload as it arrives, unmasked in place in
+    // the socket buffer and only valid until it returns, with the message
+    // opcode, and with the last flag set on the final piece of a message
+    void on_fragment(std::function<Task<Expected<>>(WebSocketPacket::Opcode, std::span<char const>, bool)> onFragment) {
+        mOnFragment = std::move(onFragment);
+    }
+
     void on_close(std::function<Task<Expected<>>()> onClose) {
         mOnClose = std::move(onClose);
     }
@@ -228,10 +300,32 @@ struct WebSocket {
         });
     }
 
+    Task<Expected<>> recvMessageFrame(WebSocketFrame &frame) {
+        if (frame.opcode != WebSocketPacket::kOpcodeContinuation) {
+            mMessageOpcode = frame.opcode;
+        }
+        do {
+            auto chunk = co_await co_await wsRecvFrameChunk(sock, frame);
+            bool last = frame.fin && frame.done();
+            if (mOnFragment) {
+                if (!chunk.empty() || last) {
+                    co_await co_await mOnFragment(mMessageOpcode, chunk, last);
+                }
+            } else if (mOnMessage) {
+                mMessage.append(chunk.data(), chunk.size());
+            }
+        } while (!frame.done());
+        if (frame.fin && !mOnFragment && mOnMessage) {
+            co_await co_await mOnMessage(mMessage);
+            mMessage.clear();
+        }
+        co_return {};
+    }
+
     Task<Expected<>> start(std::chrono::steady_clock::duration pingPongTimeout = std::chrono::seconds(5)) {
         while (true) {
-            auto maybePacket = co_await co_timeout(wsRecvPacket(sock), pingPongTimeout);
-            if (maybePacket == std::errc::stream_timeout) {
+            auto maybeFrame = co_await co_timeout(wsRecvFrameHead(sock), pingPongTimeout);
+            if (maybeFrame == std::errc::stream_timeout) {
                 if (mWaitingPong) {
                     break;
                 }
@@ -240,15 +334,25 @@ struct WebSocket {
                 continue;
             }
             mWaitingPong = false;
-            if (maybePacket == eofError()) {
+            if (maybeFrame == eofError()) {
                 break;
             }
-            auto packet = co_await std::move(maybePacket);
-            if (packet.opcode == packet.kOpcodeText || packet.opcode == packet.kOpcodeBinary) {
-                if (mOnMessage) {
-                    co_await co_await mOnMessage(packet.content);
+            auto frame = co_await std::move(maybeFrame);
+            if (frame.opcode <= WebSocketPacket::kOpcodeBinary) {
+                co_await co_await recvMessageFrame(frame);
+                continue;
+            }
+            // control frames carry 125 bytes at most; reserved opcodes are
+            // read past and ignored
+            WebSocketPacket packet{.opcode = frame.opcode, .content = {}};
+            while (true) {
+                auto chunk = co_await co_await wsRecvFrameChunk(sock, frame);
+                if (chunk.empty()) {
+                    break;
                 }
-            } else if (packet.opcode == packet.kOpcodePing) {
+                packet.content.append(chunk.data(), chunk.size());
+            }
+            if (packet.opcode == packet.kOpcodePing) {
                 // debug(), "收到ping";
                 packet.opcode = packet.kOpcodePong;
                 co_await co_await wsSendPacket(sock, packet);
@@ -287,20 +391,19 @@ inline Task<Expected<WebSocket>> websocket_server(HTTPServer::IO &io) {
 
 inline Task<Expected<WebSocket>> websocket_client(HTTPConnection &conn, URI uri) {
     std::string nonceKey;
-    using namespace std::string_literals;
     nonceKey = websocketGenerateNonce();
     HTTPRequest request = {
-        .method = "GET"s,
+        .method = "GET"_s,
         .uri = uri,
         .headers = {
-            {"sec-websocket-key"s, nonceKey},
-            {"connection"s, "Upgrade"s},
-            {"upgrade"s, "websocket"s},
-            {"sec-websocket-version"s, "13"s},
+            {"sec-websocket-key"_s, String(nonceKey)},
+            {"connection"_s, "Upgrade"_s},
+            {"upgrade"_s, "websocket"_s},
+            {"sec-websocket-version"_s, "13"_s},
         },
     };
     auto [response, _] = co_await co_await conn.request(request);
-    if (response.headers.get("sec-websocket-accept") != websocketSecretHash(nonceKey)) {
+    if (response.headers.get("sec-websocket-accept") != String(websocketSecretHash(nonceKey))) {
         co_return std::errc::protocol_error;
     }
     co_return WebSocket(conn.extractSocket());
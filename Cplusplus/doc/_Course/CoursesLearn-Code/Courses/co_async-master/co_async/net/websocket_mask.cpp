@@ -0,0 +1,55 @@
+#include <co_async/net/websocket_mask.hpp>
+#if defined(__SSE2__)
+# include <immintrin.h>
+#elif defined(__ARM_NEON)
+# include <arm_neon.h>
+#endif
+
+namespace co_async {
+void websocketMask(std::span<char> data, std::array<char, 4> key,
+                   std::size_t offset) noexcept {
+    char *p = data.data();
+    char *const end = p + data.size();
+    // the key as it lines up with data: byte i of data takes key[offset + i]
+    char rotated[4];
+    for (std::size_t i = 0; i < 4; ++i) {
+        rotated[i] = key[(offset + i) & 3];
+    }
+    // every step below advances by a multiple of 4, keeping that alignment
+    std::uint32_t key32;
+    std::memcpy(&key32, rotated, sizeof(key32));
+#if defined(__AVX2__)
+    auto const key256 = _mm256_set1_epi32(static_cast<int>(key32));
+    for (; end - p >= 32; p += 32) {
+        auto v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p),
+                            _mm256_xor_si256(v, key256));
+    }
+#endif
+#if defined(__SSE2__)
+    // x86-64 baseline, and the tail of the AVX2 loop
+    auto const key128 = _mm_set1_epi32(static_cast<int>(key32));
+    for (; end - p >= 16; p += 16) {
+        auto v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p),
+                         _mm_xor_si128(v, key128));
+    }
+#elif defined(__ARM_NEON)
+    auto const key128 = vreinterpretq_u8_u32(vdupq_n_u32(key32));
+    for (; end - p >= 16; p += 16) {
+        auto v = vld1q_u8(reinterpret_cast<std::uint8_t const *>(p));
+        vst1q_u8(reinterpret_cast<std::uint8_t *>(p), veorq_u8(v, key128));
+    }
+#endif
+    std::uint64_t key64 = std::uint64_t(key32) << 32 | key32;
+    for (; end - p >= 8; p += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        word ^= key64;
+        std::memcpy(p, &word, sizeof(word));
+    }
+    for (std::size_t i = 0; p != end; ++p, ++i) {
+        *p ^= rotated[i & 3];
+    }
+}
+} // namespace co_async
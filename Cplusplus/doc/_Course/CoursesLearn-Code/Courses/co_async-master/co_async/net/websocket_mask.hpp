@@ -0,0 +1,12 @@
+#pragma once
+#include <co_async/std.hpp>
+
+namespace co_async {
+// XORs data with the masking key of a WebSocket frame, which both masks and
+// unmasks it. offset is how many bytes of the same payload came before data,
+// so that a payload can be processed piece by piece. Works on 32 bytes at a
+// time with AVX2 when compiled for it (CO_ASYNC_NATIVE), 16 with SSE2 or
+// NEON, and a machine word at a time elsewhere.
+void websocketMask(std::span<char> data, std::array<char, 4> key,
+                   std::size_t offset = 0) noexcept;
+} // namespace co_async
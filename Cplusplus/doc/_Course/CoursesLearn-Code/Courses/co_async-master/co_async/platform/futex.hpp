@@ -43,13 +43,21 @@ inline Expected<> futex_notify_sync(std::atomic<T> *futex,
 #ifndef SYS_futex_wake
     const long SYS_futex_wake = 454;
 #endif
+    // futex_wake(uaddr, mask, nr, flags), unlike io_uring's count-then-mask
     long res = syscall(SYS_futex_wake, reinterpret_cast<uint32_t *>(futex),
-            static_cast<uint64_t>(count), static_cast<uint64_t>(mask),
+            static_cast<uint64_t>(mask),
+            static_cast<int>(std::min(count, kFutexNotifyAll)),
             getFutexFlagsFor<T>());
+    if (res == -1) {
+        res = -errno;
+    }
 #if CO_ASYNC_INVALFIX
     if (res == -EBADF || res == -ENOSYS) {
         res = syscall(SYS_futex, reinterpret_cast<uint32_t *>(futex), FUTEX_WAKE_BITSET_PRIVATE,
                 static_cast<uint32_t>(count), nullptr, nullptr, mask);
+        if (res == -1) {
+            res = -errno;
+        }
     }
 #endif
     return expectError(static_cast<int>(res));
@@ -62,13 +70,20 @@ inline Expected<> futex_wait_sync(std::atomic<T> *futex,
 #ifndef SYS_futex_wait
     const long SYS_futex_wait = 455;
 #endif
+    // no timeout: the kernel reads both trailing arguments regardless
     long res = syscall(SYS_futex_wait, reinterpret_cast<uint32_t *>(futex),
             futexValueExtend(val), static_cast<uint64_t>(mask),
-            getFutexFlagsFor<T>());
+            getFutexFlagsFor<T>(), nullptr, CLOCK_MONOTONIC);
+    if (res == -1) {
+        res = -errno;
+    }
 #if CO_ASYNC_INVALFIX
     if (res == -EBADF || res == -ENOSYS) {
         res = syscall(SYS_futex, reinterpret_cast<uint32_t *>(futex), FUTEX_WAIT_BITSET_PRIVATE,
                 static_cast<uint32_t>(futexValueExtend(val)), nullptr, nullptr, mask);
+        if (res == -1) {
+            res = -errno;
+        }
     }
 #endif
     return expectError(static_cast<int>(res));
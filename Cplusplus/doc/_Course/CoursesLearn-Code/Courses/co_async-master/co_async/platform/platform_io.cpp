@@ -205,7 +205,46 @@ std::size_t PlatformIOContext::addFiles(std::span<int const> files) {
     return ret;
 }
 
+ProvidedBufferRing::ProvidedBufferRing(struct io_uring *ring,
+                                       unsigned short group, std::size_t count,
+                                       std::size_t size)
+    : mRing(ring),
+      mBufferSize(size),
+      mGroup(group) {
+    // the kernel wants a power of two, and ids are 16 bits wide
+    mCount = static_cast<unsigned int>(
+        std::bit_ceil(std::clamp<std::size_t>(count, 1, 32768)));
+    int res = 0;
+    mBufRing = io_uring_setup_buf_ring(mRing, mCount, mGroup, 0, &res);
+    if (!mBufRing) [[unlikely]] {
+        throw std::system_error(-res, std::system_category());
+    }
+    mData = std::make_unique_for_overwrite<char[]>(mCount * mBufferSize);
+    for (unsigned int id = 0; id < mCount; ++id) {
+        io_uring_buf_ring_add(mBufRing,
+                              mData.get() + static_cast<std::size_t>(id) *
+                                                mBufferSize,
+                              static_cast<unsigned int>(mBufferSize),
+                              static_cast<unsigned short>(id),
+                              io_uring_buf_ring_mask(mCount),
+                              static_cast<int>(id));
+    }
+    io_uring_buf_ring_advance(mBufRing, static_cast<int>(mCount));
+}
+
+ProvidedBufferRing::~ProvidedBufferRing() {
+    io_uring_free_buf_ring(mRing, mBufRing, mCount, mGroup);
+}
+
+void PlatformIOContext::setupProvidedBuffers(std::size_t count,
+                                             std::size_t size) {
+    mProvidedBuffers.reset();
+    mProvidedBuffers =
+        std::make_unique<ProvidedBufferRing>(&mRing, 0, count, size);
+}
+
 PlatformIOContext::~PlatformIOContext() {
+    mProvidedBuffers.reset();
     if (mRing.ring_fd != -1) {
         io_uring_queue_exit(&mRing);
     }
@@ -232,22 +271,65 @@ bool PlatformIOContext::waitEventsFor(
         }
         throw std::system_error(-res, std::system_category());
     }
-    unsigned head, numGot = 0;
+    unsigned head, numGot = 0, numDone = 0;
     std::vector<std::coroutine_handle<>> tasks;
     io_uring_for_each_cqe(&mRing, head, cqe) {
 #if CO_ASYNC_INVALFIX
         if (cqe->user_data == LIBURING_UDATA_TIMEOUT) [[unlikely]] {
             ++numGot;
+            ++numDone;
             continue;
         }
 #endif
+        ++numGot;
+        if (cqe->user_data & UringMultishotOp::kTag) {
+            auto *state = reinterpret_cast<UringMultishotOp::State *>(
+                cqe->user_data &
+                ~(UringMultishotOp::kTag | UringMultishotOp::kTimerTag));
+            if (cqe->user_data & UringMultishotOp::kTimerTag) {
+                --state->mTimers;
+                ++numDone;
+                if (state->mOrphaned) [[unlikely]] {
+                    if (!state->mArmed && !state->mTimers) {
+                        delete state;
+                    }
+                    continue;
+                }
+                if (cqe->res == -ETIME && state->mWaiting &&
+                    std::chrono::steady_clock::now() >= state->mDeadline) {
+                    state->mTimedOut = true;
+                    tasks.push_back(std::exchange(state->mWaiting, nullptr));
+                }
+                continue;
+            }
+            UringMultishotOp::Result result{cqe->res, cqe->flags};
+            bool last = !(cqe->flags & IORING_CQE_F_MORE);
+            if (last) {
+                state->mArmed = false;
+                ++numDone;
+            }
+            if (state->mOrphaned) [[unlikely]] {
+                if (state->mDiscard) {
+                    state->mDiscard(state->mContext, result);
+                }
+                if (last && !state->mTimers) {
+                    delete state;
+                }
+                continue;
+            }
+            state->mResults.push_back(result);
+            if (state->mWaiting) {
+                tasks.push_back(std::exchange(state->mWaiting, nullptr));
+            }
+            continue;
+        }
         auto *op = reinterpret_cast<UringOp *>(cqe->user_data);
         op->mRes = cqe->res;
         tasks.push_back(op->mPrevious);
-        ++numGot;
+        ++numDone;
     }
     io_uring_cq_advance(&mRing, numGot);
-    mNumSqesPending -= static_cast<std::size_t>(numGot);
+    mNumSqesPending -= static_cast<std::size_t>(numDone);
     for (auto const &task: tasks) {
 #if CO_ASYNC_DEBUG
         if (!task) [[likely]] {
@@ -30,6 +30,105 @@ timePointToKernelTimespec(std::chrono::time_point<Clk, Dur> tp) {
     return durationToKernelTimespec(tp.time_since_epoch());
 }
 
+// Receive buffers handed out by the kernel itself (IORING_REGISTER_PBUF_RING):
+// a recv with IOSQE_BUFFER_SELECT takes one only once data has arrived, so
+// idle connections hold no receive memory. One ring per PlatformIOContext.
+struct ProvidedBufferRing {
+    [[gnu::cold]] ProvidedBufferRing(struct io_uring *ring,
+                                     unsigned short group, std::size_t count,
+                                     std::size_t size);
+    ProvidedBufferRing(ProvidedBufferRing &&) = delete;
+    [[gnu::cold]] ~ProvidedBufferRing();
+
+    unsigned short group() const noexcept {
+        return mGroup;
+    }
+
+    std::size_t bufferSize() const noexcept {
+        return mBufferSize;
+    }
+
+    char *bufferData(unsigned short id) const noexcept {
+        return mData.get() + static_cast<std::size_t>(id) * mBufferSize;
+    }
+
+    // gives buffer id back to the kernel
+    void recycle(unsigned short id) noexcept {
+        io_uring_buf_ring_add(mBufRing, bufferData(id),
+                              static_cast<unsigned int>(mBufferSize), id,
+                              io_uring_buf_ring_mask(mCount), 0);
+        io_uring_buf_ring_advance(mBufRing, 1);
+    }
+
+private:
+    struct io_uring *mRing;
+    struct io_uring_buf_ring *mBufRing;
+    std::unique_ptr<char[]> mData;
+    std::size_t mBufferSize;
+    unsigned int mCount;
+    unsigned short mGroup;
+};
+
+// a buffer the kernel picked from a ProvidedBufferRing, holding size() bytes
+// of received data; recycled to the ring on destruction
+struct [[nodiscard]] ProvidedBuffer {
+    ProvidedBuffer() noexcept : mRing(nullptr) {}
+
+    explicit ProvidedBuffer(ProvidedBufferRing *ring, unsigned short id,
+                            std::size_t size) noexcept
+        : mRing(ring),
+          mId(id),
+          mSize(size) {}
+
+    ProvidedBuffer(ProvidedBuffer &&that) noexcept
+        : mRing(std::exchange(that.mRing, nullptr)),
+          mId(that.mId),
+          mOffset(that.mOffset),
+          mSize(that.mSize) {}
+
+    ProvidedBuffer &operator=(ProvidedBuffer &&that) noexcept {
+        std::swap(mRing, that.mRing);
+        std::swap(mId, that.mId);
+        std::swap(mOffset, that.mOffset);
+        std::swap(mSize, that.mSize);
+        return *this;
+    }
+
+    ~ProvidedBuffer() {
+        if (mRing) {
+            mRing->recycle(mId);
+        }
+    }
+
+    explicit operator bool() const noexcept {
+        return mRing;
+    }
+
+    char *data() const noexcept {
+        return mRing->bufferData(mId) + mOffset;
+    }
+
+    std::size_t size() const noexcept {
+        return mSize;
+    }
+
+    // the whole buffer stays ours until recycled, not just the received part
+    std::size_t capacity() const noexcept {
+        return mRing->bufferSize() - mOffset;
+    }
+
+    void remove_prefix(std::size_t n) noexcept {
+        mOffset += n;
+        mSize -= n;
+    }
+
+private:
+    ProvidedBufferRing *mRing;
+    unsigned short mId = 0;
+    std::size_t mOffset = 0;
+    std::size_t mSize = 0;
+};
+
 struct PlatformIOContext {
     [[gnu::cold]] static void schedSetThreadAffinity(size_t cpu);
 
@@ -73,6 +172,12 @@ struct PlatformIOContext {
     std::size_t addBuffers(std::span<std::span<char> const> bufs);
     void reserveFiles(std::size_t nfiles);
     std::size_t addFiles(std::span<int const> files);
+    void setupProvidedBuffers(std::size_t count, std::size_t size);
+
+    // nullptr unless setupProvidedBuffers succeeded
+    ProvidedBufferRing *providedBuffers() const noexcept {
+        return mProvidedBuffers.get();
+    }
 
     std::size_t hasPendingEvents() const noexcept {
         return mNumSqesPending != 0;
@@ -87,11 +192,15 @@ private:
     std::unique_ptr<int[]> mFiles;
     unsigned int mNumFiles = 0;
     unsigned int mCapFiles = 0;
+    std::unique_ptr<ProvidedBufferRing> mProvidedBuffers;
 };
 
 struct [[nodiscard]] UringOp {
-    UringOp() {
-        mSqe = PlatformIOContext::instance->getSqe();
+    UringOp() : UringOp(*PlatformIOContext::instance) {}
+
+    // submits to context rather than to the calling thread's reactor
+    explicit UringOp(PlatformIOContext &context) {
+        mSqe = context.getSqe();
         io_uring_sqe_set_data(mSqe, this);
     }
 
@@ -339,6 +448,11 @@ public:
         return std::move(*this);
     }
 
+    UringOp &&prep_cancel64(std::uint64_t userData, int flags) && {
+        io_uring_prep_cancel64(mSqe, userData, flags);
+        return std::move(*this);
+    }
+
     UringOp &&prep_cancel_fd(int fd, unsigned int flags) && {
         io_uring_prep_cancel_fd(mSqe, fd, flags);
         return std::move(*this);
@@ -422,4 +536,195 @@ public:
     // }
 };
 
+// One SQE that keeps posting CQEs (IORING_CQE_F_MORE) until it fails or is
+// cancelled, e.g. multishot accept or multishot recv. Results that arrive
+// while nobody is awaiting are queued in arrival order.
+struct UringMultishotOp {
+    struct Result {
+        int res;
+        unsigned int flags;
+    };
+
+    // heap allocated so that a CQE arriving after the owner is gone still has
+    // somewhere to land; freed by the reactor on the final CQE in that case
+    struct State {
+        std::deque<Result> mResults;
+        std::coroutine_handle<> mWaiting;
+        // timeout SQEs of next(timeout) are tagged with kTimerTag; cancelled
+        // ones may still be in flight, so they are counted and a CQE only
+        // counts as a timeout once mDeadline has passed
+        struct __kernel_timespec mTimeout;
+        std::chrono::steady_clock::time_point mDeadline;
+        unsigned int mTimers = 0;
+        bool mArmed = false;
+        bool mTimedOut = false;
+        bool mOrphaned = false;
+        // the reactor the op was created on; SQEs are taken from it
+        PlatformIOContext *mContext = nullptr;
+        // called on every result dropped because the owner is gone, so that
+        // e.g. accepted fds are not leaked
+        void (*mDiscard)(PlatformIOContext *, Result) = nullptr;
+    };
+
+    // user_data of multishot SQEs has this bit set, UringOp is never odd
+    static constexpr std::uint64_t kTag = 1;
+    // set along with kTag on the timeout SQE that bounds a next() wait
+    static constexpr std::uint64_t kTimerTag = 2;
+
+    explicit UringMultishotOp(
+        PlatformIOContext *context = PlatformIOContext::instance,
+        void (*discard)(PlatformIOContext *, Result) = nullptr)
+        : mState(std::make_unique<State>()) {
+        mState->mContext = context;
+        mState->mDiscard = discard;
+    }
+
+    UringMultishotOp(UringMultishotOp &&) = delete;
+
+    ~UringMultishotOp() {
+        if (mState->mDiscard) {
+            for (auto const &result: mState->mResults) {
+                mState->mDiscard(mState->mContext, result);
+            }
+        }
+        mState->mResults.clear();
+        if (mState->mArmed || mState->mTimers) {
+            mState->mOrphaned = true;
+            mState->mWaiting = nullptr;
+            bool armed = mState->mArmed;
+            bool timers = mState->mTimers != 0;
+            auto *context = mState->mContext;
+            auto userData = userDataOf(mState.release());
+            if (armed) {
+                UringOp(*context).prep_cancel64(userData, 0).startDetach();
+            }
+            if (timers) {
+                UringOp(*context)
+                    .prep_cancel64(userData | kTimerTag,
+                                   IORING_ASYNC_CANCEL_ALL)
+                    .startDetach();
+            }
+        }
+    }
+
+    // returns a fresh SQE for the caller to prep; only when !armed()
+    struct io_uring_sqe *arm() {
+        struct io_uring_sqe *sqe = mState->mContext->getSqe();
+        io_uring_sqe_set_data64(sqe, userDataOf(mState.get()));
+        mState->mArmed = true;
+        return sqe;
+    }
+
+    // the kernel may still post results
+    bool armed() const noexcept {
+        return mState->mArmed;
+    }
+
+    bool hasResult() const noexcept {
+        return !mState->mResults.empty();
+    }
+
+    struct Awaiter {
+        bool await_ready() const noexcept {
+            return !mState->mResults.empty() || !mState->mArmed;
+        }
+
+        void await_suspend(std::coroutine_handle<> coroutine) noexcept {
+            mState->mWaiting = coroutine;
+        }
+
+        // {-ECANCELED, 0} if not armed and nothing left
+        Result await_resume() const noexcept {
+            if (mState->mResults.empty()) [[unlikely]] {
+                return {-ECANCELED, 0};
+            }
+            Result result = mState->mResults.front();
+            mState->mResults.pop_front();
+            return result;
+        }
+
+        State *mState;
+    };
+
+    Awaiter operator co_await() noexcept {
+        return Awaiter{mState.get()};
+    }
+
+    // co_await *this that gives up with {-ECANCELED, 0} once co_cancel fires,
+    // or with {-ETIME, 0} after timeout, leaving any result that arrives
+    // afterwards queued for the next call
+    Task<Result>
+    next(std::optional<std::chrono::steady_clock::duration> timeout = {}) {
+        struct WaitAwaiter {
+            bool await_ready() const noexcept {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<> coroutine) noexcept {
+                mState->mWaiting = coroutine;
+            }
+
+            void await_resume() const noexcept {}
+
+            State *mState;
+        };
+
+        Awaiter awaiter{mState.get()};
+        if (!awaiter.await_ready()) {
+            auto cancel = co_await co_cancel;
+            if (cancel.is_canceled()) [[unlikely]] {
+                co_return {-ECANCELED, 0};
+            }
+            CancelCallback _(cancel, [state = mState.get()] {
+                if (auto coroutine =
+                        std::exchange(state->mWaiting, nullptr)) {
+                    co_spawn(coroutine);
+                }
+            });
+            if (timeout) {
+                armTimer(*timeout);
+            }
+            co_await WaitAwaiter{mState.get()};
+            if (timeout && !mState->mTimedOut) {
+                // woken by a result or co_cancel, the timer is not needed
+                UringOp(*mState->mContext)
+                    .prep_cancel64(userDataOf(mState.get()) | kTimerTag, 0)
+                    .startDetach();
+            }
+            if (std::exchange(mState->mTimedOut, false)) [[unlikely]] {
+                co_return {-ETIME, 0};
+            }
+            if (cancel.is_canceled()) [[unlikely]] {
+                co_return {-ECANCELED, 0};
+            }
+        }
+        co_return awaiter.await_resume();
+    }
+
+    // the final CQE is still delivered and has to be awaited before the
+    // kernel stops touching the op
+    Task<> cancel() {
+        if (mState->mArmed) {
+            co_await UringOp(*mState->mContext)
+                .prep_cancel64(userDataOf(mState.get()), 0);
+        }
+    }
+
+private:
+    std::unique_ptr<State> mState;
+
+    static std::uint64_t userDataOf(State *state) noexcept {
+        return reinterpret_cast<std::uintptr_t>(state) | kTag;
+    }
+
+    void armTimer(std::chrono::steady_clock::duration timeout) {
+        struct io_uring_sqe *sqe = mState->mContext->getSqe();
+        mState->mDeadline = std::chrono::steady_clock::now() + timeout;
+        mState->mTimeout = durationToKernelTimespec(timeout);
+        io_uring_prep_timeout(sqe, &mState->mTimeout, 0, 0);
+        io_uring_sqe_set_data64(sqe, userDataOf(mState.get()) | kTimerTag);
+        ++mState->mTimers;
+    }
+};
+
 } // namespace co_async
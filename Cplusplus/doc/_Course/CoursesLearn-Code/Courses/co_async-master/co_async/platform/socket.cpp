@@ -194,7 +194,7 @@ void SocketAddress::trySetPort(int port) {
 }
 
 String SocketAddress::toString() const {
-    return host() + ':' + to_string(port());
+    return String(host()) + ':' + to_string(port());
 }
 
 // void SocketAddress::initFromHostPort(struct in_addr const &host, int port) {
@@ -369,6 +369,74 @@ Task<Expected<SocketHandle>> listener_accept(SocketListener &listener,
     co_return sock;
 }
 
+MultishotAcceptor::MultishotAcceptor(SocketListener &listener)
+    : mListener(listener),
+      mOp(PlatformIOContext::instance,
+          [](PlatformIOContext *, UringMultishotOp::Result result) {
+          if (result.res >= 0) {
+              close(result.res);
+          }
+      }) {}
+
+Task<Expected<SocketHandle>> MultishotAcceptor::accept() {
+    if (!mSupported) [[unlikely]] {
+        co_return co_await listener_accept(mListener);
+    }
+    if (!mOp.armed() && !mOp.hasResult()) {
+        io_uring_prep_multishot_accept(mOp.arm(), mListener.fileNo(), nullptr,
+                                       nullptr, 0);
+    }
+    auto [res, flags] = co_await mOp;
+    if (res == -EINVAL && !(flags & IORING_CQE_F_MORE)) [[unlikely]] {
+        mSupported = false;
+        co_return co_await listener_accept(mListener);
+    }
+    int fd = co_await expectError(res);
+    SocketHandle sock(fd);
+    co_return sock;
+}
+
+MultishotReceiver::MultishotReceiver(SocketHandle &sock,
+                                     PlatformIOContext *context)
+    : mSock(sock),
+      mRing(context ? context->providedBuffers() : nullptr),
+      mOp(context,
+          [](PlatformIOContext *context, UringMultishotOp::Result result) {
+          if (result.flags & IORING_CQE_F_BUFFER) {
+              context->providedBuffers()->recycle(
+                  static_cast<unsigned short>(result.flags >>
+                                              IORING_CQE_BUFFER_SHIFT));
+          }
+      }) {}
+
+Task<Expected<ProvidedBuffer>>
+MultishotReceiver::recv(std::chrono::steady_clock::duration timeout) {
+    if (!mRing || !mSupported) [[unlikely]] {
+        co_return std::errc::not_supported;
+    }
+    if (!pending()) {
+        struct io_uring_sqe *sqe = mOp.arm();
+        io_uring_prep_recv_multishot(sqe, mSock.fileNo(), nullptr, 0, 0);
+        sqe->flags |= IOSQE_BUFFER_SELECT;
+        sqe->buf_group = mRing->group();
+    }
+    auto [res, flags] = co_await mOp.next(timeout);
+    if (res == -EINVAL && !(flags & IORING_CQE_F_MORE)) [[unlikely]] {
+        mSupported = false;
+        co_return std::errc::not_supported;
+    }
+    if (res == -ETIME) [[unlikely]] {
+        co_return std::errc::stream_timeout;
+    }
+    co_await expectError(res);
+    if (!(flags & IORING_CQE_F_BUFFER)) {
+        co_return ProvidedBuffer();
+    }
+    co_return ProvidedBuffer(
+        mRing, static_cast<unsigned short>(flags >> IORING_CQE_BUFFER_SHIFT),
+        static_cast<std::size_t>(res));
+}
+
 Task<Expected<std::size_t>> socket_write(SocketHandle &sock,
                                          std::span<char const> buf) {
     co_return static_cast<std::size_t>(co_await expectError(
@@ -495,6 +563,140 @@ socket_read(SocketHandle &sock, std::span<char> buf,
         );
 }
 
+Task<Expected<std::size_t>>
+socket_writev(SocketHandle &sock, std::span<struct iovec const> bufs,
+              std::chrono::steady_clock::duration timeout, CancelToken cancel) {
+    struct msghdr msg = {};
+    msg.msg_iov = const_cast<struct iovec *>(bufs.data());
+    msg.msg_iovlen = bufs.size();
+    auto ts = durationToKernelTimespec(timeout);
+    co_return static_cast<std::size_t>(co_await expectError(
+        co_await UringOp::link_ops(
+            UringOp().prep_sendmsg(sock.fileNo(), &msg, 0),
+            UringOp().prep_link_timeout(&ts, IORING_TIMEOUT_BOOTTIME))
+            .cancelGuard(cancel))
+#if CO_ASYNC_INVALFIX
+        .or_else(std::errc::invalid_argument, [&] { return expectError(static_cast<int>(sendmsg(sock.fileNo(), &msg, 0))); })
+#endif
+    );
+}
+
+namespace {
+// Pipes for socket_sendfile, shared by everything on one reactor thread. A
+// pipe is leased for a single call, so a reactor holds as many as it has
+// sendfiles in flight, not one per keep-alive connection; pipe pages count
+// against pipe-user-pages-soft for as long as the pipe exists.
+struct SplicePipePool {
+    struct Pipe {
+        FileHandle reader;
+        FileHandle writer;
+        std::size_t capacity = 0;
+    };
+
+    // one splice moves at most a pipe full; pipes are grown for large bodies
+    // only, up to kMaxSize, and shrunk back before going idle
+    static constexpr std::size_t kDefaultSize = 64 * 1024;
+    static constexpr std::size_t kMaxSize = 1 << 20;
+    static constexpr std::size_t kMaxIdle = 4;
+
+    Expected<Pipe> acquire(std::size_t size) {
+        Pipe pipe;
+        if (!mIdle.empty()) {
+            pipe = std::move(mIdle.back());
+            mIdle.pop_back();
+        } else {
+            int p[2];
+            if (pipe2(p, O_CLOEXEC) < 0) [[unlikely]] {
+                return std::error_code(errno, std::system_category());
+            }
+            pipe.reader = FileHandle(p[0]);
+            pipe.writer = FileHandle(p[1]);
+            // below pipe-user-pages-soft a new pipe may get only 2 pages
+            int res = fcntl(p[1], F_GETPIPE_SZ);
+            pipe.capacity = res > 0 ? static_cast<std::size_t>(res)
+                                    : kDefaultSize;
+        }
+        if (size > pipe.capacity && pipe.capacity < kMaxSize) {
+            // failing that (pipe-max-size, user limits) only costs rounds
+            int res = fcntl(pipe.writer.fileNo(), F_SETPIPE_SZ,
+                            static_cast<int>(
+                                std::min(std::bit_ceil(size), kMaxSize)));
+            if (res > 0) {
+                pipe.capacity = static_cast<std::size_t>(res);
+            }
+        }
+        return pipe;
+    }
+
+    // only for pipes that were drained; others are closed by dropping them
+    void release(Pipe pipe) {
+        if (mIdle.size() >= kMaxIdle) {
+            return;
+        }
+        if (pipe.capacity > kDefaultSize) {
+            int res = fcntl(pipe.writer.fileNo(), F_SETPIPE_SZ,
+                            static_cast<int>(kDefaultSize));
+            if (res < 0) [[unlikely]] {
+                return;
+            }
+            pipe.capacity = static_cast<std::size_t>(res);
+        }
+        mIdle.push_back(std::move(pipe));
+    }
+
+private:
+    std::vector<Pipe> mIdle;
+};
+
+thread_local SplicePipePool splicePipePool;
+} // namespace
+
+Task<Expected<>>
+socket_sendfile(SocketHandle &sock, std::span<char const> head,
+                FileHandle &file, std::uint64_t offset, std::size_t size,
+                std::chrono::steady_clock::duration timeout,
+                CancelToken cancel) {
+    auto ts = durationToKernelTimespec(timeout);
+    while (!head.empty()) {
+        auto n = static_cast<std::size_t>(co_await expectError(
+            co_await UringOp::link_ops(
+                UringOp().prep_send(sock.fileNo(), head,
+                                    size ? MSG_MORE : 0),
+                UringOp().prep_link_timeout(&ts, IORING_TIMEOUT_BOOTTIME))
+                .cancelGuard(cancel)));
+        head = head.subspan(n);
+    }
+    if (!size) {
+        co_return {};
+    }
+    // on error the pipe may hold stale data: it is closed, not returned
+    auto pipe = co_await splicePipePool.acquire(size);
+    while (size) {
+        auto n = static_cast<std::size_t>(co_await expectError(
+            co_await UringOp().prep_splice(
+                file.fileNo(), static_cast<std::int64_t>(offset),
+                pipe.writer.fileNo(), -1, std::min(size, pipe.capacity),
+                SPLICE_F_MOVE)));
+        if (n == 0) [[unlikely]] {
+            // file shrank under us, the promised length cannot be met
+            co_return std::errc::io_error;
+        }
+        offset += n;
+        size -= n;
+        while (n) {
+            n -= static_cast<std::size_t>(co_await expectError(
+                co_await UringOp::link_ops(
+                    UringOp().prep_splice(
+                        pipe.reader.fileNo(), -1, sock.fileNo(), -1, n,
+                        SPLICE_F_MOVE | (size ? SPLICE_F_MORE : 0)),
+                    UringOp().prep_link_timeout(&ts, IORING_TIMEOUT_BOOTTIME))
+                    .cancelGuard(cancel)));
+        }
+    }
+    splicePipePool.release(std::move(pipe));
+    co_return {};
+}
+
 Task<Expected<>> socket_shutdown(SocketHandle &sock, int how) {
     co_return expectError(co_await UringOp().prep_shutdown(sock.fileNo(), how));
 }
@@ -179,6 +179,51 @@ Task<Expected<SocketHandle>> listener_accept(SocketListener &listener,
 Task<Expected<SocketHandle>> listener_accept(SocketListener &listener,
                                              SocketAddress &peerAddr,
                                              CancelToken cancel);
+
+// Accepts through a single multishot accept SQE that stays armed across
+// connections instead of submitting one SQE per connection. Falls back to
+// plain listener_accept on kernels without multishot accept (< 5.19).
+struct MultishotAcceptor {
+    explicit MultishotAcceptor(SocketListener &listener);
+    MultishotAcceptor(MultishotAcceptor &&) = delete;
+
+    Task<Expected<SocketHandle>> accept();
+
+private:
+    SocketListener &mListener;
+    UringMultishotOp mOp;
+    bool mSupported = true;
+};
+
+// Receives through one multishot recv SQE that lands data in buffers from
+// the reactor's ProvidedBufferRing, so nothing is allocated or resubmitted
+// per read and an idle socket holds no buffer. Needs a context created with
+// IOContextOptions::providedBuffers; recv() reports not_supported otherwise,
+// or on kernels without multishot recv (< 6.0). The context is the one the
+// receiver is constructed on, recv() does not look it up again.
+struct MultishotReceiver {
+    explicit MultishotReceiver(
+        SocketHandle &sock,
+        PlatformIOContext *context = PlatformIOContext::instance);
+    MultishotReceiver(MultishotReceiver &&) = delete;
+
+    // empty buffer at EOF; no_buffer_space when the ring ran dry, after
+    // which nothing is in flight and a plain socket_read is safe
+    Task<Expected<ProvidedBuffer>>
+    recv(std::chrono::steady_clock::duration timeout);
+
+    // received data may be queued: plain reads would overtake it
+    bool pending() const noexcept {
+        return mOp.armed() || mOp.hasResult();
+    }
+
+private:
+    SocketHandle &mSock;
+    ProvidedBufferRing *mRing;
+    UringMultishotOp mOp;
+    bool mSupported = true;
+};
+
 Task<Expected<std::size_t>> socket_write(SocketHandle &sock,
                                          std::span<char const> buf);
 Task<Expected<std::size_t>> socket_write_zc(SocketHandle &sock,
@@ -204,5 +249,17 @@ socket_write(SocketHandle &sock, std::span<char const> buf,
 Task<Expected<std::size_t>>
 socket_read(SocketHandle &sock, std::span<char> buf,
             std::chrono::steady_clock::duration timeout, CancelToken cancel);
+Task<Expected<std::size_t>>
+socket_writev(SocketHandle &sock, std::span<struct iovec const> bufs,
+              std::chrono::steady_clock::duration timeout, CancelToken cancel);
+// Sends head, then file bytes [offset, offset + size) moved kernel-to-kernel
+// with splice through a pipe, so the body never enters user space. head goes
+// out with MSG_MORE to share segments with the body. The pipe is leased from
+// a small per-reactor pool for the length of the call only.
+Task<Expected<>>
+socket_sendfile(SocketHandle &sock, std::span<char const> head,
+                FileHandle &file, std::uint64_t offset, std::size_t size,
+                std::chrono::steady_clock::duration timeout,
+                CancelToken cancel);
 Task<Expected<>> socket_shutdown(SocketHandle &sock, int how = SHUT_RDWR);
 } // namespace co_async
@@ -110,4 +110,58 @@ private:
     std::deque<T> mQueue;
     SpinMutex mMutex;
 };
+
+// Unbounded lock-free multi-producer single-consumer queue: producers push
+// onto an atomic stack, the consumer takes the whole stack with one exchange
+// and replays it oldest first
+template <class T>
+struct alignas(hardware_destructive_interference_size) ConcurrentMPSCQueue {
+    void push(T &&value) /* MT-safe */ {
+        auto node = new Node{std::move(value), mHead.load(std::memory_order_relaxed)};
+        while (!mHead.compare_exchange_weak(node->mNext, node,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed))
+            ;
+    }
+
+    [[nodiscard]] bool empty() const noexcept /* MT-safe */ {
+        return mHead.load(std::memory_order_relaxed) == nullptr;
+    }
+
+    // Consumer only; returns the number of values handed to func
+    template <class F>
+    std::size_t drain(F &&func) {
+        Node *node = mHead.exchange(nullptr, std::memory_order_acquire);
+        Node *reversed = nullptr;
+        while (node) {
+            Node *next = node->mNext;
+            node->mNext = reversed;
+            reversed = node;
+            node = next;
+        }
+        std::size_t count = 0;
+        while (reversed) {
+            std::unique_ptr<Node> current(reversed);
+            reversed = current->mNext;
+            func(std::move(current->mValue));
+            ++count;
+        }
+        return count;
+    }
+
+    ConcurrentMPSCQueue() = default;
+    ConcurrentMPSCQueue(ConcurrentMPSCQueue &&) = delete;
+
+    ~ConcurrentMPSCQueue() {
+        drain([](T &&) {});
+    }
+
+private:
+    struct Node {
+        T mValue;
+        Node *mNext;
+    };
+
+    std::atomic<Node *> mHead{nullptr};
+};
 } // namespace co_async
@@ -0,0 +1,245 @@
+#pragma once
+#include <co_async/std.hpp>
+
+namespace co_async {
+// hierarchical hashed timer wheel over integer ticks: level L has 64 slots
+// of 64^L ticks each, and a slot of level L > 0 is re-hashed into the lower
+// levels when the wheel reaches it; insert and erase are O(1), and a
+// bitmap per level finds the next occupied slot without walking empty ones
+template <class Value>
+struct TimerWheel {
+    static constexpr std::size_t kLevelBits = 6;
+    static constexpr std::size_t kSlots = std::size_t(1) << kLevelBits;
+    static constexpr std::size_t kLevels = 6;
+
+protected:
+    struct WheelNode {
+        WheelNode() noexcept
+            : wheelPrev(nullptr),
+              wheelNext(nullptr),
+              wheelOwner(nullptr),
+              wheelExpires(0) {}
+        friend struct TimerWheel;
+
+    private:
+        WheelNode *wheelPrev;
+        WheelNode *wheelNext;
+
+    protected:
+        TimerWheel *wheelOwner;
+
+    private:
+        std::uint64_t wheelExpires;
+    };
+
+public:
+    struct NodeType : WheelNode {
+        NodeType() = default;
+        NodeType(NodeType &&) = delete;
+
+        ~NodeType() noexcept {
+            erase_from_parent();
+        }
+
+    protected:
+        void erase_from_parent() {
+            static_assert(
+                std::is_base_of_v<NodeType, Value>,
+                "Value type must be derived from TimerWheel<Value>::NodeType");
+            if (this->wheelOwner) {
+                this->wheelOwner->doErase(this);
+            }
+        }
+    };
+
+private:
+    // each slot is a circular list around its sentinel
+    WheelNode mSlots[kLevels][kSlots];
+    std::uint64_t mOccupied[kLevels]{};
+    // the next tick to be processed, every tick before it has fired
+    std::uint64_t mCurrent = 0;
+
+    static void link(WheelNode *head, WheelNode *node) noexcept {
+        node->wheelNext = head;
+        node->wheelPrev = head->wheelPrev;
+        head->wheelPrev->wheelNext = node;
+        head->wheelPrev = node;
+    }
+
+    static bool isEmpty(WheelNode const *head) noexcept {
+        return head->wheelNext == head;
+    }
+
+    void doInsert(WheelNode *node) noexcept {
+        auto expires = std::max(node->wheelExpires, mCurrent);
+        auto delta = expires - mCurrent;
+        std::size_t level = 0;
+        while (level + 1 < kLevels && delta >= kSlots << (level * kLevelBits))
+        {
+            ++level;
+        }
+        if (level + 1 == kLevels &&
+            delta >= kSlots << (level * kLevelBits)) [[unlikely]] {
+            // too far out: park it in the farthest slot, it is re-hashed
+            // with its true expiry when the wheel gets there
+            expires = mCurrent + (kSlots << (level * kLevelBits)) - 1;
+        }
+        auto slot = (expires >> (level * kLevelBits)) & (kSlots - 1);
+        link(&mSlots[level][slot], node);
+        mOccupied[level] |= std::uint64_t(1) << slot;
+        node->wheelOwner = this;
+    }
+
+    void doErase(WheelNode *node) noexcept {
+        auto prev = node->wheelPrev;
+        prev->wheelNext = node->wheelNext;
+        node->wheelNext->wheelPrev = prev;
+        node->wheelPrev = nullptr;
+        node->wheelNext = nullptr;
+        node->wheelOwner = nullptr;
+        // the slot emptied if only its sentinel is left, which is the case
+        // when the neighbour is a sentinel of this wheel
+        auto index = reinterpret_cast<std::uintptr_t>(prev) -
+                     reinterpret_cast<std::uintptr_t>(&mSlots[0][0]);
+        if (prev == prev->wheelNext && index < sizeof(mSlots)) {
+            index /= sizeof(WheelNode);
+            mOccupied[index / kSlots] &=
+                ~(std::uint64_t(1) << (index % kSlots));
+        }
+    }
+
+    // moves every node of a slot onto the list around head
+    void doTake(std::size_t level, std::size_t slot, WheelNode *head) noexcept {
+        auto &from = mSlots[level][slot];
+        mOccupied[level] &= ~(std::uint64_t(1) << slot);
+        if (isEmpty(&from)) {
+            return;
+        }
+        head->wheelNext = from.wheelNext;
+        head->wheelPrev = from.wheelPrev;
+        head->wheelNext->wheelPrev = head;
+        head->wheelPrev->wheelNext = head;
+        from.wheelNext = from.wheelPrev = &from;
+    }
+
+public:
+    TimerWheel() noexcept {
+        for (auto &level: mSlots) {
+            for (auto &head: level) {
+                head.wheelNext = head.wheelPrev = &head;
+            }
+        }
+    }
+
+    TimerWheel(TimerWheel &&) = delete;
+
+    ~TimerWheel() noexcept {
+        clear();
+    }
+
+    // value fires once advance() reaches tick expires; ticks in the past
+    // fire on the next tick processed
+    void insert(Value &value, std::uint64_t expires) noexcept {
+        WheelNode *node = &static_cast<WheelNode &>(value);
+        node->wheelExpires = expires;
+        doInsert(node);
+    }
+
+    void erase(Value &value) noexcept {
+        doErase(&static_cast<WheelNode &>(value));
+    }
+
+    bool empty() const noexcept {
+        for (auto occupied: mOccupied) {
+            if (occupied) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::uint64_t current() const noexcept {
+        return mCurrent;
+    }
+
+    // the first tick at which advance() has work to do: firing a slot of
+    // level 0 or re-hashing one of a higher level
+    std::optional<std::uint64_t> nextTick() const noexcept {
+        std::optional<std::uint64_t> next;
+        for (std::size_t level = 0; level < kLevels; ++level) {
+            if (!mOccupied[level]) {
+                continue;
+            }
+            auto shift = level * kLevelBits;
+            // first slot boundary of this level at or after mCurrent
+            auto unit = (mCurrent + (std::uint64_t(1) << shift) - 1) >> shift;
+            auto rotation = unit & (kSlots - 1);
+            auto occupied = std::rotr(mOccupied[level], int(rotation));
+            auto tick = (unit + std::uint64_t(std::countr_zero(occupied)))
+                        << shift;
+            if (!next || tick < *next) {
+                next = tick;
+            }
+        }
+        return next;
+    }
+
+    // processes every tick up to and including now, calling fire(value)
+    // for each timer due; fire may insert and erase timers, and timers it
+    // inserts for now or earlier fire on the next call
+    template <class Fire>
+    void advance(std::uint64_t now, Fire &&fire) {
+        while (mCurrent <= now) {
+            auto next = nextTick();
+            if (!next || *next > now) {
+                mCurrent = now + 1;
+                return;
+            }
+            auto tick = *next;
+            mCurrent = tick;
+            for (std::size_t level = 1; level < kLevels; ++level) {
+                auto shift = level * kLevelBits;
+                if (tick & ((std::uint64_t(1) << shift) - 1)) {
+                    break;
+                }
+                WheelNode pending;
+                pending.wheelNext = pending.wheelPrev = &pending;
+                doTake(level, (tick >> shift) & (kSlots - 1), &pending);
+                while (!isEmpty(&pending)) {
+                    auto node = pending.wheelNext;
+                    pending.wheelNext = node->wheelNext;
+                    node->wheelNext->wheelPrev = &pending;
+                    doInsert(node);
+                }
+            }
+            WheelNode due;
+            due.wheelNext = due.wheelPrev = &due;
+            doTake(0, tick & (kSlots - 1), &due);
+            mCurrent = tick + 1;
+            // fire may erase nodes still waiting here, so pop one at a time
+            while (!isEmpty(&due)) {
+                auto node = due.wheelNext;
+                doErase(node);
+                fire(static_cast<Value &>(*node));
+            }
+        }
+    }
+
+    void clear() noexcept {
+        for (auto &level: mSlots) {
+            for (auto &head: level) {
+                for (auto node = head.wheelNext; node != &head;) {
+                    auto next = node->wheelNext;
+                    node->wheelPrev = node->wheelNext = nullptr;
+                    node->wheelOwner = nullptr;
+                    node = next;
+                }
+                head.wheelNext = head.wheelPrev = &head;
+            }
+        }
+        for (auto &occupied: mOccupied) {
+            occupied = 0;
+        }
+    }
+};
+} // namespace co_async
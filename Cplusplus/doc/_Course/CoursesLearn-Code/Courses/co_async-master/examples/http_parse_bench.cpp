@@ -0,0 +1,99 @@
+#include <co_async/co_async.hpp>
+#include <co_async/std.hpp>
+
+// request head parsing microbenchmark: parseHTTPRequestHead against the
+// line-by-line parsing HTTPProtocolVersion11 used before it (every line
+// copied into a String, then split at ':')
+//
+// usage: http_parse_bench [iterations]
+
+using namespace co_async;
+using namespace std::literals;
+
+static constexpr std::string_view request =
+    "GET /api/v1/users/12345/profile?fields=name,email HTTP/1.1\r\n"
+    "Host: www.example.com\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 "
+    "Firefox/128.0\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Referer: https://www.example.com/dashboard\r\n"
+    "Cookie: session=0123456789abcdef0123456789abcdef; theme=dark\r\n"
+    "Connection: keep-alive\r\n"
+    "Cache-Control: max-age=0\r\n"
+    "\r\n"sv;
+
+static std::size_t lineByLine(std::string_view buf, HTTPHeaders &headers) {
+    auto take = [&] {
+        auto eol = buf.find("\r\n"sv);
+        String line(buf.substr(0, eol));
+        buf.remove_prefix(eol + 2);
+        return line;
+    };
+    auto start = take();
+    auto method = start.substr(0, start.find(' '));
+    std::size_t n = method.size();
+    while (true) {
+        auto line = take();
+        if (line.empty()) {
+            break;
+        }
+        auto pos = line.find(':');
+        auto key = line.substr(0, pos);
+        for (auto &c: key) {
+            if (c >= 'A' && c <= 'Z') {
+                c += 'a' - 'A';
+            }
+        }
+        n += line.size() - pos - 2;
+        headers.insert_or_assign(std::move(key), line.substr(pos + 2));
+    }
+    return n;
+}
+
+static std::size_t inPlace(std::string_view buf, HTTPHead &head) {
+    if (!parseHTTPRequestHead(buf, head).value_or(0)) {
+        return 0;
+    }
+    std::size_t n = head.method.size();
+    for (auto const &field: head.headers()) {
+        n += field.value.size();
+    }
+    return n;
+}
+
+int main(int argc, char **argv) {
+    std::size_t iterations = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+    std::size_t expect = 0, checksum = 0;
+    {
+        HTTPHeaders headers;
+        expect = lineByLine(request, headers);
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        HTTPHeaders headers;
+        checksum += lineByLine(request, headers);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    HTTPHead head;
+    for (std::size_t i = 0; i < iterations; ++i) {
+        checksum -= inPlace(request, head);
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    auto perRequest = [&](auto dt) {
+        return static_cast<double>(dt / 1ns) / static_cast<double>(iterations);
+    };
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << request.size() << " byte head, " << head.numFields
+              << " fields, " << iterations << " iterations"
+              << (checksum == 0 && expect != 0 ? "" : " (MISMATCH)") << '\n';
+    std::cout << "line by line " << std::setw(8) << perRequest(t1 - t0)
+              << " ns/request\n";
+    std::cout << "in place     " << std::setw(8) << perRequest(t2 - t1)
+              << " ns/request\n";
+    return checksum == 0 && expect != 0 ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+#include <co_async/co_async.hpp>
+#include <co_async/std.hpp>
+
+// routing microbenchmark: HTTPRouter against the lookup HTTPServer used
+// before it (an ordered map for exact routes, then a linear scan over prefix
+// routes sorted longest first, each with a vector of method names)
+//
+// usage: http_route_bench [routes] [lookups]
+
+using namespace co_async;
+using namespace std::literals;
+
+struct LinearRouter {
+    struct Route {
+        std::uint32_t id;
+        std::vector<String> methods;
+    };
+
+    std::map<String, Route, std::less<>> exact;
+    std::vector<std::pair<String, Route>> prefixes;
+
+    std::optional<std::uint32_t> match(std::string_view method,
+                                       std::string_view path) const {
+        auto check = [&](Route const &route) -> std::optional<std::uint32_t> {
+            if (std::find(route.methods.begin(), route.methods.end(),
+                          method) == route.methods.end()) {
+                return std::nullopt;
+            }
+            return route.id;
+        };
+        if (auto it = exact.find(path); it != exact.end()) {
+            return check(it->second);
+        }
+        for (auto const &[prefix, route]: prefixes) {
+            if (path.starts_with(prefix)) {
+                return check(route);
+            }
+        }
+        return std::nullopt;
+    }
+};
+
+int main(int argc, char **argv) {
+    std::size_t numRoutes = argc > 1 ? std::stoul(argv[1]) : 400;
+    std::size_t numLookups = argc > 2 ? std::stoul(argv[2]) : 2000000;
+
+    static constexpr std::string_view resources[] = {
+        "users", "orders", "items", "accounts", "sessions",
+        "invoices", "reports", "teams", "projects", "files",
+    };
+    HTTPRouter router;
+    LinearRouter linear;
+    std::vector<String> paths;
+    std::vector<std::uint32_t> exactMethods, prefixMethods;
+    std::uint32_t exactIds = 0, prefixIds = 0;
+    for (std::size_t i = 0; paths.size() < numRoutes; ++i) {
+        auto resource = resources[i % std::size(resources)];
+        auto version = "/api/v" + to_string(i / std::size(resources)) + "/";
+        auto base = version + String(resource);
+        if (i % 8 == 7) {
+            // static subtrees served by a prefix handler
+            auto prefix = "/static" + base + "/";
+            router.insertPrefix(prefix, prefixIds);
+            prefixMethods.push_back(router.methodMask("GET HEAD"));
+            linear.prefixes.push_back(
+                {prefix, {prefixIds, {"GET"_s, "HEAD"_s}}});
+            ++prefixIds;
+            paths.push_back(prefix + "css/site.css");
+            continue;
+        }
+        router.insert(base, exactIds);
+        exactMethods.push_back(router.methodMask("GET POST"));
+        linear.exact.insert({base, {exactIds, {"GET"_s, "POST"_s}}});
+        ++exactIds;
+        paths.push_back(base);
+        router.insert(base + "/stats", exactIds);
+        exactMethods.push_back(router.methodMask("GET"));
+        linear.exact.insert({base + "/stats", {exactIds, {"GET"_s}}});
+        ++exactIds;
+        paths.push_back(base + "/stats");
+    }
+    std::sort(linear.prefixes.begin(), linear.prefixes.end(),
+              [](auto const &a, auto const &b) {
+                  return a.first.size() > b.first.size();
+              });
+
+    std::mt19937 rng(42);
+    std::vector<std::uint32_t> order(numLookups);
+    for (auto &i: order) {
+        i = static_cast<std::uint32_t>(rng() % paths.size());
+    }
+
+    std::size_t checksum = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (auto i: order) {
+        if (auto id = linear.match("GET"sv, paths[i])) {
+            checksum += *id;
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    HTTPRouteParams params;
+    for (auto i: order) {
+        auto method = router.methodBit("GET"sv);
+        if (auto id = router.match(paths[i], params)) {
+            if (exactMethods[*id] & method) {
+                checksum -= *id;
+            }
+        } else if (auto prefix = router.matchPrefix(paths[i])) {
+            if (prefixMethods[prefix->id] & method) {
+                checksum -= prefix->id;
+            }
+        }
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    // the same lookups against parameterised routes
+    HTTPRouter paramRouter;
+    for (std::size_t i = 0; i < numRoutes; ++i) {
+        auto resource = resources[i % std::size(resources)];
+        paramRouter.insert("/api/v" + to_string(i / std::size(resources)) +
+                               "/" + String(resource) + "/{id}/{field}",
+                           static_cast<std::uint32_t>(i));
+    }
+    std::vector<String> paramPaths;
+    for (std::size_t i = 0; i < numRoutes; ++i) {
+        paramPaths.push_back("/api/v" + to_string(i / std::size(resources)) +
+                             "/" + String(resources[i % std::size(resources)]) +
+                             "/" + to_string(rng() % 100000) + "/name");
+    }
+    std::size_t captured = 0;
+    auto t3 = std::chrono::steady_clock::now();
+    for (auto i: order) {
+        if (paramRouter.match(paramPaths[i % paramPaths.size()], params)) {
+            captured += params.get("id"sv).size();
+        }
+    }
+    auto t4 = std::chrono::steady_clock::now();
+
+    auto perLookup = [&](auto dt) {
+        return static_cast<double>(dt / 1ns) / static_cast<double>(numLookups);
+    };
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "routes " << paths.size() << ", lookups " << numLookups
+              << (checksum == 0 ? "" : " (MISMATCH)") << '\n';
+    std::cout << "linear  " << std::setw(8) << perLookup(t1 - t0)
+              << " ns/lookup\n";
+    std::cout << "radix   " << std::setw(8) << perLookup(t2 - t1)
+              << " ns/lookup\n";
+    std::cout << "params  " << std::setw(8) << perLookup(t4 - t3)
+              << " ns/lookup (" << captured << " id bytes)\n";
+    return checksum == 0 ? 0 : 1;
+}
@@ -0,0 +1,164 @@
+#include <co_async/co_async.hpp>
+#include <co_async/std.hpp>
+#include <latch>
+
+// loopback load generator comparing HTTPServer accept modes:
+//   single   - one listener, one accept loop, one reactor
+//   sharded  - one SO_REUSEPORT listener + accept loop per reactor
+//   multishot- sharded, each shard accepting through a multishot accept SQE
+// every request opens a fresh connection so that the accept path is measured
+//
+// usage: http_shard_bench [seconds] [connections] [server-threads]
+//                         [client-threads]
+
+using namespace co_async;
+using namespace std::literals;
+
+struct BenchResult {
+    std::vector<std::uint64_t> latencies;
+    std::size_t failures = 0;
+};
+
+static Task<Expected<>> fetchOnce(SocketAddress const &addr) {
+    auto sock = co_await co_await socket_connect(addr);
+    // reset on close, or the client side of a million connections would sit
+    // in TIME_WAIT and exhaust the ephemeral ports
+    co_await socketSetOption(sock, SOL_SOCKET, SO_LINGER,
+                             linger{.l_onoff = 1, .l_linger = 0});
+    auto request = "GET / HTTP/1.1\r\nhost: 127.0.0.1\r\n\r\n"sv;
+    while (!request.empty()) {
+        auto n = co_await co_await socket_write(sock, request);
+        request.remove_prefix(n);
+    }
+    String response;
+    char buf[4096];
+    std::size_t headerEnd = String::npos;
+    std::size_t contentLength = 0;
+    while (headerEnd == String::npos ||
+           response.size() < headerEnd + 4 + contentLength) {
+        auto n = co_await co_await socket_read(sock, buf);
+        if (n == 0) [[unlikely]] {
+            co_return std::errc::connection_reset;
+        }
+        response.append(buf, n);
+        if (headerEnd == String::npos) {
+            headerEnd = response.find("\r\n\r\n");
+            if (headerEnd != String::npos) {
+                auto header = lower_string(response.substr(0, headerEnd));
+                if (auto pos = header.find("content-length:");
+                    pos != String::npos) {
+                    auto value = std::string_view(header).substr(pos + 15);
+                    value = value.substr(0, value.find('\r'));
+                    contentLength =
+                        from_string<std::size_t>(trim_string(value))
+                            .value_or(0);
+                }
+            }
+        }
+    }
+    co_return {};
+}
+
+static Task<> clientLoop(SocketAddress addr,
+                         std::chrono::steady_clock::time_point deadline,
+                         BenchResult &result, std::latch &finished) {
+    while (std::chrono::steady_clock::now() < deadline) {
+        auto t0 = std::chrono::steady_clock::now();
+        if (co_await fetchOnce(addr)) [[likely]] {
+            result.latencies.push_back(static_cast<std::uint64_t>(
+                (std::chrono::steady_clock::now() - t0) / 1ns));
+        } else {
+            ++result.failures;
+        }
+    }
+    finished.count_down();
+}
+
+static Task<Expected<>> singleListener(HTTPServer const &server,
+                                       SocketAddress addr) {
+    auto listener = co_await co_await listener_bind(addr);
+    while (true) {
+        if (auto income = co_await listener_accept(listener)) [[likely]] {
+            co_spawn(server.handle_http(std::move(*income)));
+        }
+    }
+}
+
+static void runBench(char const *mode, SocketAddress const &addr,
+                     std::size_t seconds, std::size_t connections,
+                     std::size_t clientThreads) {
+    std::vector<BenchResult> results(connections);
+    std::latch finished(static_cast<std::ptrdiff_t>(connections));
+    {
+        IOContextPool clients(IOContextPoolOptions{
+            .numWorkers = clientThreads,
+            .pinThreads = false,
+        });
+        auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+        for (std::size_t i = 0; i < connections; ++i) {
+            clients.spawn(clientLoop(addr, deadline, results[i], finished));
+        }
+        finished.wait();
+    }
+
+    std::vector<std::uint64_t> latencies;
+    std::size_t failures = 0;
+    for (auto &result: results) {
+        latencies.insert(latencies.end(), result.latencies.begin(),
+                         result.latencies.end());
+        failures += result.failures;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) -> double {
+        if (latencies.empty()) {
+            return 0;
+        }
+        auto i = static_cast<std::size_t>(p * (latencies.size() - 1));
+        return latencies[i] / 1000.0;
+    };
+    std::cout << std::left << std::setw(10) << mode << std::right
+              << std::fixed << std::setprecision(0) << std::setw(10)
+              << latencies.size() / static_cast<double>(seconds) << " req/s"
+              << std::setprecision(1) << "   p50 " << std::setw(8)
+              << percentile(0.50) << " us   p99 " << std::setw(8)
+              << percentile(0.99) << " us   failures " << failures << '\n';
+}
+
+int main(int argc, char **argv) {
+    std::size_t seconds = argc > 1 ? std::stoul(argv[1]) : 5;
+    std::size_t connections = argc > 2 ? std::stoul(argv[2]) : 64;
+    std::size_t serverThreads = argc > 3 ? std::stoul(argv[3]) : 0;
+    std::size_t clientThreads = argc > 4 ? std::stoul(argv[4]) : 0;
+
+    HTTPServer server;
+    server.route("GET", "/", [](HTTPServer::IO &io) -> Task<Expected<>> {
+        co_await co_await HTTPServerUtils::make_ok_response(
+            io, "<h1>It works!</h1>");
+        co_return {};
+    });
+
+    {
+        auto addr =
+            AddressResolver().host("127.0.0.1").port(18081).resolve_one().value();
+        IOContextPool pool(IOContextPoolOptions{.numWorkers = 1});
+        pool.spawn(co_catch(singleListener(server, addr)));
+        std::this_thread::sleep_for(100ms);
+        runBench("single", addr, seconds, connections, clientThreads);
+    }
+    for (bool multishot: {false, true}) {
+        auto addr = AddressResolver()
+                        .host("127.0.0.1")
+                        .port(multishot ? 18083 : 18082)
+                        .resolve_one()
+                        .value();
+        IOContextPool pool(IOContextPoolOptions{.numWorkers = serverThreads});
+        server
+            .serve_sharded(pool, addr,
+                           HTTPShardOptions{.multishotAccept = multishot})
+            .value();
+        runBench(multishot ? "multishot" : "sharded", addr, seconds,
+                 connections, clientThreads);
+    }
+    return 0;
+}
@@ -0,0 +1,215 @@
+#include <co_async/co_async.hpp>
+#include <co_async/std.hpp>
+#include <latch>
+
+// loopback load generator for an HTTPServer whose reactor receives into a
+// deliberately small kernel provided buffer ring (IOContextOptions::
+// providedBuffers), so that the ring runs dry under load and streams fall
+// back to their private buffer and back again. Every connection is kept
+// alive and cycles through three kinds of traffic:
+//   keepalive - one GET, one response
+//   pipelined - a batch of GETs written at once, responses read afterwards
+//   post      - a POST whose body is echoed back and compared
+//
+// usage: provided_buffer_bench [seconds] [connections] [ring-buffers]
+//                              [buffer-size]
+
+using namespace co_async;
+using namespace std::literals;
+
+static constexpr std::size_t kPipelineDepth = 8;
+
+enum Mode : std::size_t {
+    KeepAlive,
+    Pipelined,
+    Post,
+    kNumModes,
+};
+
+static constexpr char const *kModeNames[kNumModes] = {
+    "keepalive",
+    "pipelined",
+    "post",
+};
+
+struct BenchResult {
+    std::size_t requests[kNumModes]{};
+    std::size_t failures = 0;
+};
+
+struct ResponseReader {
+    SocketHandle &sock;
+    String pending;
+
+    // reads one response off the connection, returns its body
+    Task<Expected<String>> next() {
+        std::size_t headerEnd;
+        while ((headerEnd = pending.find("\r\n\r\n")) == String::npos) {
+            co_await co_await fill();
+        }
+        auto header = lower_string(pending.substr(0, headerEnd));
+        if (!header.starts_with("http/1.1 200")) [[unlikely]] {
+            co_return std::errc::protocol_error;
+        }
+        std::size_t contentLength = 0;
+        if (auto pos = header.find("content-length:"); pos != String::npos) {
+            auto value = std::string_view(header).substr(pos + 15);
+            value = value.substr(0, value.find('\r'));
+            contentLength =
+                from_string<std::size_t>(trim_string(value)).value_or(0);
+        }
+        while (pending.size() < headerEnd + 4 + contentLength) {
+            co_await co_await fill();
+        }
+        String body = pending.substr(headerEnd + 4, contentLength);
+        pending.erase(0, headerEnd + 4 + contentLength);
+        co_return body;
+    }
+
+private:
+    Task<Expected<>> fill() {
+        char buf[4096];
+        auto n = co_await co_await socket_read(sock, buf);
+        if (n == 0) [[unlikely]] {
+            co_return std::errc::connection_reset;
+        }
+        pending.append(buf, n);
+        co_return {};
+    }
+};
+
+static Task<Expected<>> writeAll(SocketHandle &sock, std::string_view data) {
+    while (!data.empty()) {
+        auto n = co_await co_await socket_write(sock, data);
+        data.remove_prefix(n);
+    }
+    co_return {};
+}
+
+static Task<Expected<>> exchange(SocketHandle &sock, ResponseReader &reader,
+                                 Mode mode, std::minstd_rand &rng) {
+    auto get = "GET / HTTP/1.1\r\nhost: 127.0.0.1\r\n\r\n"sv;
+    switch (mode) {
+    case KeepAlive: {
+        co_await co_await writeAll(sock, get);
+        co_await co_await reader.next();
+    } break;
+    case Pipelined: {
+        String batch;
+        for (std::size_t i = 0; i < kPipelineDepth; ++i) {
+            batch.append(get);
+        }
+        co_await co_await writeAll(sock, batch);
+        for (std::size_t i = 0; i < kPipelineDepth; ++i) {
+            co_await co_await reader.next();
+        }
+    } break;
+    default: {
+        // bodies larger than one ring buffer, so a request spans several
+        String body(1 + rng() % 6000, '\0');
+        for (auto &c: body) {
+            c = static_cast<char>('a' + rng() % 26);
+        }
+        String request = "POST /echo HTTP/1.1\r\nhost: 127.0.0.1\r\n"
+                         "content-length: " +
+                         to_string(body.size()) + "\r\n\r\n" + body;
+        co_await co_await writeAll(sock, request);
+        auto echoed = co_await co_await reader.next();
+        if (echoed != body) [[unlikely]] {
+            co_return std::errc::protocol_error;
+        }
+    } break;
+    }
+    co_return {};
+}
+
+static Task<> clientLoop(SocketAddress addr, std::size_t seed,
+                         std::chrono::steady_clock::time_point deadline,
+                         BenchResult &result, std::latch &finished) {
+    std::minstd_rand rng(static_cast<std::uint32_t>(seed + 1));
+    std::size_t next = seed;
+    while (std::chrono::steady_clock::now() < deadline) {
+        auto sock = co_await socket_connect(addr);
+        if (sock.has_error()) [[unlikely]] {
+            ++result.failures;
+            continue;
+        }
+        // requests go out in one write each, do not let Nagle hold them
+        // back behind the server's delayed ACK
+        (void)socketSetOption(*sock, IPPROTO_TCP, TCP_NODELAY, 1);
+        ResponseReader reader{*sock};
+        // a fresh connection every 64 exchanges, the rest is keep-alive
+        for (std::size_t i = 0;
+             i < 64 && std::chrono::steady_clock::now() < deadline; ++i) {
+            auto mode = static_cast<Mode>(next++ % kNumModes);
+            if (co_await exchange(*sock, reader, mode, rng)) [[likely]] {
+                result.requests[mode] +=
+                    mode == Pipelined ? kPipelineDepth : 1;
+            } else {
+                ++result.failures;
+                break;
+            }
+        }
+    }
+    finished.count_down();
+}
+
+int main(int argc, char **argv) {
+    std::size_t seconds = argc > 1 ? std::stoul(argv[1]) : 5;
+    std::size_t connections = argc > 2 ? std::stoul(argv[2]) : 64;
+    std::size_t ringBuffers = argc > 3 ? std::stoul(argv[3]) : 4;
+    std::size_t bufferSize = argc > 4 ? std::stoul(argv[4]) : 512;
+
+    HTTPServer server;
+    server.route("GET", "/", [](HTTPServer::IO &io) -> Task<Expected<>> {
+        co_await co_await HTTPServerUtils::make_ok_response(
+            io, "<h1>It works!</h1>");
+        co_return {};
+    });
+    server.route("POST", "/echo", [](HTTPServer::IO &io) -> Task<Expected<>> {
+        auto body = co_await co_await io.request_body();
+        co_await co_await HTTPServerUtils::make_ok_response(io, body,
+                                                            "text/plain");
+        co_return {};
+    });
+
+    auto addr =
+        AddressResolver().host("127.0.0.1").port(18084).resolve_one().value();
+    // one reactor, so every connection competes for the same small ring
+    IOContextPool pool(IOContextPoolOptions{
+        .numWorkers = 1,
+        .context = {.providedBuffers = ringBuffers,
+                    .providedBufferSize = bufferSize},
+    });
+    server.serve_sharded(pool, addr).value();
+
+    std::vector<BenchResult> results(connections);
+    std::latch finished(static_cast<std::ptrdiff_t>(connections));
+    {
+        IOContextPool clients(IOContextPoolOptions{.pinThreads = false});
+        auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+        for (std::size_t i = 0; i < connections; ++i) {
+            clients.spawn(clientLoop(addr, i, deadline, results[i], finished));
+        }
+        finished.wait();
+    }
+
+    BenchResult total;
+    for (auto &result: results) {
+        for (std::size_t m = 0; m < kNumModes; ++m) {
+            total.requests[m] += result.requests[m];
+        }
+        total.failures += result.failures;
+    }
+    std::cout << "ring " << ringBuffers << " x " << bufferSize << " bytes, "
+              << connections << " connections\n";
+    for (std::size_t m = 0; m < kNumModes; ++m) {
+        std::cout << std::left << std::setw(10) << kModeNames[m] << std::right
+                  << std::fixed << std::setprecision(0) << std::setw(10)
+                  << total.requests[m] / static_cast<double>(seconds)
+                  << " req/s\n";
+    }
+    std::cout << "failures " << total.failures << '\n';
+    return total.failures == 0 ? 0 : 1;
+}
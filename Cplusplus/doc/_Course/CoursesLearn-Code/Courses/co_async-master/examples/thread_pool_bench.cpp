@@ -0,0 +1,56 @@
+#include <co_async/co_async.hpp>
+#include <co_async/std.hpp>
+
+// ThreadPool burst benchmark: a burst of short blocking jobs submitted at
+// once from one IOContext, then the same burst one job at a time
+//
+// usage: thread_pool_bench [jobs] [threads]
+
+using namespace co_async;
+using namespace std::literals;
+
+static Task<Expected<std::size_t>> job(ThreadPool &pool, std::size_t i) {
+    co_return co_await pool.run([i] {
+        std::this_thread::sleep_for(10us);
+        return i;
+    });
+}
+
+static Task<Expected<>> amain(std::size_t jobs, std::size_t threads) {
+    ThreadPool pool(threads);
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<Task<Expected<std::size_t>>> burst;
+    burst.reserve(jobs);
+    for (std::size_t i = 0; i < jobs; ++i) {
+        burst.push_back(job(pool, i));
+    }
+    std::size_t sum = 0;
+    for (auto &res: co_await when_all(burst)) {
+        sum += res.value();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < jobs; ++i) {
+        sum -= co_await co_await job(pool, i);
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    auto perJob = [&](auto dt) {
+        return static_cast<double>(dt / 1ns) / static_cast<double>(jobs);
+    };
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << jobs << " jobs on " << pool.threads_count() << " threads"
+              << (sum == 0 ? "" : " (MISMATCH)") << '\n';
+    std::cout << "burst      " << std::setw(8) << perJob(t1 - t0)
+              << " ns/job\n";
+    std::cout << "one by one " << std::setw(8) << perJob(t2 - t1)
+              << " ns/job\n";
+    co_return {};
+}
+
+int main(int argc, char **argv) {
+    std::size_t jobs = argc > 1 ? std::stoul(argv[1]) : 100000;
+    std::size_t threads = argc > 2 ? std::stoul(argv[2]) : 0;
+    co_main(amain(jobs, threads));
+    return 0;
+}
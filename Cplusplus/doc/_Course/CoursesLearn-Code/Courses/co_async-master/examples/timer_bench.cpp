@@ -0,0 +1,93 @@
+#include <co_async/co_async.hpp>
+#include <co_async/std.hpp>
+
+// timer churn benchmark, rb-tree against timer wheel: arm one long timeout
+// per simulated connection and cancel it again before it fires, like a
+// keep-alive timeout reset on every request, then let a batch of shorter
+// timers fire and report how late they were
+//
+// usage: timer_bench [timers] [wheel tick in us]
+
+using namespace co_async;
+using namespace std::literals;
+
+static Task<> keepAlive(std::size_t &cancelled) {
+    auto res = co_await co_sleep(30s);
+    if (res.has_error()) {
+        ++cancelled;
+    }
+}
+
+static Task<> shortTimer(std::chrono::steady_clock::duration timeout,
+                         std::chrono::steady_clock::duration &lateness,
+                         std::size_t &early) {
+    auto expires = std::chrono::steady_clock::now() + timeout;
+    (void)co_await co_sleep(expires);
+    auto now = std::chrono::steady_clock::now();
+    if (now < expires) {
+        ++early;
+    }
+    lateness = std::max(lateness, now - expires);
+}
+
+static Task<> bench(std::size_t timers, char const *name) {
+    std::vector<CancelSource> sources(timers);
+    std::size_t cancelled = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (auto &source: sources) {
+        co_spawn(co_cancel.bind(source, keepAlive(cancelled)));
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    std::vector<Task<>> cancels;
+    cancels.reserve(timers);
+    for (auto &source: sources) {
+        cancels.push_back(source.cancel());
+    }
+    co_await when_all(cancels);
+    // the cancelled sleepers wake up on the next loop iteration
+    co_await co_sleep(0ms);
+    auto t2 = std::chrono::steady_clock::now();
+
+    std::vector<Task<>> batch;
+    std::chrono::steady_clock::duration lateness{};
+    std::size_t early = 0;
+    // up to 300ms, so that the wheel has to re-hash some of them
+    for (std::size_t i = 0; i < 1000; ++i) {
+        batch.push_back(shortTimer(std::chrono::microseconds(i * 337 % 300000),
+                                   lateness, early));
+    }
+    co_await when_all(batch);
+
+    auto perTimer = [&](auto dt) {
+        return static_cast<double>(dt / 1ns) / static_cast<double>(timers);
+    };
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << name
+              << (cancelled == timers && early == 0 ? "" : " (MISMATCH)")
+              << '\n';
+    std::cout << "  arm        " << std::setw(8) << perTimer(t1 - t0)
+              << " ns/timer\n";
+    std::cout << "  cancel     " << std::setw(8) << perTimer(t2 - t1)
+              << " ns/timer\n";
+    std::cout << "  max late   " << std::setw(8)
+              << static_cast<double>(lateness / 1ns) / 1000.0 << " us\n";
+}
+
+static void run(IOContextOptions options, std::size_t timers,
+                char const *name) {
+    IOContext ctx(options);
+    co_spawn(bench(timers, name));
+    ctx.run();
+}
+
+int main(int argc, char **argv) {
+    std::size_t timers = argc > 1 ? std::stoul(argv[1]) : 100000;
+    auto tick = std::chrono::microseconds(argc > 2 ? std::stoul(argv[2]) : 1000);
+
+    std::cout << timers << " keep-alive timers\n";
+    run({}, timers, "rb-tree");
+    IOContextOptions wheel;
+    wheel.timerWheelTick = tick;
+    run(wheel, timers, "timer wheel");
+    return 0;
+}
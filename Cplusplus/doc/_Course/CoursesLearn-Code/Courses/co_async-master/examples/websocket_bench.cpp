@@ -0,0 +1,137 @@
+#include <co_async/co_async.hpp>
+#include <co_async/std.hpp>
+
+// WebSocket receive benchmark over masked binary frames held in memory:
+// the byte-by-byte unmasking wsRecvPacket did before against websocketMask,
+// then whole frames received the old way (header fields and payload each
+// copied out with getn), assembled by wsRecvPacket, and streamed in place
+// by wsRecvFrameChunk
+//
+// usage: websocket_bench [frame size] [frames]
+
+using namespace co_async;
+using namespace std::literals;
+
+static std::string makeFrames(std::size_t size, std::size_t frames) {
+    std::string out;
+    for (std::size_t f = 0; f < frames; ++f) {
+        out.push_back(static_cast<char>(0x80 | WebSocketPacket::kOpcodeBinary));
+        out.push_back(static_cast<char>(0x80 | 0x7F));
+        auto len = byteswap_if_little(static_cast<std::uint64_t>(size));
+        out.append(reinterpret_cast<char const *>(&len), sizeof(len));
+        char mask[4] = {0x12, 0x34, 0x56, static_cast<char>(0x78 + f)};
+        out.append(mask, 4);
+        for (std::size_t i = 0; i < size; ++i) {
+            out.push_back(static_cast<char>((i * 7 + f) ^ mask[i % 4]));
+        }
+    }
+    return out;
+}
+
+static std::uint64_t checksum(std::span<char const> data) {
+    std::uint64_t sum = 0;
+    for (auto c: data) {
+        sum += static_cast<unsigned char>(c);
+    }
+    return sum;
+}
+
+// what wsRecvPacket did before, for comparison
+static Task<Expected<WebSocketPacket>> oldRecvPacket(BorrowedStream &ws) {
+    WebSocketPacket packet;
+    auto head = co_await co_await ws.getn(2);
+    packet.opcode = static_cast<WebSocketPacket::Opcode>(head[0] & 0x0F);
+    auto payloadLen = static_cast<std::size_t>(
+        byteswap_if_little(co_await co_await ws.getstruct<std::uint64_t>()));
+    std::string mask = co_await co_await ws.getn(4);
+    auto data = co_await co_await ws.getn(payloadLen);
+    for (std::size_t i = 0; i != data.size(); ++i) {
+        data[i] ^= mask[i % 4];
+    }
+    packet.content += data;
+    co_return std::move(packet);
+}
+
+template <class F>
+static Task<Expected<double>> timeRecv(std::string const &wire,
+                                       std::size_t frames, std::uint64_t &sum,
+                                       F recv) {
+    auto stream = make_stream<IStringStream>(wire);
+    sum = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (std::size_t f = 0; f < frames; ++f) {
+        sum += co_await co_await recv(stream);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    co_return static_cast<double>(wire.size()) /
+        static_cast<double>((t1 - t0) / 1ns);
+}
+
+static Task<Expected<>> amain(std::size_t size, std::size_t frames) {
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << frames << " masked frames of " << size << " bytes\n";
+
+    std::string buf(size, 'x');
+    char const mask[4] = {0x12, 0x34, 0x56, 0x78};
+    auto t0 = std::chrono::steady_clock::now();
+    for (std::size_t f = 0; f < frames; ++f) {
+        for (std::size_t i = 0; i != buf.size(); ++i) {
+            buf[i] ^= mask[i % 4];
+        }
+        asm volatile("" ::"r"(buf.data()) : "memory");
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (std::size_t f = 0; f < frames; ++f) {
+        websocketMask(buf, {mask[0], mask[1], mask[2], mask[3]});
+        asm volatile("" ::"r"(buf.data()) : "memory");
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    auto gbps = [&](auto dt) {
+        return static_cast<double>(size * frames) /
+               static_cast<double>(dt / 1ns);
+    };
+    std::cout << "unmask byte by byte " << std::setw(8) << gbps(t1 - t0)
+              << " GB/s\n";
+    std::cout << "unmask websocketMask" << std::setw(8) << gbps(t2 - t1)
+              << " GB/s" << (buf == std::string(size, 'x') ? "" : " (MISMATCH)")
+              << '\n';
+
+    auto wire = makeFrames(size, frames);
+    std::uint64_t sumOld, sumPacket, sumStream;
+    auto old = co_await co_await timeRecv(
+        wire, frames, sumOld, [](BorrowedStream &ws) -> Task<Expected<std::uint64_t>> {
+            auto packet = co_await co_await oldRecvPacket(ws);
+            co_return checksum(packet.content);
+        });
+    auto packet = co_await co_await timeRecv(
+        wire, frames, sumPacket, [](BorrowedStream &ws) -> Task<Expected<std::uint64_t>> {
+            auto packet = co_await co_await wsRecvPacket(ws);
+            co_return checksum(packet.content);
+        });
+    auto stream = co_await co_await timeRecv(
+        wire, frames, sumStream, [](BorrowedStream &ws) -> Task<Expected<std::uint64_t>> {
+            auto frame = co_await co_await wsRecvFrameHead(ws);
+            std::uint64_t sum = 0;
+            while (true) {
+                auto chunk = co_await co_await wsRecvFrameChunk(ws, frame);
+                if (chunk.empty()) {
+                    break;
+                }
+                sum += checksum(chunk);
+            }
+            co_return sum;
+        });
+    bool same = sumOld == sumPacket && sumOld == sumStream;
+    std::cout << "recv before         " << std::setw(8) << old << " GB/s\n";
+    std::cout << "recv wsRecvPacket   " << std::setw(8) << packet << " GB/s\n";
+    std::cout << "recv streamed       " << std::setw(8) << stream << " GB/s"
+              << (same ? "" : " (MISMATCH)") << '\n';
+    co_return {};
+}
+
+int main(int argc, char **argv) {
+    std::size_t size = argc > 1 ? std::stoul(argv[1]) : 1 << 20;
+    std::size_t frames = argc > 2 ? std::stoul(argv[2]) : 64;
+    co_main(amain(size, frames));
+    return 0;
+}
@@ -0,0 +1,112 @@
+﻿// DagScheduler 吞吐量测试（tasks/s）
+// wide: 1 个源点 -> N 个并行任务 -> 1 个汇点
+// deep: N 个任务组成的单链
+// 对比 ThreadPoolExecutor（单队列）与 WorkStealingExecutor 两种后端
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "algorithm/dag_scheduler.hpp"
+
+namespace {
+// 每个任务做少量计算，模拟细粒度节点
+inline void tiny_work(std::atomic<std::uint64_t>& sink)
+{
+  std::uint64_t value = 0;
+  for (int i = 0; i < 64; ++i) {
+    value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+  }
+  sink.fetch_add(value & 1, std::memory_order_relaxed);
+}
+
+template<typename ExecutorType>
+void build_wide(stdex::BasicDagScheduler<ExecutorType>& scheduler, std::size_t width,
+                std::atomic<std::uint64_t>& sink)
+{
+  scheduler.add_task("source", [&sink] { tiny_work(sink); });
+
+  std::vector<std::string> join_dependencies;
+  join_dependencies.reserve(width);
+  for (std::size_t i = 0; i < width; ++i) {
+    auto id = "w" + std::to_string(i);
+    scheduler.add_task(id, [&sink] { tiny_work(sink); }, { "source" });
+    join_dependencies.push_back(std::move(id));
+  }
+
+  scheduler.add_task("sink", [&sink] { tiny_work(sink); },
+                     std::move(join_dependencies));
+}
+
+template<typename ExecutorType>
+void build_deep(stdex::BasicDagScheduler<ExecutorType>& scheduler, std::size_t depth,
+                std::atomic<std::uint64_t>& sink)
+{
+  scheduler.add_task("d0", [&sink] { tiny_work(sink); });
+  for (std::size_t i = 1; i < depth; ++i) {
+    scheduler.add_task("d" + std::to_string(i), [&sink] { tiny_work(sink); },
+                       { "d" + std::to_string(i - 1) });
+  }
+}
+
+template<typename ExecutorType, bool Wide>
+void BM_DagScheduler(benchmark::State& state)
+{
+  const auto                  size = static_cast<std::size_t>(state.range(0));
+  std::atomic<std::uint64_t>  sink { 0 };
+  stdex::BasicDagScheduler<ExecutorType> scheduler;
+
+  if constexpr (Wide) {
+    build_wide(scheduler, size, sink);
+  } else {
+    build_deep(scheduler, size, sink);
+  }
+  const std::size_t task_count = Wide ? size + 2 : size;
+  scheduler.compile();
+
+  for (auto _ : state) {
+    scheduler.execute();
+
+    state.PauseTiming();
+    scheduler.reset();
+    state.ResumeTiming();
+  }
+
+  benchmark::DoNotOptimize(sink.load());
+  state.counters ["tasks/s"] = benchmark::Counter(
+      static_cast<double>(task_count), benchmark::Counter::kIsIterationInvariantRate);
+}
+}  // namespace
+
+BENCHMARK(BM_DagScheduler<stdex::ThreadPoolExecutor, true>)
+    ->Name("Wide/ThreadPool")
+    ->RangeMultiplier(4)
+    ->Range(1 << 6, 1 << 12)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(BM_DagScheduler<stdex::WorkStealingExecutor, true>)
+    ->Name("Wide/WorkStealing")
+    ->RangeMultiplier(4)
+    ->Range(1 << 6, 1 << 12)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(BM_DagScheduler<stdex::ThreadPoolExecutor, false>)
+    ->Name("Deep/ThreadPool")
+    ->RangeMultiplier(4)
+    ->Range(1 << 6, 1 << 10)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(BM_DagScheduler<stdex::WorkStealingExecutor, false>)
+    ->Name("Deep/WorkStealing")
+    ->RangeMultiplier(4)
+    ->Range(1 << 6, 1 << 10)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,133 @@
+﻿// 按请求分配、整体释放的吞吐量（requests/s）
+// 每次迭代模拟一个请求：分配 256 个 16~256 字节的块，外加一个逐个 push_back 增长到
+// 1024 个元素的 pmr::vector，然后释放全部内存：
+//   ArenaResource：reset()，不逐个释放
+//   std::pmr::monotonic_buffer_resource：release()，下一个请求重新向上游要内存
+//   PoolResource / new_delete_resource：逐个释放
+// ArenaResource 另报告块数与高水位
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+#include "memory/arena_resource.hpp"
+#include "memory/pmr_allocator.hpp"
+
+namespace {
+constexpr std::size_t request_blocks = 256;
+constexpr std::size_t vector_length  = 1024;
+
+constexpr std::size_t block_size(std::size_t i)
+{
+  return 16 + (i * 37) % 241;
+}
+
+// 一个请求的全部分配；FreeEach 为真时逐个释放
+template<bool FreeEach>
+void run_request(std::pmr::memory_resource& resource)
+{
+  std::array<void*, request_blocks> blocks;
+  for (std::size_t i = 0; i < request_blocks; ++i) {
+    blocks [i] = resource.allocate(block_size(i), alignof(std::max_align_t));
+  }
+  {
+    std::pmr::vector<std::size_t> values(&resource);
+    for (std::size_t i = 0; i < vector_length; ++i) {
+      values.push_back(i);
+    }
+    benchmark::DoNotOptimize(values.data());
+  }
+  benchmark::DoNotOptimize(blocks.data());
+  if constexpr (FreeEach) {
+    for (std::size_t i = request_blocks; i-- > 0;) {
+      resource.deallocate(blocks [i], block_size(i), alignof(std::max_align_t));
+    }
+  }
+}
+
+void set_counters(benchmark::State& state)
+{
+  state.counters ["requests/s"] =
+      benchmark::Counter(1, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+void BM_ArenaResource(benchmark::State& state)
+{
+  stdex::ArenaResource arena;
+  for (auto _ : state) {
+    run_request<false>(arena);
+    arena.reset();
+  }
+  set_counters(state);
+  const auto stats          = arena.stats();
+  state.counters ["blocks"] = static_cast<double>(stats.block_count);
+  state.counters ["high_water"] =
+      benchmark::Counter(static_cast<double>(stats.high_water_bytes),
+                         benchmark::Counter::kDefaults, benchmark::Counter::kIs1024);
+}
+
+// 按栈序释放的临时块：释放会退回游标，但高水位必须记住峰值
+void BM_ArenaStackOrder(benchmark::State& state)
+{
+  constexpr std::size_t temporary_bytes = 30000;
+  stdex::ArenaResource  arena;
+  for (auto _ : state) {
+    void* temporary = arena.allocate(temporary_bytes, 8);
+    benchmark::DoNotOptimize(temporary);
+    arena.deallocate(temporary, temporary_bytes, 8);
+  }
+  const auto stats = arena.stats();
+  if (stats.used_bytes != 0 || stats.high_water_bytes != temporary_bytes) {
+    state.SkipWithError("high water lost a peak freed in stack order");
+  }
+  state.counters ["high_water"] = static_cast<double>(stats.high_water_bytes);
+}
+
+void BM_ArenaScope(benchmark::State& state)
+{
+  stdex::ArenaResource& arena = stdex::thread_arena();
+  for (auto _ : state) {
+    stdex::ArenaScope scope(arena);
+    run_request<false>(arena);
+  }
+  set_counters(state);
+}
+
+void BM_MonotonicBufferResource(benchmark::State& state)
+{
+  std::pmr::monotonic_buffer_resource resource;
+  for (auto _ : state) {
+    run_request<false>(resource);
+    resource.release();
+  }
+  set_counters(state);
+}
+
+template<typename Resource>
+void BM_FreeEach(benchmark::State& state)
+{
+  Resource resource;
+  for (auto _ : state) {
+    run_request<true>(resource);
+  }
+  set_counters(state);
+}
+
+void BM_NewDelete(benchmark::State& state)
+{
+  for (auto _ : state) {
+    run_request<true>(*std::pmr::new_delete_resource());
+  }
+  set_counters(state);
+}
+}  // namespace
+
+BENCHMARK(BM_ArenaResource)->Name("Request/ArenaResource");
+BENCHMARK(BM_ArenaScope)->Name("Request/ArenaScope/thread_arena");
+BENCHMARK(BM_ArenaStackOrder)->Name("Request/ArenaResource/stack_order");
+BENCHMARK(BM_MonotonicBufferResource)->Name("Request/std::pmr::monotonic_buffer_resource");
+BENCHMARK(BM_FreeEach<stdex::UnsynchronizedPoolResource>)->Name("Request/PoolResource");
+BENCHMARK(BM_NewDelete)->Name("Request/std::pmr::new_delete_resource");
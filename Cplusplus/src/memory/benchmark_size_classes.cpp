@@ -0,0 +1,142 @@
+﻿// 混合尺寸的单线程分配/释放吞吐量与内存占用
+// 维持 4096 个存活块，每次迭代随机替换其中一块；两种尺寸分布：
+//   small: 8~128 字节均匀分布
+//   mixed: 8~4096 字节，七成不超过 128 字节
+// overhead 为 malloc 中占用的字节（glibc mallinfo2，不含 malloc 的空闲块）
+// 相对存活块请求字节的额外开销，包括尺寸类取整、未填满的 slab 与 malloc 的块头；
+// PoolResource 另报告 slab 数
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "memory/pmr_allocator.hpp"
+
+namespace {
+constexpr std::size_t live_blocks = 4096;
+constexpr std::size_t size_count  = 1 << 16;
+
+// 固定种子的尺寸与替换位置序列，保证各个资源看到相同的请求
+struct Workload
+{
+  std::array<std::uint32_t, size_count> sizes;
+  std::array<std::uint32_t, size_count> slots;
+
+  explicit Workload(bool mixed)
+  {
+    std::uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    auto          next = [&seed] {
+      seed ^= seed << 13;
+      seed ^= seed >> 7;
+      seed ^= seed << 17;
+      return static_cast<std::uint32_t>(seed);
+    };
+    for (std::size_t i = 0; i < size_count; ++i) {
+      const std::uint32_t bucket = mixed ? next() % 100 : 0;
+      if (bucket < 70) {
+        sizes [i] = 8 + next() % 121;
+      } else if (bucket < 95) {
+        sizes [i] = 129 + next() % 896;
+      } else {
+        sizes [i] = 1025 + next() % 3072;
+      }
+      slots [i] = next() % live_blocks;
+    }
+  }
+};
+
+const Workload& workload(bool mixed)
+{
+  static const Workload small(false);
+  static const Workload mixed_sizes(true);
+  return mixed ? mixed_sizes : small;
+}
+
+std::size_t heap_in_use()
+{
+#if defined(__GLIBC__)
+  const auto info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+#else
+  return 0;
+#endif
+}
+
+struct Block
+{
+  void*       pointer;
+  std::size_t bytes;
+};
+
+template<typename Resource>
+void BM_SizeClassChurn(benchmark::State& state)
+{
+  const Workload&   load = workload(state.range(0) != 0);
+  std::vector<Block> blocks(live_blocks);
+  // 记账数组不计入开销
+  const std::size_t heap_base  = heap_in_use();
+  std::size_t       live_bytes = 0;
+  Resource          resource;
+
+  for (std::size_t i = 0; i < live_blocks; ++i) {
+    blocks [i] = { resource.allocate(load.sizes [i], alignof(std::max_align_t)),
+                   load.sizes [i] };
+    live_bytes += load.sizes [i];
+  }
+
+  std::size_t step = live_blocks;
+  for (auto _ : state) {
+    const std::size_t i     = step % size_count;
+    Block&            block = blocks [load.slots [i]];
+    resource.deallocate(block.pointer, block.bytes, alignof(std::max_align_t));
+    live_bytes -= block.bytes;
+    block = { resource.allocate(load.sizes [i], alignof(std::max_align_t)),
+              load.sizes [i] };
+    live_bytes += block.bytes;
+    benchmark::DoNotOptimize(block.pointer);
+    ++step;
+  }
+
+  state.counters ["ops/s"] = benchmark::Counter(
+      2.0, benchmark::Counter::kIsIterationInvariantRate);
+  if (const std::size_t heap = heap_in_use(); heap != 0) {
+    state.counters ["overhead"] =
+        static_cast<double>(heap - heap_base) / static_cast<double>(live_bytes) -
+        1.0;
+  }
+  if constexpr (requires { resource.stats(); }) {
+    state.counters ["slabs"] =
+        static_cast<double>(resource.stats().slab_count);
+  }
+
+  for (Block& block : blocks) {
+    resource.deallocate(block.pointer, block.bytes, alignof(std::max_align_t));
+  }
+}
+}  // namespace
+
+BENCHMARK(BM_SizeClassChurn<stdex::UnsynchronizedPoolResource>)
+    ->Name("SizeClassChurn/PoolResource")
+    ->ArgName("mixed")
+    ->Arg(0)
+    ->Arg(1);
+
+BENCHMARK(BM_SizeClassChurn<stdex::SynchronizedPoolResource>)
+    ->Name("SizeClassChurn/PoolResource/Mutex")
+    ->ArgName("mixed")
+    ->Arg(0)
+    ->Arg(1);
+
+BENCHMARK(BM_SizeClassChurn<std::pmr::unsynchronized_pool_resource>)
+    ->Name("SizeClassChurn/std::pmr::unsynchronized_pool_resource")
+    ->ArgName("mixed")
+    ->Arg(0)
+    ->Arg(1);
@@ -1,28 +1,33 @@
 ﻿#pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <concepts>
 #include <condition_variable>
+#include <cstdint>
 #include <format>
 #include <functional>
-#include <future>
 #include <iostream>
 #include <memory>
 #include <mutex>
 #include <queue>
+#include <random>
 #include <ranges>
+#include <span>
+#include <string_view>
 #include <thread>
 #include <type_traits>
 #include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
+#include "random/xorshift32.hpp"
+
 namespace stdex {
 
 // DAG (Directed Acyclic Graph) Task Scheduler Framework
 // Features:
 // - Complete DAG task dependency management
-// - Concurrent execution using thread pool
+// - Concurrent execution using a work-stealing thread pool
 // - Automatic cycle detection
 // - Real-time task state tracking
 // - Comprehensive exception handling and error reporting
@@ -39,6 +44,60 @@ template<typename FunctionType>
 concept Task = requires (FunctionType task) {
   { task() } -> std::same_as<void>;
 };
+
+// Growable ring buffer used as a per-worker double-ended work queue.
+// The owner pushes and pops at the back (LIFO, cache-warm), thieves take
+// from the front (FIFO, oldest and usually largest work). Capacity only
+// grows, so a warmed-up queue never allocates again.
+template<typename ValueType>
+class WorkDeque
+{
+public:
+
+  bool empty() const noexcept { return m_Size == 0; }
+
+  std::size_t size() const noexcept { return m_Size; }
+
+  void push_back(ValueType value)
+  {
+    if (m_Size == m_Buffer.size()) { grow(); }
+    m_Buffer [(m_Head + m_Size) & (m_Buffer.size() - 1)] = std::move(value);
+    ++m_Size;
+  }
+
+  bool pop_back(ValueType& value)
+  {
+    if (m_Size == 0) { return false; }
+    --m_Size;
+    value = std::move(m_Buffer [(m_Head + m_Size) & (m_Buffer.size() - 1)]);
+    return true;
+  }
+
+  bool pop_front(ValueType& value)
+  {
+    if (m_Size == 0) { return false; }
+    value  = std::move(m_Buffer [m_Head]);
+    m_Head = (m_Head + 1) & (m_Buffer.size() - 1);
+    --m_Size;
+    return true;
+  }
+
+private:
+
+  void grow()
+  {
+    std::vector<ValueType> buffer(m_Buffer.empty() ? 64 : m_Buffer.size() * 2);
+    for (std::size_t i = 0; i < m_Size; ++i) {
+      buffer [i] = std::move(m_Buffer [(m_Head + i) & (m_Buffer.size() - 1)]);
+    }
+    m_Buffer.swap(buffer);
+    m_Head = 0;
+  }
+
+  std::vector<ValueType> m_Buffer;
+  std::size_t            m_Head = 0;
+  std::size_t            m_Size = 0;
+};
 }  // namespace detail
 // Task state enumeration
 enum class TaskState
@@ -194,14 +253,208 @@ private:
   std::atomic<int>                  m_ActiveTasks { 0 };
 };
 
+// Work-stealing executor
+// - One deque per worker, stealing picks a random victim
+// - submit() called from a worker thread pushes onto that worker's own deque,
+//   so work spawned by a finishing task runs next on the same core
+// - submit() from any other thread is spread round-robin over the workers
+// - Idle workers spin/steal for a bounded number of rounds, then park
+class WorkStealingExecutor
+{
+public:
+
+  explicit WorkStealingExecutor(
+      std::size_t thread_count = std::thread::hardware_concurrency())
+      : m_Queues(std::max<std::size_t>(thread_count, 1))
+  {
+    m_Workers.reserve(m_Queues.size());
+    for (std::size_t i = 0; i < m_Queues.size(); ++i) {
+      m_Workers.emplace_back([this, i] { worker_loop(i); });
+    }
+  }
+
+  ~WorkStealingExecutor()
+  {
+    {
+      std::lock_guard lock(m_ParkMutex);
+      m_Stop.store(true);
+    }
+    m_ParkCondition.notify_all();
+    for (auto& worker : m_Workers) {
+      if (worker.joinable()) { worker.join(); }
+    }
+  }
+
+  WorkStealingExecutor(const WorkStealingExecutor&)            = delete;
+  WorkStealingExecutor& operator= (const WorkStealingExecutor&) = delete;
+
+  void submit(std::function<void()> task)
+  {
+    if (m_Stop.load(std::memory_order_relaxed)) {
+      throw std::runtime_error("Executor has been stopped");
+    }
+
+    std::size_t index = t_Owner == this
+        ? t_Index
+        : m_NextQueue.fetch_add(1, std::memory_order_relaxed) % m_Queues.size();
+
+    m_Outstanding.fetch_add(1);
+    {
+      std::lock_guard lock(m_Queues [index].m_Mutex);
+      m_Queues [index].m_Tasks.push_back(std::move(task));
+    }
+    m_Queued.fetch_add(1);
+
+    if (m_Sleepers.load() > 0) {
+      std::lock_guard lock(m_ParkMutex);
+      m_ParkCondition.notify_one();
+    }
+  }
+
+  // Blocks until every submitted task has finished.
+  // Must not be called from a worker thread.
+  void wait()
+  {
+    for (auto outstanding = m_Outstanding.load(); outstanding != 0;
+         outstanding      = m_Outstanding.load()) {
+      m_Outstanding.wait(outstanding);
+    }
+  }
+
+  std::size_t worker_count() const noexcept { return m_Workers.size(); }
+
+private:
+
+  // Rounds of pop/steal attempts before an idle worker parks
+  static constexpr int kSpinRounds = 64;
+
+  struct alignas(64) WorkerQueue
+  {
+    std::mutex                                m_Mutex;
+    detail::WorkDeque<std::function<void()>> m_Tasks;
+  };
+
+  bool try_pop_local(std::size_t index, std::function<void()>& task)
+  {
+    auto&           queue = m_Queues [index];
+    std::lock_guard lock(queue.m_Mutex);
+    return queue.m_Tasks.pop_back(task);
+  }
+
+  bool try_steal(std::size_t index, XorShift32& random,
+                 std::function<void()>& task)
+  {
+    const std::size_t count = m_Queues.size();
+    if (count == 1) { return false; }
+
+    std::size_t victim = random() % count;
+    for (std::size_t i = 0; i < count; ++i, victim = (victim + 1) % count) {
+      if (victim == index) { continue; }
+      auto&            queue = m_Queues [victim];
+      std::unique_lock lock(queue.m_Mutex, std::try_to_lock);
+      if (lock.owns_lock() && queue.m_Tasks.pop_front(task)) { return true; }
+    }
+    return false;
+  }
+
+  bool try_acquire(std::size_t index, XorShift32& random,
+                   std::function<void()>& task)
+  {
+    if (try_pop_local(index, task) || try_steal(index, random, task)) {
+      m_Queued.fetch_sub(1);
+      return true;
+    }
+    return false;
+  }
+
+  void run(std::function<void()>& task)
+  {
+    task();
+    task = nullptr;
+    if (m_Outstanding.fetch_sub(1) == 1) { m_Outstanding.notify_all(); }
+  }
+
+  void worker_loop(std::size_t index)
+  {
+    t_Owner = this;
+    t_Index = index;
+
+    XorShift32            random(index);
+    std::function<void()> task;
+
+    while (true) {
+      bool found = false;
+      for (int round = 0; round < kSpinRounds && !found; ++round) {
+        found = try_acquire(index, random, task);
+        if (!found && m_Queued.load() == 0) { std::this_thread::yield(); }
+      }
+
+      if (found) {
+        run(task);
+        continue;
+      }
+
+      std::unique_lock lock(m_ParkMutex);
+      m_Sleepers.fetch_add(1);
+      m_ParkCondition.wait(lock,
+                           [this] { return m_Stop.load() || m_Queued.load(); });
+      m_Sleepers.fetch_sub(1);
+      if (m_Stop.load() && m_Queued.load() == 0) { return; }
+    }
+  }
+
+  inline thread_local static const WorkStealingExecutor* t_Owner = nullptr;
+  inline thread_local static std::size_t                 t_Index = 0;
+
+  std::vector<WorkerQueue>  m_Queues;
+  std::vector<std::thread>  m_Workers;
+  std::mutex                m_ParkMutex;
+  std::condition_variable   m_ParkCondition;
+  std::atomic<std::size_t>  m_NextQueue { 0 };
+  std::atomic<std::size_t>  m_Queued { 0 };
+  std::atomic<std::size_t>  m_Outstanding { 0 };
+  std::atomic<int>          m_Sleepers { 0 };
+  std::atomic<bool>         m_Stop { false };
+};
+
+static_assert(detail::TaskExecutor<ThreadPoolExecutor>);
+static_assert(detail::TaskExecutor<WorkStealingExecutor>);
+
+// Frozen, integer-indexed form of the task graph produced by
+// DagScheduler::compile(). Task IDs are dense indices into `tasks`,
+// dependents are stored as CSR adjacency arrays.
+struct CompiledDag
+{
+  std::vector<std::shared_ptr<TaskInterface>> tasks;
+  std::vector<std::uint32_t>                  dependent_offsets;  // size n + 1
+  std::vector<std::uint32_t>                  dependents;
+  std::vector<std::uint32_t>                  in_degree;
+  std::vector<std::uint32_t> topological_order;  // roots form the prefix
+  std::uint32_t              root_count = 0;
+
+  std::uint32_t size() const noexcept
+  {
+    return static_cast<std::uint32_t>(tasks.size());
+  }
+
+  std::span<const std::uint32_t> dependents_of(std::uint32_t index) const
+  {
+    return { dependents.data() + dependent_offsets [index],
+             dependents.data() + dependent_offsets [index + 1] };
+  }
+};
+
 // DAG scheduler
-class DagScheduler
+// Ready tasks are submitted to ExecutorType, which defaults to the
+// work-stealing executor above.
+template<detail::TaskExecutor ExecutorType = WorkStealingExecutor>
+class BasicDagScheduler
 {
 public:
 
-  explicit DagScheduler(std::unique_ptr<ThreadPoolExecutor> executor = nullptr)
+  explicit BasicDagScheduler(std::unique_ptr<ExecutorType> executor = nullptr)
       : m_Executor(executor ? std::move(executor)
-                            : std::make_unique<ThreadPoolExecutor>())
+                            : std::make_unique<ExecutorType>())
   {
   }
 
@@ -219,6 +472,7 @@ public:
       throw std::runtime_error(
           std::format("Task with id '{}' already exists", task->get_id()));
     }
+    m_Compiled = false;
   }
 
   // Add dependency relationship between tasks
@@ -236,36 +490,70 @@ public:
     }
 
     task_iterator->second->add_dependency(dependency_id);
+    m_Compiled = false;
+  }
+
+  // Freeze the current graph: validates it, assigns dense task indices and
+  // builds the CSR adjacency, topological order and in-degree vector.
+  // execute() calls this lazily after the graph changes; calling it up front
+  // moves the cost out of the first execution.
+  void compile()
+  {
+    std::lock_guard lock(m_Mutex);
+    compile_graph();
   }
 
   // Execute the DAG scheduling
+  // Completion is event-driven: a finishing task decrements the atomic
+  // in-degree of its dependents and submits every dependent that drops to
+  // zero itself, so the calling thread only sleeps until the last task ends.
+  // Executions of an already compiled graph only reset the counters.
   void execute()
   {
     std::lock_guard lock(m_Mutex);
 
-    validate_dag();
-    build_execution_graph();
-
-    std::vector<std::string> ready_tasks = get_ready_tasks();
-
-    while (!ready_tasks.empty() || !m_RunningTasks.empty()) {
-      // Submit ready tasks
-      for (const auto& task_id : ready_tasks) {
-        auto task = m_Tasks.at(task_id);
-        task->set_state(TaskState::Ready);
+    if (!m_Compiled) { compile_graph(); }
 
-        auto future = std::async(std::launch::async,
-                                 [this, task] { return execute_task(task); });
-
-        m_RunningTasks.emplace(task_id, std::move(future));
+    const std::uint32_t task_count = m_Graph.size();
+    for (std::uint32_t i = 0; i < task_count; ++i) {
+      m_Pending [i].store(m_Graph.in_degree [i], std::memory_order_relaxed);
+      m_Cancelled [i].store(false, std::memory_order_relaxed);
+    }
+    m_Remaining.store(task_count);
+
+    // The ready set is complete before the first dispatch: from then on
+    // workers lower m_Pending and dispatch dependents themselves, so a scan
+    // racing with them could dispatch a task twice
+    m_Ready.clear();
+    for (std::uint32_t i = 0; i < m_Graph.root_count; ++i) {
+      const std::uint32_t index = m_Graph.topological_order [i];
+      if (m_Graph.tasks [index]->get_state() == TaskState::Pending) {
+        m_Ready.push_back(index);
       }
+    }
 
-      // Wait for any task to complete
-      if (!m_RunningTasks.empty()) {
-        wait_for_completion();
-        ready_tasks = get_ready_tasks();
+    // Tasks left over from a previous run (no reset() in between) count as
+    // already finished and release their dependents before anything runs
+    for (std::uint32_t index : m_Graph.topological_order) {
+      const TaskState state = m_Graph.tasks [index]->get_state();
+      if (state != TaskState::Pending) {
+        release_dependents(index, state == TaskState::Completed,
+                           [this](std::uint32_t dependent) {
+                             if (m_Graph.tasks [dependent]->get_state() ==
+                                 TaskState::Pending) {
+                               m_Ready.push_back(dependent);
+                             }
+                           });
+        m_Remaining.fetch_sub(1, std::memory_order_relaxed);
       }
     }
+
+    for (std::uint32_t index : m_Ready) { dispatch_task(index); }
+
+    for (auto remaining = m_Remaining.load(); remaining != 0;
+         remaining      = m_Remaining.load()) {
+      m_Remaining.wait(remaining);
+    }
   }
 
   // Get task state by task ID
@@ -285,133 +573,160 @@ public:
     for (auto& [id, task] : m_Tasks) {
       task->set_state(TaskState::Pending);
     }
-    m_RunningTasks.clear();
-    m_CompletedTasks.clear();
   }
 
 private:
 
-  void validate_dag()
+  // Kahn's algorithm doubles as cycle detection: any task left out of the
+  // topological order sits on a cycle.
+  void compile_graph()
   {
-    std::unordered_set<std::string> visited_nodes, recursion_stack;
+    CompiledDag graph;
 
+    const auto task_count = static_cast<std::uint32_t>(m_Tasks.size());
+    std::unordered_map<std::string_view, std::uint32_t> indices;
+    indices.reserve(task_count);
+    graph.tasks.reserve(task_count);
     for (const auto& [id, task] : m_Tasks) {
-      if (!is_visited(visited_nodes, id)) {
-        if (has_cycle(id, visited_nodes, recursion_stack)) {
-          throw std::runtime_error("DAG contains cycles");
+      indices.emplace(id, static_cast<std::uint32_t>(graph.tasks.size()));
+      graph.tasks.push_back(task);
+    }
+
+    graph.in_degree.assign(task_count, 0);
+    graph.dependent_offsets.assign(task_count + 1, 0);
+    std::vector<std::uint32_t> dependency_indices;
+    for (std::uint32_t index = 0; index < task_count; ++index) {
+      for (const auto& dependency_id :
+           graph.tasks [index]->get_dependencies()) {
+        auto iterator = indices.find(dependency_id);
+        if (iterator == indices.end()) {
+          throw std::runtime_error(
+              std::format("Task '{}' depends on unknown task '{}'",
+                          graph.tasks [index]->get_id(), dependency_id));
         }
+        dependency_indices.push_back(iterator->second);
+        ++graph.dependent_offsets [iterator->second + 1];
+        ++graph.in_degree [index];
       }
     }
-  }
 
-  bool has_cycle(const std::string&               task_id,
-                 std::unordered_set<std::string>& visited_nodes,
-                 std::unordered_set<std::string>& recursion_stack)
-  {
-    if (!recursion_stack.insert(task_id).second) { return true; }
+    for (std::uint32_t index = 0; index < task_count; ++index) {
+      graph.dependent_offsets [index + 1] += graph.dependent_offsets [index];
+    }
 
-    auto task = m_Tasks.at(task_id);
-    for (const auto& dependency_id : task->get_dependencies()) {
-      if (!is_visited(visited_nodes, dependency_id)) {
-        if (has_cycle(dependency_id, visited_nodes, recursion_stack)) {
-          return true;
+    graph.dependents.resize(dependency_indices.size());
+    std::vector<std::uint32_t> cursor(graph.dependent_offsets.begin(),
+                                      graph.dependent_offsets.end() - 1);
+    for (std::uint32_t index = 0, edge = 0; index < task_count; ++index) {
+      for (std::uint32_t i = 0; i < graph.in_degree [index]; ++i, ++edge) {
+        graph.dependents [cursor [dependency_indices [edge]]++] = index;
+      }
+    }
+
+    graph.topological_order.reserve(task_count);
+    std::vector<std::uint32_t> remaining = graph.in_degree;
+    for (std::uint32_t index = 0; index < task_count; ++index) {
+      if (remaining [index] == 0) { graph.topological_order.push_back(index); }
+    }
+    graph.root_count =
+        static_cast<std::uint32_t>(graph.topological_order.size());
+    for (std::size_t head = 0; head < graph.topological_order.size(); ++head) {
+      for (std::uint32_t dependent :
+           graph.dependents_of(graph.topological_order [head])) {
+        if (--remaining [dependent] == 0) {
+          graph.topological_order.push_back(dependent);
         }
-      } else if (recursion_stack.contains(dependency_id)) {
-        return true;
       }
     }
+    if (graph.topological_order.size() != task_count) {
+      throw std::runtime_error("DAG contains cycles");
+    }
 
-    recursion_stack.erase(task_id);
-    visited_nodes.insert(task_id);
-    return false;
+    m_Graph     = std::move(graph);
+    m_Pending   = std::make_unique<std::atomic<std::uint32_t>[]>(task_count);
+    m_Cancelled = std::make_unique<std::atomic<bool>[]>(task_count);
+    m_Compiled  = true;
   }
 
-  bool is_visited(const std::unordered_set<std::string>& visited_nodes,
-                  const std::string&                     node_id)
+  // The lambda captures 12 bytes, small enough for std::function's inline
+  // storage, so dispatching never allocates.
+  void dispatch_task(std::uint32_t index)
   {
-    return visited_nodes.find(node_id) != visited_nodes.end();
+    m_Graph.tasks [index]->set_state(TaskState::Ready);
+    m_Executor->submit([this, index] { execute_task(index); });
   }
 
-  void build_execution_graph()
+  void execute_task(std::uint32_t index)
   {
-    m_InDegree.clear();
-    m_Dependents.clear();
+    TaskInterface& task = *m_Graph.tasks [index];
 
-    for (const auto& [id, task] : m_Tasks) {
-      m_InDegree [id] = task->get_dependencies().size();
-      for (const auto& dependency_id : task->get_dependencies()) {
-        m_Dependents [dependency_id].push_back(id);
-      }
+    // A failed dependency cancels the task; it stays Pending
+    if (m_Cancelled [index].load(std::memory_order_acquire)) {
+      task.set_state(TaskState::Pending);
+      on_task_finished(index, false);
+      return;
     }
-  }
 
-  std::vector<std::string> get_ready_tasks()
-  {
-    std::vector<std::string> ready_tasks;
-
-    for (const auto& [id, task] : m_Tasks) {
-      if (task->get_state() == TaskState::Pending && m_InDegree.at(id) == 0) {
-        ready_tasks.push_back(id);
-      }
+    bool succeeded = false;
+    try {
+      task.execute();
+      succeeded = true;
+    } catch (const std::exception& exception) {
+      std::cerr << std::format("Task '{}' failed: {}", task.get_id(),
+                               exception.what())
+                << std::endl;
+    } catch (...) {
+      std::cerr << std::format("Task '{}' failed: unknown exception",
+                               task.get_id())
+                << std::endl;
     }
 
-    return ready_tasks;
+    on_task_finished(index, succeeded);
   }
 
-  void execute_task(std::shared_ptr<TaskInterface> task)
+  // Runs on the thread that finished the task, so newly ready dependents are
+  // submitted from the worker and land on its local deque.
+  void on_task_finished(std::uint32_t index, bool succeeded)
   {
-    try {
-      task->execute();
-
-      std::lock_guard lock(m_Mutex);
-      m_CompletedTasks.insert(task->get_id());
-      m_RunningTasks.erase(task->get_id());
-
-      // Update dependent task in-degrees
-      if (auto iterator = m_Dependents.find(task->get_id());
-          iterator != m_Dependents.end()) {
-        for (const auto& dependent_id : iterator->second) {
-          --m_InDegree [dependent_id];
-        }
-      }
+    release_dependents(index, succeeded, [this](std::uint32_t dependent) {
+      dispatch_task(dependent);
+    });
 
-    } catch (const std::exception& exception) {
-      std::lock_guard lock(m_Mutex);
-      std::cerr << std::format("Task '{}' failed: {}", task->get_id(),
-                               exception.what())
-                << std::endl;
-      m_RunningTasks.erase(task->get_id());
+    if (m_Remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      m_Remaining.notify_all();
     }
   }
 
-  void wait_for_completion()
+  // Decrements the dependents' counters and hands every dependent that
+  // became ready to on_ready
+  template<typename ReadyCallback>
+  void release_dependents(std::uint32_t index, bool succeeded,
+                          ReadyCallback&& on_ready)
   {
-    for (auto iterator = m_RunningTasks.begin();
-         iterator != m_RunningTasks.end();) {
-      auto& [id, future] = *iterator;
-
-      if (future.wait_for(std::chrono::milliseconds(10)) ==
-          std::future_status::ready) {
-        try {
-          future.get();
-        } catch (...) {
-          // Exception already handled in execute_task
-        }
-        iterator = m_RunningTasks.erase(iterator);
-      } else {
-        ++iterator;
+    for (std::uint32_t dependent : m_Graph.dependents_of(index)) {
+      if (!succeeded) {
+        m_Cancelled [dependent].store(true, std::memory_order_release);
+      }
+      if (m_Pending [dependent].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        on_ready(dependent);
       }
     }
   }
 
-  std::unique_ptr<ThreadPoolExecutor>                             m_Executor;
+  std::unique_ptr<ExecutorType>                                   m_Executor;
   std::unordered_map<std::string, std::shared_ptr<TaskInterface>> m_Tasks;
-  std::unordered_map<std::string, int>                            m_InDegree;
-  std::unordered_map<std::string, std::vector<std::string>>       m_Dependents;
-  std::unordered_map<std::string, std::future<void>> m_RunningTasks;
-  std::unordered_set<std::string>                    m_CompletedTasks;
-  mutable std::mutex                                 m_Mutex;
+  CompiledDag                                                     m_Graph;
+  std::unique_ptr<std::atomic<std::uint32_t>[]>                   m_Pending;
+  std::unique_ptr<std::atomic<bool>[]>                            m_Cancelled;
+  std::vector<std::uint32_t>                                      m_Ready;
+  std::atomic<std::size_t>                                        m_Remaining;
+  bool                                                            m_Compiled = false;
+  mutable std::mutex                                              m_Mutex;
 };
+
+// The scheduler on the default executor, under the name it has always had.
+// Pick another executor with BasicDagScheduler<ThreadPoolExecutor>
+using DagScheduler = BasicDagScheduler<>;
 }  // namespace stdex
 
 /*
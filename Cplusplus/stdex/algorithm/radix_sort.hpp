@@ -1,14 +1,22 @@
 ﻿#pragma once
 #include <omp.h>
 
+#include <algorithm>
 #include <array>
 #include <bit>
 #include <cmath>
 #include <concepts>
+#include <cstring>
 #include <execution>
+#include <functional>
 #include <iterator>
+#include <limits>
 #include <memory>
+#include <numeric>
+#include <string_view>
+#include <tuple>
 #include <type_traits>
+#include <utility>
 
 #include "simd/simd_detect.hpp"
 
@@ -71,6 +79,47 @@ enum class NaNPosition
   AtEnd     // -inf -1 1 3.14 inf -nan(ind) nan
 };
 
+// Only affects the parallel overloads
+enum class ParallelMode
+{
+  //< Two parallel regions per pass, histograms reduced and scanned serially
+  PerPass,
+
+  //< Digits of every pass counted in one upfront read, one persistent
+  // parallel region with barriers between phases, prefix sums split across
+  // bucket slices
+  Fused
+};
+
+// Only affects LSD passes
+enum class ScatterMode
+{
+  //< Every element is stored straight to its bucket in the destination
+  Direct,
+
+  //< Elements are staged in one cache-line-sized buffer per bucket and whole
+  // lines are flushed (non-temporal stores with AVX). Only recommended for
+  // 256-bucket passes over large inputs, where the 16 KB staging area stays
+  // in L1; 65536-bucket passes ignore it and scatter directly, since a 4 MB
+  // staging area spills out of L2 and costs more than it saves. Needs
+  // trivially copyable elements whose size divides 32 bytes, other types
+  // fall back to Direct. The SIMD overloads compute digits with the scalar
+  // kernel in this mode
+  WriteCombining
+};
+
+enum class RadixAlgorithm
+{
+  //< Out-of-place least significant digit passes, stable, needs a second
+  // buffer as large as the input
+  LSD,
+
+  //< In-place most significant digit recursion (American flag sort), not
+  // stable, needs no buffer. Always uses 8-bit digits, Bucket_size and
+  // Parallel_mode are ignored
+  InPlaceMSD
+};
+
 template<typename T>
 struct identity_key_extractor
 {
@@ -110,6 +159,27 @@ struct function_key_extractor
   }
 };
 
+// One field of a composite key for radix_sort_by_fields. The extractor is
+// anything std::invoke accepts (member pointer, lambda, function object)
+// and must yield an arithmetic value.
+template<typename Extractor, SortOrder Order_v, HasNegative Has_negative_v>
+struct key_field
+{
+  static constexpr SortOrder   order        = Order_v;
+  static constexpr HasNegative has_negative = Has_negative_v;
+
+  Extractor extractor;
+};
+
+template<SortOrder   Order        = SortOrder::Ascending,
+         HasNegative Has_negative = HasNegative::Yes, typename Extractor>
+constexpr auto make_key_field(Extractor&& extractor)
+{
+  return key_field<std::decay_t<Extractor>, Order, Has_negative> {
+    std::forward<Extractor>(extractor)
+  };
+}
+
 using Bucket_size_t    = std::uint32_t;
 using Dataset_size32_t = std::uint32_t;
 using Dataset_size64_t = std::uint64_t;
@@ -181,10 +251,13 @@ struct Radix_template_params
 {
   using Key_extractor_t = KeyExtractor;
   using Dataset_size_t  = DatasetSize;
-  Bucket_size_t Bucket_size { 256U };
-  SortOrder     Order { SortOrder::Ascending };
-  HasNegative   Has_negative { HasNegative::Yes };
-  NaNPosition   NaN_position { NaNPosition::Unhandled };
+  Bucket_size_t  Bucket_size { 256U };
+  SortOrder      Order { SortOrder::Ascending };
+  HasNegative    Has_negative { HasNegative::Yes };
+  NaNPosition    NaN_position { NaNPosition::Unhandled };
+  ParallelMode   Parallel_mode { ParallelMode::PerPass };
+  RadixAlgorithm Algorithm { RadixAlgorithm::LSD };
+  ScatterMode    Scatter_mode { ScatterMode::Direct };
 };
 
 namespace details {
@@ -241,6 +314,98 @@ ALWAYS_INLINE void Adl_count_buckets(Size_t Start_idx, Size_t End_idx,
   }
 }
 
+// Staging area for ScatterMode::WriteCombining. Each bucket owns one 64-byte
+// line; elements are copied into the slot they will occupy in the destination
+// line, and the line is written out once the destination crosses a line
+// boundary. Complete, aligned lines go out with streaming stores so they do
+// not evict the source from the cache; the partial lines at the edges of a
+// bucket are copied normally, which keeps neighbouring threads' ranges intact.
+template<typename Value_t, typename Size_t, std::size_t Bucket_size>
+class Write_combining_buffer
+{
+public:
+  static constexpr std::size_t Line_size = 64;
+  static constexpr std::size_t Elements_per_line =
+      std::max<std::size_t>(Line_size / sizeof(Value_t), 1);
+
+  static constexpr bool Is_supported = std::is_trivially_copyable_v<Value_t> &&
+      sizeof(Value_t) <= Line_size / 2 && Line_size % sizeof(Value_t) == 0;
+
+  Write_combining_buffer(Value_t* Dst, const Size_t* Scanned_offsets)
+      : m_Dst(Dst)
+      , m_Lines(new Line_t [Bucket_size])
+      , m_Line_begin(new Size_t [Bucket_size])
+  {
+    const auto Address = reinterpret_cast<std::uintptr_t>(Dst);
+    // Slots only line up with cache lines when no element straddles one
+    m_Is_aligned = Address % sizeof(Value_t) == 0;
+    m_Base_slot  = m_Is_aligned ? (Address % Line_size) / sizeof(Value_t) : 0;
+    std::copy(Scanned_offsets, Scanned_offsets + Bucket_size,
+              m_Line_begin.get());
+  }
+
+  ALWAYS_INLINE void push(std::size_t Bucket, Size_t& Offset,
+                          const Value_t& Value)
+  {
+    const Size_t      Idx  = Offset++;
+    const std::size_t Slot = slot_of(Idx);
+    std::memcpy(m_Lines [Bucket].Bytes + Slot * sizeof(Value_t), &Value,
+                sizeof(Value_t));
+    if (Slot == Elements_per_line - 1) flush_line(Bucket, Offset);
+  }
+
+  // Writes out every partially filled line
+  void finish(const Size_t* Scanned_offsets)
+  {
+    for (std::size_t Bucket = 0; Bucket < Bucket_size; ++Bucket) {
+      if (Scanned_offsets [Bucket] != m_Line_begin [Bucket])
+        flush_line(Bucket, Scanned_offsets [Bucket]);
+    }
+#if defined(__AVX2__) || defined(__AVX__)
+    _mm_sfence();
+#endif
+  }
+
+private:
+  struct alignas(Line_size) Line_t
+  {
+    std::byte Bytes [Line_size];
+  };
+
+  ALWAYS_INLINE std::size_t slot_of(Size_t Idx) const noexcept
+  {
+    return (m_Base_slot + Idx) & (Elements_per_line - 1);
+  }
+
+  ALWAYS_INLINE void flush_line(std::size_t Bucket, Size_t End_idx)
+  {
+    const Size_t     Begin_idx = m_Line_begin [Bucket];
+    const Size_t     Count     = End_idx - Begin_idx;
+    const std::byte* Line      = m_Lines [Bucket].Bytes;
+    Value_t*         Dst       = m_Dst + Begin_idx;
+
+#if defined(__AVX2__) || defined(__AVX__)
+    if (Count == Elements_per_line && m_Is_aligned) {
+      auto* Dst_vec = reinterpret_cast<__m256i*>(Dst);
+      auto* Src_vec = reinterpret_cast<const __m256i*>(Line);
+      _mm256_stream_si256(Dst_vec, _mm256_load_si256(Src_vec));
+      _mm256_stream_si256(Dst_vec + 1, _mm256_load_si256(Src_vec + 1));
+      m_Line_begin [Bucket] = End_idx;
+      return;
+    }
+#endif
+    std::memcpy(Dst, Line + slot_of(Begin_idx) * sizeof(Value_t),
+                Count * sizeof(Value_t));
+    m_Line_begin [Bucket] = End_idx;
+  }
+
+  Value_t*                   m_Dst;
+  std::unique_ptr<Line_t []> m_Lines;
+  std::unique_ptr<Size_t []> m_Line_begin;
+  std::size_t                m_Base_slot { 0 };
+  bool                       m_Is_aligned { false };
+};
+
 template<typename Size_t, typename Value_t, typename Key_extractor_t,
          typename Radix_cp, auto Radix_tp, bool Is_last_pass>
 ALWAYS_INLINE void Adl_distribute_to_buckets(
@@ -251,6 +416,17 @@ ALWAYS_INLINE void Adl_distribute_to_buckets(
   using Key_t      = std::decay_t<decltype(Extractor(std::declval<Value_t>()))>;
   using Unsigned_t = typename Radix_cp::Unsigned_t;
 
+  using Wc_buffer_t =
+      Write_combining_buffer<Value_t, Size_t, Radix_tp.Bucket_size>;
+  constexpr bool Use_write_combining =
+      Radix_tp.Scatter_mode == ScatterMode::WriteCombining &&
+      Radix_tp.Bucket_size == 256U && Wc_buffer_t::Is_supported;
+
+  [[maybe_unused]] std::unique_ptr<Wc_buffer_t> Wc_buffer;
+  if constexpr (Use_write_combining) {
+    Wc_buffer = std::make_unique<Wc_buffer_t>(Dst, Scanned_offsets);
+  }
+
   LOOP_UNROLL(8) for (Size_t Idx = Start_idx; Idx < End_idx; ++Idx)
   {
     auto& Value = Src [Idx];
@@ -292,10 +468,89 @@ ALWAYS_INLINE void Adl_distribute_to_buckets(
 
     if constexpr (Radix_tp.Order == SortOrder::Descending)
       Byte_idx = Radix_cp::Mask - Byte_idx;
-    Dst [Scanned_offsets [Byte_idx]++] = std::move(Value);
+
+    if constexpr (Use_write_combining) {
+      Wc_buffer->push(Byte_idx, Scanned_offsets [Byte_idx], Value);
+    } else {
+      Dst [Scanned_offsets [Byte_idx]++] = std::move(Value);
+    }
+  }
+
+  if constexpr (Use_write_combining) { Wc_buffer->finish(Scanned_offsets); }
+}
+
+// Counts the digits of every pass in one read of [Start_idx, End_idx).
+// Bucket_counts is laid out as [Pass][Bucket]. Every pass can share the
+// fully normalised key because the sign fix-up only touches the top digit.
+template<typename Size_t, typename Value_t, typename Key_extractor_t,
+         typename Radix_cp, auto Radix_tp>
+ALWAYS_INLINE void Adl_count_all_passes(Size_t Start_idx, Size_t End_idx,
+                                        const Value_t* __restrict Src,
+                                        Size_t* __restrict Bucket_counts,
+                                        const Key_extractor_t&   Extractor,
+                                        [[maybe_unused]] Size_t* NaN_count)
+{
+  using Key_t      = std::decay_t<decltype(Extractor(std::declval<Value_t>()))>;
+  using Unsigned_t = typename Radix_cp::Unsigned_t;
+
+  constexpr std::uint8_t Last_pass = Radix_cp::Passes - 1;
+
+  for (Size_t Idx = Start_idx; Idx < End_idx; ++Idx) {
+    auto Key = Extractor(Src [Idx]);
+
+    [[maybe_unused]] bool Is_nan = false;
+    if constexpr (std::is_floating_point_v<Key_t> &&
+                  Radix_tp.NaN_position != NaNPosition::Unhandled) {
+      if (std::isnan(Key)) [[unlikely]] {
+        ++*NaN_count;
+        Is_nan = true;
+      }
+    }
+
+    Unsigned_t Unsigned_value = std::bit_cast<Unsigned_t>(Key);
+
+    if constexpr (std::is_floating_point_v<Key_t> &&
+                  Radix_tp.Has_negative == HasNegative::Yes) {
+      Unsigned_value ^= ((Unsigned_value >> Radix_cp::Shift_of_sign_bit) == 0)
+          ? Radix_cp::Sign_bit_mask
+          : Radix_cp::All_bits_mask;
+    } else if constexpr (std::is_integral_v<Key_t> &&
+                         Radix_tp.Has_negative == HasNegative::Yes) {
+      Unsigned_value ^= Radix_cp::Sign_bit_mask;
+    }
+
+    LOOP_UNROLL(8) for (std::uint8_t Pass = 0; Pass < Radix_cp::Passes; ++Pass)
+    {
+      if constexpr (std::is_floating_point_v<Key_t> &&
+                    Radix_tp.NaN_position != NaNPosition::Unhandled) {
+        // NaNs get their own slot in the last pass only
+        if (Pass == Last_pass && Is_nan) break;
+      }
+
+      std::uint16_t Byte_idx =
+          (Unsigned_value >> (Pass << Radix_cp::Shift_of_byte_idx)) &
+          Radix_cp::Mask;
+
+      if constexpr (Radix_tp.Order == SortOrder::Descending)
+        Byte_idx = Radix_cp::Mask - Byte_idx;
+
+      ++Bucket_counts [Pass * Radix_tp.Bucket_size + Byte_idx];
+    }
   }
 }
 
+// A pass is trivial when every key lands in the same bucket: the scatter would
+// be an identity permutation, so the pass (and its buffer swap) can be skipped.
+// NaNs are excluded from the last pass histogram, so that pass is never
+// trivial while NaNs still need to be moved.
+template<typename Size_t>
+ALWAYS_INLINE bool Adl_is_trivial_pass(const Size_t* Bucket_counts,
+                                       std::size_t Bucket_size, Size_t Size)
+{
+  return std::find(Bucket_counts, Bucket_counts + Bucket_size, Size) !=
+      Bucket_counts + Bucket_size;
+}
+
 template<typename T>
 struct SIMD_type_traits;
 
@@ -404,6 +659,15 @@ ALWAYS_INLINE void Adl_count_buckets_avx2_impl(
 
     if constexpr (std::is_same_v<Value_t, Key_t>) {
       keys = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Src + Idx));
+      if constexpr (Is_last_pass &&
+                    Radix_tp.NaN_position != NaNPosition::Unhandled) {
+        for (Size_t i = 0; i < simd_width; ++i) {
+          if (std::isnan(Src [Idx + i])) [[unlikely]] {
+            ++NaN_counts [Thread_id];
+            is_nan [i] = true;
+          }
+        }
+      }
     } else {
       alignas(32) Unsigned_t keys_arr [simd_width];
       if constexpr (Is_last_pass &&
@@ -899,6 +1163,15 @@ ALWAYS_INLINE void Adl_count_buckets_neon_impl(
       } else {
         keys = vld1q_u64(reinterpret_cast<const uint64_t*>(Src + Idx));
       }
+      if constexpr (Is_last_pass &&
+                    Radix_tp.NaN_position != NaNPosition::Unhandled) {
+        for (Size_t i = 0; i < simd_width; ++i) {
+          if (std::isnan(Src [Idx + i])) [[unlikely]] {
+            ++NaN_counts [Thread_id];
+            is_nan [i] = true;
+          }
+        }
+      }
     } else {
       alignas(16) Unsigned_t keys_arr [simd_width];
       if constexpr (Is_last_pass &&
@@ -1049,6 +1322,15 @@ ALWAYS_INLINE void Adl_distribute_to_buckets_simd(
     const Key_extractor_t& Extractor, [[maybe_unused]] Size_t Thread_NaN_offset)
 {
   using Unsigned_t = typename Radix_cp::Unsigned_t;
+  if constexpr (Radix_tp.Scatter_mode == ScatterMode::WriteCombining &&
+                Radix_tp.Bucket_size == 256U) {
+    // The staging buffer replaces the vector scatter
+    Adl_distribute_to_buckets<Size_t, Value_t, Key_extractor_t, Radix_cp,
+                              Radix_tp, Is_last_pass>(
+        Start_idx, End_idx, Pass, Src, Dst, Scanned_offsets, Extractor,
+        Thread_NaN_offset);
+    return;
+  }
 #if defined(__AVX2__) || defined(__AVX__)
   Adl_distribute_to_buckets_avx2_impl<Size_t, Value_t, Key_extractor_t, Radix_cp,
                                       Radix_tp, Is_last_pass>(
@@ -1065,6 +1347,18 @@ ALWAYS_INLINE void Adl_distribute_to_buckets_simd(
 }  // namespace details
 
 namespace details {
+template<typename Key_extractor_t, typename Key_t>
+consteval auto Adl_default_radix_params_for()
+{
+  if constexpr (std::unsigned_integral<Key_t>) {
+    return Radix_template_params<Key_extractor_t, Dataset_size32_t> {
+      .Has_negative = HasNegative::No
+    };
+  } else {
+    return Radix_template_params<Key_extractor_t, Dataset_size32_t> {};
+  }
+}
+
 template<typename ContigIter>
 consteval auto Adl_default_radix_params()
 {
@@ -1073,31 +1367,222 @@ consteval auto Adl_default_radix_params()
   using Key_t           = std::decay_t<decltype(Key_extractor_t {}.operator() (
       std::declval<Value_t>()))>;
 
-  if constexpr (std::unsigned_integral<Key_t>) {
-    return Radix_template_params<Key_extractor_t, Dataset_size32_t> {
-      .Has_negative = HasNegative::No
+  return Adl_default_radix_params_for<Key_extractor_t, Key_t>();
+}
+
+// The same parameters for a different key extractor
+template<typename Key_extractor_t, typename Radix_params_t>
+constexpr auto Adl_rebind_radix_params(const Radix_params_t& Radix_tp)
+{
+  Radix_template_params<Key_extractor_t, typename Radix_params_t::Dataset_size_t>
+      New_params {};
+  New_params.Bucket_size   = Radix_tp.Bucket_size;
+  New_params.Order         = Radix_tp.Order;
+  New_params.Has_negative  = Radix_tp.Has_negative;
+  New_params.NaN_position  = Radix_tp.NaN_position;
+  New_params.Parallel_mode = Radix_tp.Parallel_mode;
+  New_params.Algorithm     = Radix_tp.Algorithm;
+  New_params.Scatter_mode  = Radix_tp.Scatter_mode;
+  return New_params;
+}
+
+// Key bits rearranged so that unsigned integer order is the requested sort
+// order, the same normalisation the LSD kernels apply across their passes
+template<typename Radix_cp, auto Radix_tp, typename Key_t>
+ALWAYS_INLINE typename Radix_cp::Unsigned_t Adl_normalized_key(Key_t Key) noexcept
+{
+  using Unsigned_t = typename Radix_cp::Unsigned_t;
+
+  Unsigned_t Unsigned_value = std::bit_cast<Unsigned_t>(Key);
+
+  if constexpr (std::is_floating_point_v<Key_t> &&
+                Radix_tp.Has_negative == HasNegative::Yes) {
+    Unsigned_value ^= ((Unsigned_value >> Radix_cp::Shift_of_sign_bit) == 0)
+        ? Radix_cp::Sign_bit_mask
+        : Radix_cp::All_bits_mask;
+  } else if constexpr (std::is_integral_v<Key_t> &&
+                       Radix_tp.Has_negative == HasNegative::Yes) {
+    Unsigned_value ^= Radix_cp::Sign_bit_mask;
+  }
+
+  if constexpr (Radix_tp.Order == SortOrder::Descending)
+    Unsigned_value = static_cast<Unsigned_t>(~Unsigned_value);
+
+  return Unsigned_value;
+}
+
+// Buckets at or below this size are finished with insertion sort
+inline constexpr std::size_t Msd_insertion_sort_threshold = 32;
+// Buckets at or above this size become their own OpenMP task
+inline constexpr std::size_t Msd_task_threshold = 1U << 14;
+
+template<typename Size_t, typename Value_t, typename Key_extractor_t,
+         typename Radix_cp, auto Radix_tp>
+void Adl_insertion_sort_by_key(Value_t* Start, Size_t Size,
+                               const Key_extractor_t& Extractor)
+{
+  for (Size_t I = 1; I < Size; ++I) {
+    Value_t    Value = std::move(Start [I]);
+    const auto Key = Adl_normalized_key<Radix_cp, Radix_tp>(Extractor(Value));
+
+    Size_t J = I;
+    for (; J > 0 &&
+         Key < Adl_normalized_key<Radix_cp, Radix_tp>(Extractor(Start [J - 1]));
+         --J) {
+      Start [J] = std::move(Start [J - 1]);
+    }
+    Start [J] = std::move(Value);
+  }
+}
+
+// Moves every element of Start into its bucket given the bucket histogram.
+// Cycle leader permutation: pick up the element at the head of the bucket and
+// keep swapping it into the head of its own bucket until an element that
+// belongs here comes back.
+template<typename Value_t, typename Size_t, std::size_t Bucket_size,
+         typename Digit_func_t>
+void Adl_american_flag_permute(Value_t* Start,
+                               const std::array<Size_t, Bucket_size>& Bucket_counts,
+                               const Digit_func_t& Func_get_digit)
+{
+  std::array<Size_t, Bucket_size> Heads;
+  std::array<Size_t, Bucket_size> Tails;
+  std::exclusive_scan(Bucket_counts.begin(), Bucket_counts.end(), Heads.begin(),
+                      Size_t { 0 }, std::plus<> {});
+  for (std::size_t Bucket = 0; Bucket < Bucket_size; ++Bucket) {
+    Tails [Bucket] = Heads [Bucket] + Bucket_counts [Bucket];
+  }
+
+  for (std::size_t Bucket = 0; Bucket < Bucket_size; ++Bucket) {
+    while (Heads [Bucket] < Tails [Bucket]) {
+      Value_t     Value = std::move(Start [Heads [Bucket]]);
+      std::size_t Digit = Func_get_digit(Value);
+      while (Digit != Bucket) {
+        std::swap(Value, Start [Heads [Digit]++]);
+        Digit = Func_get_digit(Value);
+      }
+      Start [Heads [Bucket]++] = std::move(Value);
+    }
+  }
+}
+
+// American flag sort of [Start, Start + Size) on the byte at Level (0 is the
+// most significant). Elements are cycled into their buckets by swapping, so
+// no buffer is needed; every bucket is then sorted on the next byte. Levels
+// where every key shares the same byte are skipped without moving anything.
+template<typename Size_t, typename Value_t, typename Key_extractor_t,
+         typename Radix_cp, auto Radix_tp, bool Parallel>
+void Adl_american_flag_sort(Value_t* Start, Size_t Size, std::uint8_t Level,
+                            const Key_extractor_t& Extractor)
+{
+  constexpr std::size_t Bucket_size = 256;
+
+  for (;; ++Level) {
+    if (Size <= Msd_insertion_sort_threshold) {
+      Adl_insertion_sort_by_key<Size_t, Value_t, Key_extractor_t, Radix_cp,
+                                Radix_tp>(Start, Size, Extractor);
+      return;
+    }
+
+    const std::uint8_t Shift = (Radix_cp::Passes - 1 - Level) << 3;
+    auto Func_get_digit = [&](const Value_t& Value) -> std::uint8_t {
+      return static_cast<std::uint8_t>(
+          Adl_normalized_key<Radix_cp, Radix_tp>(Extractor(Value)) >> Shift);
     };
-  } else {
-    return Radix_template_params<Key_extractor_t, Dataset_size32_t> {};
+
+    std::array<Size_t, Bucket_size> Bucket_counts {};
+    for (Size_t Idx = 0; Idx < Size; ++Idx) {
+      ++Bucket_counts [Func_get_digit(Start [Idx])];
+    }
+
+    const bool Is_last_level = Level + 1 == Radix_cp::Passes;
+    if (Adl_is_trivial_pass(Bucket_counts.data(), Bucket_size, Size)) {
+      if (Is_last_level) return;
+      continue;
+    }
+
+    Adl_american_flag_permute(Start, Bucket_counts, Func_get_digit);
+
+    if (Is_last_level) return;
+
+    Value_t* Bucket_ptr = Start;
+    for (std::size_t Bucket = 0; Bucket < Bucket_size; ++Bucket) {
+      const Size_t Count = Bucket_counts [Bucket];
+      if (Count > 1) {
+        if constexpr (Parallel) {
+#pragma omp task if (Count >= Msd_task_threshold) firstprivate(Bucket_ptr, Count)
+          Adl_american_flag_sort<Size_t, Value_t, Key_extractor_t, Radix_cp,
+                                 Radix_tp, Parallel>(Bucket_ptr, Count,
+                                                     Level + 1, Extractor);
+        } else {
+          Adl_american_flag_sort<Size_t, Value_t, Key_extractor_t, Radix_cp,
+                                 Radix_tp, Parallel>(Bucket_ptr, Count,
+                                                     Level + 1, Extractor);
+        }
+      }
+      Bucket_ptr += Count;
+    }
+    return;
   }
 }
 
+// RadixAlgorithm::InPlaceMSD driver shared by all overloads. NaNs (when
+// handled) are partitioned to their end first, the rest is sorted by the
+// American flag recursion. The parallel version splits the top level
+// sequentially and hands large buckets to OpenMP tasks.
+template<typename Size_t, typename Value_t, typename Key_extractor_t,
+         auto Radix_tp, bool Parallel>
+void Adl_radix_sort_msd_inplace(Value_t* Start_ptr, Size_t Size,
+                                const Key_extractor_t& Extractor)
+{
+  using Key_t    = std::decay_t<decltype(Extractor(std::declval<Value_t>()))>;
+  using Radix_cp = Radix_constexpr_params<Key_t, 256U>;
+
+  if constexpr (std::is_floating_point_v<Key_t> &&
+                Radix_tp.NaN_position != NaNPosition::Unhandled) {
+    auto Func_is_nan = [&](const Value_t& Value) {
+      return std::isnan(Extractor(Value));
+    };
+    if constexpr (Radix_tp.NaN_position == NaNPosition::AtStart) {
+      Value_t* Numbers = std::partition(Start_ptr, Start_ptr + Size, Func_is_nan);
+      Size -= static_cast<Size_t>(Numbers - Start_ptr);
+      Start_ptr = Numbers;
+    } else {
+      Value_t* NaNs = std::partition(Start_ptr, Start_ptr + Size,
+                                     std::not_fn(Func_is_nan));
+      Size = static_cast<Size_t>(NaNs - Start_ptr);
+    }
+  }
+
+  if constexpr (Parallel) {
+    if (Size >= Msd_task_threshold) {
+#pragma omp parallel num_threads(omp_get_num_procs())
+#pragma omp single
+      Adl_american_flag_sort<Size_t, Value_t, Key_extractor_t, Radix_cp,
+                             Radix_tp, true>(Start_ptr, Size, 0, Extractor);
+      return;
+    }
+  }
+  Adl_american_flag_sort<Size_t, Value_t, Key_extractor_t, Radix_cp, Radix_tp,
+                         false>(Start_ptr, Size, 0, Extractor);
+}
+
 template<ContiguousIterator ContigIter,
          auto Radix_tp = details::Adl_default_radix_params<ContigIter>()>
 void radix_sort_impl(std::execution::sequenced_policy, ContigIter First,
-                     ContigIter Last)
+                     ContigIter Last,
+                     const typename decltype(Radix_tp)::Key_extractor_t& Extractor = {})
 {
   static_assert(is_valid_bucket_size<Radix_tp.Bucket_size>,
                 "Bucket size must be 256 or 65536");
 
   using Value_t         = typename std::iterator_traits<ContigIter>::value_type;
   using Key_extractor_t = typename decltype(Radix_tp)::Key_extractor_t;
-  Key_extractor_t Extractor {};
   using Key_t = std::decay_t<decltype(Extractor(std::declval<Value_t>()))>;
 
   static_assert(
       ArithmeticKey<Key_t>,
-      "Key type must be arithmetic (excluding bool and character types)");
+      "Key type must be arithmetic (excluding bool)");
 
   static_assert(!(sizeof(Key_t) == 1 && Radix_tp.Bucket_size == 65536U),
                 "Cannot use 65536 bucket size with 1-byte key type");
@@ -1121,7 +1606,21 @@ void radix_sort_impl(std::execution::sequenced_policy, ContigIter First,
 
   using Radix_cp = Radix_constexpr_params<Key_t, Radix_tp.Bucket_size>;
 
-  /*static */ std::array<Size_t, Radix_tp.Bucket_size> Bucket_counts {};
+  if constexpr (Radix_tp.Algorithm == RadixAlgorithm::InPlaceMSD) {
+    Adl_radix_sort_msd_inplace<Size_t, Value_t, Key_extractor_t, Radix_tp,
+                               false>(Start_ptr, Size, Extractor);
+    return;
+  }
+
+  constexpr bool Handle_NaN = std::is_floating_point_v<Key_t> &&
+      Radix_tp.NaN_position != NaNPosition::Unhandled;
+  [[maybe_unused]] Size_t NaN_count = 0;
+
+  // The histogram of a digit does not depend on the element order, so every
+  // pass is counted in one read up front. That makes trivial passes free: they
+  // are skipped without touching the data again.
+  std::unique_ptr<Size_t []> Bucket_counts(
+      new Size_t [Radix_cp::Passes * Radix_tp.Bucket_size] {});
   /*static */ std::array<Size_t, Radix_tp.Bucket_size> Scanned_offsets;
 
   // Do not use std::make_unique, We need a pod type that is not initialized
@@ -1134,19 +1633,20 @@ void radix_sort_impl(std::execution::sequenced_policy, ContigIter First,
   Value_t* Dst = Buffer.get();
 #endif
 
+  Adl_count_all_passes<Size_t, Value_t, Key_extractor_t, Radix_cp, Radix_tp>(
+      /*Start_idx     */ 0,
+      /*End_idx       */ Size,
+      /*Src           */ Src,
+      /*Bucket_counts */ Bucket_counts.get(),
+      /*Extractor     */ Extractor,
+      /*NaN_count     */ Handle_NaN ? &NaN_count : nullptr);
+
   for (std::uint8_t Pass = 0; Pass < Radix_cp::Passes - 1; ++Pass) {
-    Adl_count_buckets<Size_t, Value_t, Key_extractor_t, Radix_cp, Radix_tp,
-                      false>(
-        /*Start_idx     */ 0,
-        /*End_idx       */ Size,
-        /*Pass          */ Pass,
-        /*Src           */ Src,
-        /*Bucket_counts */ Bucket_counts.data(),
-        /*Extractor     */ Extractor,
-        /*NaN_counts    */ nullptr,
-        /*Thread_id     */ 0);
+    const Size_t* Pass_counts =
+        Bucket_counts.get() + Pass * Radix_tp.Bucket_size;
+    if (Adl_is_trivial_pass(Pass_counts, Radix_tp.Bucket_size, Size)) continue;
 
-    std::exclusive_scan(Bucket_counts.begin(), Bucket_counts.end(),
+    std::exclusive_scan(Pass_counts, Pass_counts + Radix_tp.Bucket_size,
                         Scanned_offsets.begin(), 0, std::plus<> {});
 
     Adl_distribute_to_buckets<Size_t, Value_t, Key_extractor_t, Radix_cp,
@@ -1160,32 +1660,24 @@ void radix_sort_impl(std::execution::sequenced_policy, ContigIter First,
         /*Extractor       */ Extractor,
         /*Thread_NaN_offset       */ 0);
     std::swap(Src, Dst);
-
-    std::fill(Bucket_counts.begin(), Bucket_counts.end(), 0);
   }
 
   // Handle the sign bit of the last round
   //        ^^^^^^^^^^^^
 
-  constexpr bool Handle_NaN = std::is_floating_point_v<Key_t> &&
-      Radix_tp.NaN_position != NaNPosition::Unhandled;
-  [[maybe_unused]] std::array<Size_t, Handle_NaN ? 1 : 0> NaN_counts {};
+  const Size_t* Last_counts =
+      Bucket_counts.get() + (Radix_cp::Passes - 1) * Radix_tp.Bucket_size;
 
-  Adl_count_buckets<Size_t, Value_t, Key_extractor_t, Radix_cp, Radix_tp, true>(
-      /*Start_idx     */ 0,
-      /*End_idx       */ Size,
-      /*Pass          */ Radix_cp::Passes - 1,
-      /*Src           */ Src,
-      /*Bucket_counts */ Bucket_counts.data(),
-      /*Extractor     */ Extractor,
-      /*NaN_counts    */ Handle_NaN ? NaN_counts.data() : nullptr,
-      /*Thread_id     */ 0);
+  if (Adl_is_trivial_pass(Last_counts, Radix_tp.Bucket_size, Size)) {
+    if (Src != Start_ptr) std::move(Src, Src + Size, Start_ptr);
+    return;
+  }
 
   if constexpr (Radix_tp.NaN_position == NaNPosition::AtStart && Handle_NaN) {
-    std::exclusive_scan(Bucket_counts.begin(), Bucket_counts.end(),
-                        Scanned_offsets.begin(), NaN_counts [0], std::plus<> {});
+    std::exclusive_scan(Last_counts, Last_counts + Radix_tp.Bucket_size,
+                        Scanned_offsets.begin(), NaN_count, std::plus<> {});
   } else {
-    std::exclusive_scan(Bucket_counts.begin(), Bucket_counts.end(),
+    std::exclusive_scan(Last_counts, Last_counts + Radix_tp.Bucket_size,
                         Scanned_offsets.begin(), 0, std::plus<> {});
   }
 
@@ -1196,9 +1688,9 @@ void radix_sort_impl(std::execution::sequenced_policy, ContigIter First,
   [[maybe_unused]] Size_t Thread_NaN_offset = 0;
   if constexpr (Handle_NaN) {
     if constexpr (Radix_tp.NaN_position == NaNPosition::AtStart) {
-      Thread_NaN_offset = NaN_counts [0];
+      Thread_NaN_offset = NaN_count;
     } else if constexpr (Radix_tp.NaN_position == NaNPosition::AtEnd) {
-      Thread_NaN_offset = Size - NaN_counts [0];
+      Thread_NaN_offset = Size - NaN_count;
     }
   }
 
@@ -1214,13 +1706,15 @@ void radix_sort_impl(std::execution::sequenced_policy, ContigIter First,
       /*Thread_NaN_offset */ Handle_NaN ? Thread_NaN_offset : 0);
   std::swap(Src, Dst);
 
-  if constexpr (Radix_cp::Passes & 1) std::move(Src, Src + Size, Start_ptr);
+  // Skipped passes break the parity of the buffer swaps
+  if (Src != Start_ptr) std::move(Src, Src + Size, Start_ptr);
 }
 
 template<ContiguousIterator ContigIter,
          auto Radix_tp = details::Adl_default_radix_params<ContigIter>()>
 void radix_sort_impl(std::execution::unsequenced_policy, ContigIter First,
-                     ContigIter Last)
+                     ContigIter Last,
+                     const typename decltype(Radix_tp)::Key_extractor_t& Extractor = {})
 {
 #if defined(__AVX2__) || defined(__ARM_NEON) || defined(__aarch64__)
   static_assert(is_valid_bucket_size<Radix_tp.Bucket_size>,
@@ -1228,12 +1722,11 @@ void radix_sort_impl(std::execution::unsequenced_policy, ContigIter First,
 
   using Value_t         = typename std::iterator_traits<ContigIter>::value_type;
   using Key_extractor_t = typename decltype(Radix_tp)::Key_extractor_t;
-  Key_extractor_t Extractor {};
   using Key_t = std::decay_t<decltype(Extractor(std::declval<Value_t>()))>;
 
   static_assert(
       ArithmeticKey<Key_t>,
-      "Key type must be arithmetic (excluding bool and character types)");
+      "Key type must be arithmetic (excluding bool)");
 
   static_assert(!(sizeof(Key_t) == 1 && Radix_tp.Bucket_size == 65536U),
                 "Cannot use 65536 bucket size with 1-byte key type");
@@ -1257,6 +1750,12 @@ void radix_sort_impl(std::execution::unsequenced_policy, ContigIter First,
 
   using Radix_cp = Radix_constexpr_params<Key_t, Radix_tp.Bucket_size>;
 
+  if constexpr (Radix_tp.Algorithm == RadixAlgorithm::InPlaceMSD) {
+    Adl_radix_sort_msd_inplace<Size_t, Value_t, Key_extractor_t, Radix_tp,
+                               false>(Start_ptr, Size, Extractor);
+    return;
+  }
+
   std::array<Size_t, Radix_tp.Bucket_size> Bucket_counts {};
   std::array<Size_t, Radix_tp.Bucket_size> Scanned_offsets;
 
@@ -1281,6 +1780,11 @@ void radix_sort_impl(std::execution::unsequenced_policy, ContigIter First,
         /*NaN_counts    */ nullptr,
         /*Thread_id     */ 0);
 
+    if (Adl_is_trivial_pass(Bucket_counts.data(), Radix_tp.Bucket_size, Size)) {
+      std::fill(Bucket_counts.begin(), Bucket_counts.end(), 0);
+      continue;
+    }
+
     std::exclusive_scan(Bucket_counts.begin(), Bucket_counts.end(),
                         Scanned_offsets.begin(), 0, std::plus<> {});
 
@@ -1314,6 +1818,11 @@ void radix_sort_impl(std::execution::unsequenced_policy, ContigIter First,
       /*NaN_counts    */ Handle_NaN ? NaN_counts.data() : nullptr,
       /*Thread_id     */ 0);
 
+  if (Adl_is_trivial_pass(Bucket_counts.data(), Radix_tp.Bucket_size, Size)) {
+    if (Src != Start_ptr) std::move(Src, Src + Size, Start_ptr);
+    return;
+  }
+
   if constexpr (Radix_tp.NaN_position == NaNPosition::AtStart && Handle_NaN) {
     std::exclusive_scan(Bucket_counts.begin(), Bucket_counts.end(),
                         Scanned_offsets.begin(), NaN_counts [0], std::plus<> {});
@@ -1343,28 +1852,275 @@ void radix_sort_impl(std::execution::unsequenced_policy, ContigIter First,
       /*Thread_NaN_offset */ Handle_NaN ? Thread_NaN_offset : 0);
   std::swap(Src, Dst);
 
-  if constexpr (Radix_cp::Passes & 1) std::move(Src, Src + Size, Start_ptr);
+  // Skipped passes break the parity of the buffer swaps
+  if (Src != Start_ptr) std::move(Src, Src + Size, Start_ptr);
 #else
-  radix_sort_impl(std::execution::seq, First, Last);
+  radix_sort_impl<ContigIter, Radix_tp>(std::execution::seq, First, Last,
+                                        Extractor);
 #endif
 }
 
+// ParallelMode::Fused driver shared by the par and par_unseq overloads.
+// Phases inside the single parallel region, separated by barriers:
+//   0. every thread counts the digits of all passes for its chunk in one read
+//   1. global histograms are reduced and exclusive-scanned per bucket slice
+//   per pass:
+//   2. recount the thread's chunk once an earlier pass has moved the data
+//   3. per-thread offsets for the thread's own bucket slice
+//   4. scatter
+// Passes whose upfront histogram has a single non-empty bucket are skipped
+// without recounting, scattering or swapping.
+// All scratch memory comes from one allocation and each thread zeroes only
+// the counters it owns, so nothing is refilled between passes.
+template<typename Size_t, typename Value_t, typename Key_extractor_t,
+         typename Radix_cp, auto Radix_tp, bool Use_simd>
+void Adl_radix_sort_fused_parallel(Value_t* Start_ptr, Size_t Size,
+                                   const Key_extractor_t& Extractor)
+{
+  using Key_t = std::decay_t<decltype(Extractor(std::declval<Value_t>()))>;
+
+  constexpr std::size_t  Bucket_size = Radix_tp.Bucket_size;
+  constexpr std::uint8_t Passes      = Radix_cp::Passes;
+  constexpr bool         Handle_NaN  = std::is_floating_point_v<Key_t> &&
+      Radix_tp.NaN_position != NaNPosition::Unhandled;
+
+  const std::int32_t Hardware_concurrency = omp_get_num_procs();
+  const std::int32_t Min_chunk_size       = 1024;
+  const std::int32_t Actual_threads       = std::max(
+      std::min(Hardware_concurrency, (std::int32_t)(Size / Min_chunk_size)), 1);
+  const Size_t Chunk = (Size + Actual_threads - 1) / Actual_threads;
+  const std::size_t Bucket_slice =
+      (Bucket_size + Actual_threads - 1) / Actual_threads;
+
+  // Scratch layout (one allocation):
+  //   Local_counts  [thread][pass][bucket]
+  //   Local_offsets [thread][bucket]
+  //   Global_starts [pass][bucket]
+  //   Slice_totals  [pass][thread]
+  //   Trivial       [pass]
+  //   NaN_counts    [thread], NaN_offsets [thread]
+  const std::size_t Local_counts_size  = Actual_threads * Passes * Bucket_size;
+  const std::size_t Local_offsets_size = Actual_threads * Bucket_size;
+  const std::size_t Global_starts_size = Passes * Bucket_size;
+  const std::size_t Slice_totals_size  = Passes * Actual_threads;
+  const std::size_t NaN_size           = Handle_NaN ? 2 * Actual_threads : 0;
+
+  std::unique_ptr<Size_t []> Scratch(
+      new Size_t [Local_counts_size + Local_offsets_size + Global_starts_size +
+                  Slice_totals_size + Passes + NaN_size]);
+  Size_t* const Local_counts  = Scratch.get();
+  Size_t* const Local_offsets = Local_counts + Local_counts_size;
+  Size_t* const Global_starts = Local_offsets + Local_offsets_size;
+  Size_t* const Slice_totals  = Global_starts + Global_starts_size;
+  Size_t* const Trivial       = Slice_totals + Slice_totals_size;
+  [[maybe_unused]] Size_t* const NaN_counts = Trivial + Passes;
+  [[maybe_unused]] Size_t* const NaN_offsets = NaN_counts + Actual_threads;
+
+  auto Func_get_counts = [&](std::int32_t Thread, std::uint8_t Pass) {
+    return Local_counts + (Thread * Passes + Pass) * Bucket_size;
+  };
+
+  std::fill(Trivial, Trivial + Passes, 0);
+
+  std::unique_ptr<Value_t []> Buffer(new Value_t [Size]);
+
+#pragma omp parallel num_threads(Actual_threads)
+  {
+    const int    Thread_id = omp_get_thread_num();
+    const Size_t Start_idx = Thread_id * Chunk;
+    const Size_t End_idx   = std::min(Size, (Thread_id + 1) * Chunk);
+    const std::size_t Bucket_begin =
+        std::min(Bucket_size, Thread_id * Bucket_slice);
+    const std::size_t Bucket_end =
+        std::min(Bucket_size, Bucket_begin + Bucket_slice);
+
+    // Every thread swaps its own copy in lockstep
+    Value_t* Src = Start_ptr;
+    Value_t* Dst = Buffer.get();
+
+    // Phase 0: digits of every pass in one read
+    {
+      Size_t* Counts = Func_get_counts(Thread_id, 0);
+      std::fill(Counts, Counts + Passes * Bucket_size, 0);
+      Size_t Thread_NaN_count = 0;
+      Adl_count_all_passes<Size_t, Value_t, Key_extractor_t, Radix_cp, Radix_tp>(
+          Start_idx, End_idx, Src, Counts, Extractor, &Thread_NaN_count);
+      if constexpr (Handle_NaN) { NaN_counts [Thread_id] = Thread_NaN_count; }
+    }
+#pragma omp barrier
+
+    // Phase 1: reduce the global histograms over this thread's bucket slice,
+    // then turn them into bucket start offsets
+    [[maybe_unused]] Size_t Total_NaN_count = 0;
+    if constexpr (Handle_NaN) {
+      for (std::int32_t Thread = 0; Thread < Actual_threads; ++Thread) {
+        Total_NaN_count += NaN_counts [Thread];
+      }
+    }
+
+    for (std::uint8_t Pass = 0; Pass < Passes; ++Pass) {
+      Size_t  Slice_total = 0;
+      Size_t* Global      = Global_starts + Pass * Bucket_size;
+      for (std::size_t Bucket = Bucket_begin; Bucket < Bucket_end; ++Bucket) {
+        Size_t Total = 0;
+        for (std::int32_t Thread = 0; Thread < Actual_threads; ++Thread) {
+          Total += Func_get_counts(Thread, Pass) [Bucket];
+        }
+        Global [Bucket] = Total;
+        Slice_total += Total;
+        // At most one bucket can hold every key, so only its owner writes
+        if (Total == Size) Trivial [Pass] = 1;
+      }
+      Slice_totals [Pass * Actual_threads + Thread_id] = Slice_total;
+    }
+#pragma omp barrier
+
+    for (std::uint8_t Pass = 0; Pass < Passes; ++Pass) {
+      Size_t Running = 0;
+      if constexpr (Handle_NaN &&
+                    Radix_tp.NaN_position == NaNPosition::AtStart) {
+        if (Pass == Passes - 1) Running = Total_NaN_count;
+      }
+      for (std::int32_t Thread = 0; Thread < Thread_id; ++Thread) {
+        Running += Slice_totals [Pass * Actual_threads + Thread];
+      }
+
+      Size_t* Global = Global_starts + Pass * Bucket_size;
+      for (std::size_t Bucket = Bucket_begin; Bucket < Bucket_end; ++Bucket) {
+        const Size_t Count = Global [Bucket];
+        Global [Bucket]    = Running;
+        Running += Count;
+      }
+    }
+
+    bool Layout_changed = false;
+    for (std::uint8_t Pass = 0; Pass < Passes; ++Pass) {
+      const bool Is_last_pass = Pass == Passes - 1;
+
+      // Every thread sees the same flags, so all of them skip together
+      if (Trivial [Pass]) continue;
+
+      // Phase 2: the upfront counts only match the original layout
+      if (Layout_changed) {
+        Size_t* Counts = Func_get_counts(Thread_id, Pass);
+        std::fill(Counts, Counts + Bucket_size, 0);
+        if (Is_last_pass) {
+          if constexpr (Handle_NaN) { NaN_counts [Thread_id] = 0; }
+          if constexpr (Use_simd) {
+            Adl_count_buckets_simd<Size_t, Value_t, Key_extractor_t, Radix_cp,
+                                   Radix_tp, true>(
+                Start_idx, End_idx, Pass, Src, Counts, Extractor,
+                Handle_NaN ? NaN_counts : nullptr, Handle_NaN ? Thread_id : 0);
+          } else {
+            Adl_count_buckets<Size_t, Value_t, Key_extractor_t, Radix_cp,
+                              Radix_tp, true>(
+                Start_idx, End_idx, Pass, Src, Counts, Extractor,
+                Handle_NaN ? NaN_counts : nullptr, Handle_NaN ? Thread_id : 0);
+          }
+        } else {
+          if constexpr (Use_simd) {
+            Adl_count_buckets_simd<Size_t, Value_t, Key_extractor_t, Radix_cp,
+                                   Radix_tp, false>(
+                Start_idx, End_idx, Pass, Src, Counts, Extractor, nullptr, 0);
+          } else {
+            Adl_count_buckets<Size_t, Value_t, Key_extractor_t, Radix_cp,
+                              Radix_tp, false>(
+                Start_idx, End_idx, Pass, Src, Counts, Extractor, nullptr, 0);
+          }
+        }
+#pragma omp barrier
+      }
+
+      // Phase 3: per-thread offsets, split across bucket slices
+      const Size_t* Global = Global_starts + Pass * Bucket_size;
+      for (std::size_t Bucket = Bucket_begin; Bucket < Bucket_end; ++Bucket) {
+        Size_t Running = Global [Bucket];
+        for (std::int32_t Thread = 0; Thread < Actual_threads; ++Thread) {
+          Local_offsets [Thread * Bucket_size + Bucket] = Running;
+          Running += Func_get_counts(Thread, Pass) [Bucket];
+        }
+      }
+
+      if constexpr (Handle_NaN) {
+        if (Is_last_pass) {
+#pragma omp single
+          {
+            Size_t NaN_running_sum = 0;
+            if constexpr (Radix_tp.NaN_position == NaNPosition::AtEnd) {
+              NaN_running_sum = Size - Total_NaN_count;
+            }
+            for (std::int32_t Thread = 0; Thread < Actual_threads; ++Thread) {
+              // AtStart fills each thread's range backwards (--offset), so it
+              // starts from the end of that range
+              if constexpr (Radix_tp.NaN_position == NaNPosition::AtStart) {
+                NaN_running_sum += NaN_counts [Thread];
+                NaN_offsets [Thread] = NaN_running_sum;
+              } else {
+                NaN_offsets [Thread] = NaN_running_sum;
+                NaN_running_sum += NaN_counts [Thread];
+              }
+            }
+          }
+        }
+      }
+#pragma omp barrier
+
+      // Phase 4: scatter
+      Size_t* Offsets = Local_offsets + Thread_id * Bucket_size;
+      if (Is_last_pass) {
+        [[maybe_unused]] Size_t Thread_NaN_offset = 0;
+        if constexpr (Handle_NaN) { Thread_NaN_offset = NaN_offsets [Thread_id]; }
+        if constexpr (Use_simd) {
+          Adl_distribute_to_buckets_simd<Size_t, Value_t, Key_extractor_t,
+                                         Radix_cp, Radix_tp, true>(
+              Start_idx, End_idx, Pass, Src, Dst, Offsets, Extractor,
+              Thread_NaN_offset);
+        } else {
+          Adl_distribute_to_buckets<Size_t, Value_t, Key_extractor_t, Radix_cp,
+                                    Radix_tp, true>(
+              Start_idx, End_idx, Pass, Src, Dst, Offsets, Extractor,
+              Thread_NaN_offset);
+        }
+      } else {
+        if constexpr (Use_simd) {
+          Adl_distribute_to_buckets_simd<Size_t, Value_t, Key_extractor_t,
+                                         Radix_cp, Radix_tp, false>(
+              Start_idx, End_idx, Pass, Src, Dst, Offsets, Extractor, 0);
+        } else {
+          Adl_distribute_to_buckets<Size_t, Value_t, Key_extractor_t, Radix_cp,
+                                    Radix_tp, false>(
+              Start_idx, End_idx, Pass, Src, Dst, Offsets, Extractor, 0);
+        }
+      }
+#pragma omp barrier
+
+      std::swap(Src, Dst);
+      Layout_changed = true;
+    }
+  }
+
+  const auto Scattered_passes = Passes - std::count(Trivial, Trivial + Passes, 1);
+  if (Scattered_passes & 1) {
+    std::move(Buffer.get(), Buffer.get() + Size, Start_ptr);
+  }
+}
+
 template<ContiguousIterator ContigIter,
          auto Radix_tp = details::Adl_default_radix_params<ContigIter>()>
 void radix_sort_impl(std::execution::parallel_policy, ContigIter First,
-                     ContigIter Last)
+                     ContigIter Last,
+                     const typename decltype(Radix_tp)::Key_extractor_t& Extractor = {})
 {
   static_assert(is_valid_bucket_size<Radix_tp.Bucket_size>,
                 "Bucket size must be 256 or 65536");
 
   using Value_t         = typename std::iterator_traits<ContigIter>::value_type;
   using Key_extractor_t = typename decltype(Radix_tp)::Key_extractor_t;
-  Key_extractor_t Extractor {};
   using Key_t = std::decay_t<decltype(Extractor(std::declval<Value_t>()))>;
 
   static_assert(
       ArithmeticKey<Key_t>,
-      "Key type must be arithmetic (excluding bool and character types)");
+      "Key type must be arithmetic (excluding bool)");
 
   static_assert(sizeof(Key_t) >= 4, "Arithmetic type must be at least 4 bytes");
 
@@ -1387,6 +2143,18 @@ void radix_sort_impl(std::execution::parallel_policy, ContigIter First,
 
   using Radix_cp = Radix_constexpr_params<Key_t, Radix_tp.Bucket_size>;
 
+  if constexpr (Radix_tp.Algorithm == RadixAlgorithm::InPlaceMSD) {
+    Adl_radix_sort_msd_inplace<Size_t, Value_t, Key_extractor_t, Radix_tp,
+                               true>(Start_ptr, Size, Extractor);
+    return;
+  }
+
+  if constexpr (Radix_tp.Parallel_mode == ParallelMode::Fused) {
+    Adl_radix_sort_fused_parallel<Size_t, Value_t, Key_extractor_t, Radix_cp,
+                                  Radix_tp, false>(Start_ptr, Size, Extractor);
+    return;
+  }
+
   // Optimization: Dynamically adjust thread count to avoid small chunks
   const std::int32_t Hardware_concurrency = omp_get_num_procs();
   const std::int32_t Min_chunk_size       = 1024;
@@ -1466,6 +2234,13 @@ void radix_sort_impl(std::execution::parallel_policy, ContigIter First,
         }
       }
 
+      if (Adl_is_trivial_pass(Global_prefix.data(), Radix_tp.Bucket_size,
+                              Size)) {
+        std::fill(Local_data.get(), Local_data.get() + Local_data_size, 0);
+        std::fill(Global_prefix.begin(), Global_prefix.end(), 0);
+        continue;
+      }
+
       //  Calculate global prefix sum
       std::exclusive_scan(Global_prefix.begin(), Global_prefix.end(),
                           Global_prefix.begin(), 0, std::plus<> {});
@@ -1567,6 +2342,12 @@ void radix_sort_impl(std::execution::parallel_policy, ContigIter First,
         }
       }
 
+      if (Adl_is_trivial_pass(Global_prefix.data(), Radix_tp.Bucket_size,
+                              Size)) {
+        if (Src != Start_ptr) std::move(Src, Src + Size, Start_ptr);
+        return;
+      }
+
       if constexpr (Radix_tp.NaN_position == NaNPosition::AtStart && Handle_NaN) {
         std::exclusive_scan(Global_prefix.begin(), Global_prefix.end(),
                             Global_prefix.begin(), Total_NaN_count,
@@ -1603,8 +2384,15 @@ void radix_sort_impl(std::execution::parallel_policy, ContigIter First,
 
         LOOP_UNROLL(8)
         for (std::int32_t Thread = 0; Thread < Actual_threads; ++Thread) {
-          Thread_NaN_offsets [Thread] = NaN_running_sum;
-          NaN_running_sum += Local_NaN_counts [Thread];
+          // AtStart fills each thread's range backwards (--offset), so it
+          // starts from the end of that range
+          if constexpr (Radix_tp.NaN_position == NaNPosition::AtStart) {
+            NaN_running_sum += Local_NaN_counts [Thread];
+            Thread_NaN_offsets [Thread] = NaN_running_sum;
+          } else {
+            Thread_NaN_offsets [Thread] = NaN_running_sum;
+            NaN_running_sum += Local_NaN_counts [Thread];
+          }
         }
       }
     }
@@ -1633,12 +2421,16 @@ void radix_sort_impl(std::execution::parallel_policy, ContigIter First,
   }
 
   std::swap(Src, Dst);
+
+  // Skipped passes break the parity of the buffer swaps
+  if (Src != Start_ptr) std::move(Src, Src + Size, Start_ptr);
 }
 
 template<ContiguousIterator ContigIter,
          auto Radix_tp = details::Adl_default_radix_params<ContigIter>()>
 void radix_sort_impl(std::execution::parallel_unsequenced_policy,
-                     ContigIter First, ContigIter Last)
+                     ContigIter First, ContigIter Last,
+                     const typename decltype(Radix_tp)::Key_extractor_t& Extractor = {})
 {
 #if defined(__AVX2__) || defined(__ARM_NEON) || defined(__aarch64__)
   static_assert(is_valid_bucket_size<Radix_tp.Bucket_size>,
@@ -1646,12 +2438,11 @@ void radix_sort_impl(std::execution::parallel_unsequenced_policy,
 
   using Value_t         = typename std::iterator_traits<ContigIter>::value_type;
   using Key_extractor_t = typename decltype(Radix_tp)::Key_extractor_t;
-  Key_extractor_t Extractor {};
   using Key_t = std::decay_t<decltype(Extractor(std::declval<Value_t>()))>;
 
   static_assert(
       ArithmeticKey<Key_t>,
-      "Key type must be arithmetic (excluding bool and character types)");
+      "Key type must be arithmetic (excluding bool)");
 
   static_assert(sizeof(Key_t) >= 4, "Arithmetic type must be at least 4 bytes");
 
@@ -1674,6 +2465,18 @@ void radix_sort_impl(std::execution::parallel_unsequenced_policy,
 
   using Radix_cp = Radix_constexpr_params<Key_t, Radix_tp.Bucket_size>;
 
+  if constexpr (Radix_tp.Algorithm == RadixAlgorithm::InPlaceMSD) {
+    Adl_radix_sort_msd_inplace<Size_t, Value_t, Key_extractor_t, Radix_tp,
+                               true>(Start_ptr, Size, Extractor);
+    return;
+  }
+
+  if constexpr (Radix_tp.Parallel_mode == ParallelMode::Fused) {
+    Adl_radix_sort_fused_parallel<Size_t, Value_t, Key_extractor_t, Radix_cp,
+                                  Radix_tp, true>(Start_ptr, Size, Extractor);
+    return;
+  }
+
   // Optimization: Dynamically adjust thread count to avoid small chunks
   const std::int32_t Hardware_concurrency = omp_get_num_procs();
   const std::int32_t Min_chunk_size       = 1024;
@@ -1744,6 +2547,13 @@ void radix_sort_impl(std::execution::parallel_unsequenced_policy,
         }
       }
 
+      if (Adl_is_trivial_pass(Global_prefix.data(), Radix_tp.Bucket_size,
+                              Size)) {
+        std::fill(Local_data.get(), Local_data.get() + Local_data_size, 0);
+        std::fill(Global_prefix.begin(), Global_prefix.end(), 0);
+        continue;
+      }
+
       //  Calculate global prefix sum
       std::exclusive_scan(Global_prefix.begin(), Global_prefix.end(),
                           Global_prefix.begin(), 0, std::plus<> {});
@@ -1845,6 +2655,12 @@ void radix_sort_impl(std::execution::parallel_unsequenced_policy,
         }
       }
 
+      if (Adl_is_trivial_pass(Global_prefix.data(), Radix_tp.Bucket_size,
+                              Size)) {
+        if (Src != Start_ptr) std::move(Src, Src + Size, Start_ptr);
+        return;
+      }
+
       if constexpr (Radix_tp.NaN_position == NaNPosition::AtStart && Handle_NaN) {
         std::exclusive_scan(Global_prefix.begin(), Global_prefix.end(),
                             Global_prefix.begin(), Total_NaN_count,
@@ -1881,8 +2697,15 @@ void radix_sort_impl(std::execution::parallel_unsequenced_policy,
 
         LOOP_UNROLL(8)
         for (std::int32_t Thread = 0; Thread < Actual_threads; ++Thread) {
-          Thread_NaN_offsets [Thread] = NaN_running_sum;
-          NaN_running_sum += Local_NaN_counts [Thread];
+          // AtStart fills each thread's range backwards (--offset), so it
+          // starts from the end of that range
+          if constexpr (Radix_tp.NaN_position == NaNPosition::AtStart) {
+            NaN_running_sum += Local_NaN_counts [Thread];
+            Thread_NaN_offsets [Thread] = NaN_running_sum;
+          } else {
+            Thread_NaN_offsets [Thread] = NaN_running_sum;
+            NaN_running_sum += Local_NaN_counts [Thread];
+          }
         }
       }
     }
@@ -1914,11 +2737,372 @@ void radix_sort_impl(std::execution::parallel_unsequenced_policy,
 
   std::swap(Src, Dst);
 
+  // Skipped passes break the parity of the buffer swaps
+  if (Src != Start_ptr) std::move(Src, Src + Size, Start_ptr);
+
 #else
-  radix_sort_impl(std::execution::par, First, Last);
+  radix_sort_impl<ContigIter, Radix_tp>(std::execution::par, First, Last,
+                                        Extractor);
 #endif
 }
 
+// Record sorted by the indirect mode in place of the element itself
+template<typename Key_t>
+struct Key_index
+{
+  Key_t         Key;
+  std::uint32_t Index;
+};
+
+template<typename Key_t>
+struct Key_index_extractor
+{
+  constexpr Key_t operator() (const Key_index<Key_t>& Record) const noexcept
+  {
+    return Record.Key;
+  }
+};
+
+// Elements at least this large are sorted indirectly by dispatch_radix_sort
+inline constexpr std::size_t Indirect_sort_threshold = 64;
+
+// Indirect (key-pointer) sort: every key is extracted once into a compact
+// (key, 32-bit index) record, the records are radix sorted with the same
+// parameters and policy, and the elements are then permuted in place by
+// following the cycles of the sorted index order. Each element is moved
+// about once instead of once per pass. Needs Size <= UINT32_MAX.
+template<ContiguousIterator ContigIter, auto Radix_tp, typename ExPo>
+void radix_sort_indirect_impl(
+    ExPo&& Policy, ContigIter First, ContigIter Last,
+    const typename decltype(Radix_tp)::Key_extractor_t& Extractor)
+{
+  using Value_t  = std::iter_value_t<ContigIter>;
+  using Key_t    = std::decay_t<decltype(Extractor(std::declval<Value_t>()))>;
+  using Record_t = Key_index<Key_t>;
+  using Size_t   = typename decltype(Radix_tp)::Dataset_size_t;
+
+  constexpr bool Is_parallel =
+      std::same_as<std::decay_t<ExPo>, std::execution::parallel_policy> ||
+      std::same_as<std::decay_t<ExPo>,
+                   std::execution::parallel_unsequenced_policy>;
+
+  const Size_t Size = static_cast<Size_t>(std::distance(First, Last));
+  if (Size <= 1) [[unlikely]]
+    return;
+
+  Value_t* Start_ptr = &*First;
+
+  std::unique_ptr<Record_t []> Records(new Record_t [Size]);
+#pragma omp parallel for if (Is_parallel) schedule(static)
+  for (Size_t Idx = 0; Idx < Size; ++Idx) {
+    Records [Idx] = { Extractor(Start_ptr [Idx]),
+                      static_cast<std::uint32_t>(Idx) };
+  }
+
+  constexpr auto Record_tp =
+      Adl_rebind_radix_params<Key_index_extractor<Key_t>>(Radix_tp);
+  radix_sort_impl<Record_t*, Record_tp>(std::forward<ExPo>(Policy),
+                                        Records.get(), Records.get() + Size);
+
+  // Position Idx takes the element at Records[Idx].Index. Each cycle is walked
+  // once with a single temporary; visited positions are marked by pointing
+  // them at themselves.
+  for (Size_t Idx = 0; Idx < Size; ++Idx) {
+    if (Records [Idx].Index == Idx) continue;
+
+    Value_t Value = std::move(Start_ptr [Idx]);
+    Size_t  Hole  = Idx;
+    for (;;) {
+      const Size_t Next    = Records [Hole].Index;
+      Records [Hole].Index = static_cast<std::uint32_t>(Hole);
+      if (Next == Idx) break;
+      Start_ptr [Hole] = std::move(Start_ptr [Next]);
+      Hole             = Next;
+    }
+    Start_ptr [Hole] = std::move(Value);
+  }
+}
+
+// Sorts large elements through radix_sort_indirect_impl and everything else
+// (or inputs too large for 32-bit indices) directly
+template<ContiguousIterator ContigIter, auto Radix_tp, typename ExPo>
+void dispatch_radix_sort(
+    ExPo&& Policy, ContigIter First, ContigIter Last,
+    const typename decltype(Radix_tp)::Key_extractor_t& Extractor)
+{
+  using Value_t = std::iter_value_t<ContigIter>;
+
+  if constexpr (sizeof(Value_t) >= Indirect_sort_threshold) {
+    if (static_cast<std::uint64_t>(std::distance(First, Last)) <=
+        std::numeric_limits<std::uint32_t>::max()) {
+      radix_sort_indirect_impl<ContigIter, Radix_tp>(std::forward<ExPo>(Policy),
+                                                     First, Last, Extractor);
+      return;
+    }
+  }
+  radix_sort_impl<ContigIter, Radix_tp>(std::forward<ExPo>(Policy), First, Last,
+                                        Extractor);
+}
+
+// ---------------------------------------------------------------------------
+// Composite keys (radix_sort_by_fields)
+//
+// Every field is normalised to an unsigned image of its own width (sign bit
+// flipped, complemented for descending) and the images are concatenated, most
+// significant field first, into a 32- or 64-bit chunk key. Fields that do not
+// fit in one chunk are split over several; the chunks are then sorted from the
+// least significant one up with the stable LSD sort, so the result is ordered
+// lexicographically by field. Each chunk is an ordinary unsigned key, so the
+// trivial-pass skip drops the padding bytes of narrow chunks for free.
+// ---------------------------------------------------------------------------
+
+template<typename T>
+struct Is_key_field : std::false_type
+{ };
+
+template<typename Extractor, SortOrder Order, HasNegative Has_negative>
+struct Is_key_field<key_field<Extractor, Order, Has_negative>> : std::true_type
+{ };
+
+template<typename T>
+concept KeyField = Is_key_field<std::decay_t<T>>::value;
+
+template<typename Field_t, typename Value_t>
+using Field_key_t = std::decay_t<
+    std::invoke_result_t<const decltype(Field_t::extractor)&, const Value_t&>>;
+
+template<typename Field_t, typename Key_t>
+ALWAYS_INLINE auto Adl_normalized_field(Key_t Key) noexcept
+{
+  static_assert(
+      ArithmeticKey<Key_t>,
+      "Key type must be arithmetic (excluding bool)");
+
+  // Unsigned fields have no sign bit to flip whatever the field says
+  constexpr auto Field_tp = [] {
+    Radix_template_params<identity_key_extractor<Key_t>, Dataset_size32_t>
+        Params {};
+    Params.Order        = Field_t::order;
+    Params.Has_negative = std::is_unsigned_v<Key_t> ? HasNegative::No
+                                                    : Field_t::has_negative;
+    return Params;
+  }();
+  return Adl_normalized_key<Radix_constexpr_params<Key_t, 256U>, Field_tp>(Key);
+}
+
+template<typename Value_t, typename... Fields_t>
+struct Composite_key_layout
+{
+  static constexpr std::array<std::size_t, sizeof...(Fields_t)> Bits {
+    (sizeof(Field_key_t<Fields_t, Value_t>) << 3)...
+  };
+
+  // First field of the chunk ending before End: as many of the preceding
+  // fields as fit in 64 bits
+  static constexpr std::size_t chunk_begin(std::size_t End) noexcept
+  {
+    std::size_t Begin = End;
+    std::size_t Total = 0;
+    while (Begin > 0 && Total + Bits [Begin - 1] <= 64) Total += Bits [--Begin];
+    return Begin;
+  }
+
+  static constexpr std::size_t chunk_bits(std::size_t Begin,
+                                          std::size_t End) noexcept
+  {
+    std::size_t Total = 0;
+    for (std::size_t Idx = Begin; Idx < End; ++Idx) Total += Bits [Idx];
+    return Total;
+  }
+};
+
+template<std::size_t Begin, std::size_t End, typename Chunk_key_t,
+         typename Value_t, typename Fields_tuple_t>
+ALWAYS_INLINE Chunk_key_t Adl_pack_fields(const Value_t&        Value,
+                                          const Fields_tuple_t& Fields) noexcept
+{
+  Chunk_key_t Key = 0;
+
+  auto Func_append = [&]<std::size_t Idx>() {
+    using Field_t = std::tuple_element_t<Idx, Fields_tuple_t>;
+    using Key_t   = Field_key_t<Field_t, Value_t>;
+
+    const auto Image = Adl_normalized_field<Field_t>(
+        static_cast<Key_t>(std::invoke(std::get<Idx>(Fields).extractor, Value)));
+    if constexpr (Idx == Begin) {
+      Key = Image;
+    } else {
+      Key = static_cast<Chunk_key_t>(Key << (sizeof(Key_t) << 3)) | Image;
+    }
+  };
+  [&]<std::size_t... Idx>(std::index_sequence<Idx...>) {
+    (Func_append.template operator()<Begin + Idx>(), ...);
+  }(std::make_index_sequence<End - Begin> {});
+
+  return Key;
+}
+
+template<std::size_t End, ContiguousIterator ContigIter, typename ExPo,
+         typename... Fields_t>
+void Adl_sort_by_field_chunks(ExPo& Policy, ContigIter First, ContigIter Last,
+                              const std::tuple<Fields_t...>& Fields)
+{
+  using Value_t = std::iter_value_t<ContigIter>;
+  using Layout  = Composite_key_layout<Value_t, Fields_t...>;
+
+  constexpr std::size_t Begin = Layout::chunk_begin(End);
+  using Chunk_key_t = std::conditional_t<(Layout::chunk_bits(Begin, End) <= 32),
+                                         std::uint32_t, std::uint64_t>;
+
+  auto Func_pack = [&Fields](const Value_t& Value) noexcept {
+    return Adl_pack_fields<Begin, End, Chunk_key_t>(Value, Fields);
+  };
+  using Key_extractor_t = function_key_extractor<decltype(Func_pack)>;
+
+  // Must stay LSD: the chunks rely on the sort being stable
+  constexpr auto Chunk_tp =
+      Adl_default_radix_params_for<Key_extractor_t, Chunk_key_t>();
+  static_assert(Chunk_tp.Algorithm == RadixAlgorithm::LSD);
+
+  dispatch_radix_sort<ContigIter, Chunk_tp>(Policy, First, Last,
+                                            Key_extractor_t { Func_pack });
+
+  if constexpr (Begin > 0) {
+    Adl_sort_by_field_chunks<Begin>(Policy, First, Last, Fields);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// String keys (radix_sort_strings)
+//
+// MSD radix sort on bytes, in place, with the American flag permutation. The
+// bucket at Depth is 0 for strings that end before Depth and 1 + byte
+// otherwise, so shorter strings order before their extensions. Before each
+// level the longest prefix shared by the whole bucket is skipped in one scan,
+// which keeps long common prefixes (paths, URLs, keys with a namespace) from
+// costing a counting pass per byte.
+// ---------------------------------------------------------------------------
+
+template<typename T>
+concept StringLike = std::convertible_to<const T&, std::string_view>;
+
+template<SortOrder Order, typename Value_t, typename Size_t>
+void Adl_insertion_sort_strings(Value_t* Start, Size_t Size, std::size_t Depth)
+{
+  auto Func_less = [Depth](std::string_view Lhs, std::string_view Rhs) {
+    if constexpr (Order == SortOrder::Ascending) {
+      return Lhs.substr(Depth) < Rhs.substr(Depth);
+    } else {
+      return Rhs.substr(Depth) < Lhs.substr(Depth);
+    }
+  };
+
+  for (Size_t I = 1; I < Size; ++I) {
+    Value_t Value = std::move(Start [I]);
+
+    Size_t J = I;
+    for (; J > 0 && Func_less(Value, Start [J - 1]); --J) {
+      Start [J] = std::move(Start [J - 1]);
+    }
+    Start [J] = std::move(Value);
+  }
+}
+
+// Length of the prefix starting at Depth that every string in the range shares
+template<typename Value_t, typename Size_t>
+std::size_t Adl_common_prefix(const Value_t* Start, Size_t Size, std::size_t Depth)
+{
+  const std::string_view First_view(Start [0]);
+  std::size_t            Common = First_view.size() - Depth;
+
+  for (Size_t Idx = 1; Idx < Size && Common > 0; ++Idx) {
+    const std::string_view View(Start [Idx]);
+    const std::size_t      Limit = std::min(Common, View.size() - Depth);
+
+    const auto First_it = First_view.begin() + Depth;
+    Common = static_cast<std::size_t>(
+        std::mismatch(First_it, First_it + Limit, View.begin() + Depth).first -
+        First_it);
+  }
+  return Common;
+}
+
+template<SortOrder Order, bool Parallel, typename Value_t, typename Size_t>
+void Adl_string_msd_sort(Value_t* Start, Size_t Size, std::size_t Depth)
+{
+  // End of string plus every byte value
+  constexpr std::size_t Bucket_size = 257;
+  constexpr std::size_t End_bucket =
+      Order == SortOrder::Ascending ? 0 : Bucket_size - 1;
+
+  for (;; ++Depth) {
+    if (Size <= Msd_insertion_sort_threshold) {
+      Adl_insertion_sort_strings<Order>(Start, Size, Depth);
+      return;
+    }
+
+    Depth += Adl_common_prefix(Start, Size, Depth);
+
+    auto Func_get_digit = [Depth](const Value_t& Value) -> std::size_t {
+      const std::string_view View(Value);
+      const std::size_t      Digit = Depth < View.size()
+               ? std::size_t { static_cast<unsigned char>(View [Depth]) } + 1
+               : 0;
+      if constexpr (Order == SortOrder::Ascending) {
+        return Digit;
+      } else {
+        return Bucket_size - 1 - Digit;
+      }
+    };
+
+    std::array<Size_t, Bucket_size> Bucket_counts {};
+    for (Size_t Idx = 0; Idx < Size; ++Idx) {
+      ++Bucket_counts [Func_get_digit(Start [Idx])];
+    }
+
+    // After the prefix skip only a bucket of identical strings is trivial
+    if (Adl_is_trivial_pass(Bucket_counts.data(), Bucket_size, Size)) {
+      if (Bucket_counts [End_bucket] == Size) return;
+      continue;
+    }
+
+    Adl_american_flag_permute(Start, Bucket_counts, Func_get_digit);
+
+    Value_t* Bucket_ptr = Start;
+    for (std::size_t Bucket = 0; Bucket < Bucket_size; ++Bucket) {
+      const Size_t Count = Bucket_counts [Bucket];
+      // Strings that ended here are all equal
+      if (Count > 1 && Bucket != End_bucket) {
+        if constexpr (Parallel) {
+#pragma omp task if (Count >= Msd_task_threshold) firstprivate(Bucket_ptr, Count)
+          Adl_string_msd_sort<Order, Parallel>(Bucket_ptr, Count, Depth + 1);
+        } else {
+          Adl_string_msd_sort<Order, Parallel>(Bucket_ptr, Count, Depth + 1);
+        }
+      }
+      Bucket_ptr += Count;
+    }
+    return;
+  }
+}
+
+template<SortOrder Order, bool Parallel, typename Value_t, typename Size_t>
+void Adl_radix_sort_strings(Value_t* Start_ptr, Size_t Size)
+{
+  if (Size <= 1) [[unlikely]]
+    return;
+
+  if constexpr (Parallel) {
+    if (Size >= Msd_task_threshold) {
+#pragma omp parallel num_threads(omp_get_num_procs())
+#pragma omp single
+      Adl_string_msd_sort<Order, true>(Start_ptr, Size, 0);
+      return;
+    }
+  }
+  Adl_string_msd_sort<Order, false>(Start_ptr, Size, 0);
+}
+
 }  // namespace details
 
 template<details::ContiguousIterator ContigIter>
@@ -1953,11 +3137,12 @@ template<details::ContiguousIterator ContigIter, typename KeyType>
 void radix_sort_by_member(ContigIter first, ContigIter last,
                           KeyType(std::iter_value_t<ContigIter>::* member_ptr))
 {
-  using Value_t = std::iter_value_t<ContigIter>;
-  details::radix_sort_impl<
+  using Value_t         = std::iter_value_t<ContigIter>;
+  using Key_extractor_t = member_key_extractor<Value_t, KeyType>;
+  details::dispatch_radix_sort<
       ContigIter,
-      Radix_template_params<member_key_extractor<Value_t, KeyType>,
-                            std::uint32_t> {}>(std::execution::seq, first, last);
+      details::Adl_default_radix_params_for<Key_extractor_t, KeyType>()>(
+      std::execution::seq, first, last, Key_extractor_t { member_ptr });
 }
 
 template<details::ContiguousIterator       ContigIter,
@@ -1965,29 +3150,24 @@ template<details::ContiguousIterator       ContigIter,
 void radix_sort_by_member(ExPo&& policy, ContigIter first, ContigIter last,
                           KeyType(std::iter_value_t<ContigIter>::* member_ptr))
 {
-  using Value_t = std::iter_value_t<ContigIter>;
-  details::radix_sort_impl<
+  using Value_t         = std::iter_value_t<ContigIter>;
+  using Key_extractor_t = member_key_extractor<Value_t, KeyType>;
+  details::dispatch_radix_sort<
       ContigIter,
-      Radix_template_params<member_key_extractor<Value_t, KeyType>,
-                            std::uint32_t> {}>(std::forward<ExPo>(policy), first,
-                                               last);
+      details::Adl_default_radix_params_for<Key_extractor_t, KeyType>()>(
+      std::forward<ExPo>(policy), first, last, Key_extractor_t { member_ptr });
 }
 
 template<details::ContiguousIterator ContigIter, auto Radix_tp, typename KeyType>
 void radix_sort_by_member(ContigIter first, ContigIter last,
                           KeyType(std::iter_value_t<ContigIter>::* member_ptr))
 {
-  using Value_t     = std::iter_value_t<ContigIter>;
-  using NewRadix_tp = decltype(Radix_tp);
-  using NewParams = Radix_template_params<member_key_extractor<Value_t, KeyType>,
-                                          typename NewRadix_tp::Dataset_size_t>;
-  NewParams new_params {};
-  new_params.Bucket_size  = Radix_tp.Bucket_size;
-  new_params.Order        = Radix_tp.Order;
-  new_params.Has_negative = Radix_tp.Has_negative;
-  new_params.NaN_position = Radix_tp.NaN_position;
-  details::radix_sort_impl<ContigIter, new_params>(std::execution::seq, first,
-                                                   last);
+  using Value_t         = std::iter_value_t<ContigIter>;
+  using Key_extractor_t = member_key_extractor<Value_t, KeyType>;
+  constexpr auto new_params =
+      details::Adl_rebind_radix_params<Key_extractor_t>(Radix_tp);
+  details::dispatch_radix_sort<ContigIter, new_params>(
+      std::execution::seq, first, last, Key_extractor_t { member_ptr });
 }
 
 template<details::ContiguousIterator       ContigIter,
@@ -1995,78 +3175,118 @@ template<details::ContiguousIterator       ContigIter,
 void radix_sort_by_member(ExPo&& policy, ContigIter first, ContigIter last,
                           KeyType(std::iter_value_t<ContigIter>::* member_ptr))
 {
-  using Value_t     = std::iter_value_t<ContigIter>;
-  using NewRadix_tp = decltype(Radix_tp);
-  using NewParams = Radix_template_params<member_key_extractor<Value_t, KeyType>,
-                                          typename NewRadix_tp::Dataset_size_t>;
-  NewParams new_params {};
-  new_params.Bucket_size  = Radix_tp.Bucket_size;
-  new_params.Order        = Radix_tp.Order;
-  new_params.Has_negative = Radix_tp.Has_negative;
-  new_params.NaN_position = Radix_tp.NaN_position;
-  details::radix_sort_impl<ContigIter, new_params>(std::forward<ExPo>(policy),
-                                                   first, last);
+  using Value_t         = std::iter_value_t<ContigIter>;
+  using Key_extractor_t = member_key_extractor<Value_t, KeyType>;
+  constexpr auto new_params =
+      details::Adl_rebind_radix_params<Key_extractor_t>(Radix_tp);
+  details::dispatch_radix_sort<ContigIter, new_params>(
+      std::forward<ExPo>(policy), first, last, Key_extractor_t { member_ptr });
 }
 
 template<details::ContiguousIterator ContigIter, typename Func>
 void radix_sort_by(ContigIter first, ContigIter last, Func&& func)
 {
-  using Value_t = std::iter_value_t<ContigIter>;
-  using Func_t  = std::decay_t<Func>;
-  details::radix_sort_impl<
-      ContigIter,
-      Radix_template_params<function_key_extractor<Func_t>, std::uint32_t> {}>(
-      std::execution::seq, first, last);
+  using Value_t         = std::iter_value_t<ContigIter>;
+  using Func_t          = std::decay_t<Func>;
+  using Key_extractor_t = function_key_extractor<Func_t>;
+  using Key_t = std::decay_t<std::invoke_result_t<const Func_t&, const Value_t&>>;
+  details::dispatch_radix_sort<
+      ContigIter, details::Adl_default_radix_params_for<Key_extractor_t, Key_t>()>(
+      std::execution::seq, first, last,
+      Key_extractor_t { std::forward<Func>(func) });
 }
 
 template<details::ContiguousIterator       ContigIter,
          details::SupportedExecutionPolicy ExPo, typename Func>
 void radix_sort_by(ExPo&& policy, ContigIter first, ContigIter last, Func&& func)
 {
-  using Value_t = std::iter_value_t<ContigIter>;
-  using Func_t  = std::decay_t<Func>;
-  details::radix_sort_impl<
-      ContigIter,
-      Radix_template_params<function_key_extractor<Func_t>, std::uint32_t> {}>(
-      std::forward<ExPo>(policy), first, last);
+  using Value_t         = std::iter_value_t<ContigIter>;
+  using Func_t          = std::decay_t<Func>;
+  using Key_extractor_t = function_key_extractor<Func_t>;
+  using Key_t = std::decay_t<std::invoke_result_t<const Func_t&, const Value_t&>>;
+  details::dispatch_radix_sort<
+      ContigIter, details::Adl_default_radix_params_for<Key_extractor_t, Key_t>()>(
+      std::forward<ExPo>(policy), first, last,
+      Key_extractor_t { std::forward<Func>(func) });
 }
 
 template<details::ContiguousIterator ContigIter, auto Radix_tp, typename Func>
 void radix_sort_by(ContigIter first, ContigIter last, Func&& func)
 {
-  using Value_t     = std::iter_value_t<ContigIter>;
-  using Func_t      = std::decay_t<Func>;
-  using NewRadix_tp = decltype(Radix_tp);
-  using NewParams   = Radix_template_params<function_key_extractor<Func_t>,
-                                            typename NewRadix_tp::Dataset_size_t>;
-  NewParams new_params {};
-  new_params.Bucket_size  = Radix_tp.Bucket_size;
-  new_params.Order        = Radix_tp.Order;
-  new_params.Has_negative = Radix_tp.Has_negative;
-  new_params.NaN_position = Radix_tp.NaN_position;
-  details::radix_sort_impl<ContigIter, new_params>(std::execution::seq, first,
-                                                   last);
+  using Func_t          = std::decay_t<Func>;
+  using Key_extractor_t = function_key_extractor<Func_t>;
+  constexpr auto new_params =
+      details::Adl_rebind_radix_params<Key_extractor_t>(Radix_tp);
+  details::dispatch_radix_sort<ContigIter, new_params>(
+      std::execution::seq, first, last,
+      Key_extractor_t { std::forward<Func>(func) });
 }
 
 template<details::ContiguousIterator       ContigIter,
          details::SupportedExecutionPolicy ExPo, auto Radix_tp, typename Func>
 void radix_sort_by(ExPo&& policy, ContigIter first, ContigIter last, Func&& func)
 {
-  using Value_t     = std::iter_value_t<ContigIter>;
-  using Func_t      = std::decay_t<Func>;
-  using NewRadix_tp = decltype(Radix_tp);
-  using NewParams   = Radix_template_params<function_key_extractor<Func_t>,
-                                            typename NewRadix_tp::Dataset_size_t>;
-  NewParams new_params {};
-  new_params.Bucket_size  = Radix_tp.Bucket_size;
-  new_params.Order        = Radix_tp.Order;
-  new_params.Has_negative = Radix_tp.Has_negative;
-  new_params.NaN_position = Radix_tp.NaN_position;
-  details::radix_sort_impl<ContigIter, new_params>(std::forward<ExPo>(policy),
-                                                   first, last);
+  using Func_t          = std::decay_t<Func>;
+  using Key_extractor_t = function_key_extractor<Func_t>;
+  constexpr auto new_params =
+      details::Adl_rebind_radix_params<Key_extractor_t>(Radix_tp);
+  details::dispatch_radix_sort<ContigIter, new_params>(
+      std::forward<ExPo>(policy), first, last,
+      Key_extractor_t { std::forward<Func>(func) });
+}
+
+// Sorts by several fields at once, the first field being the most
+// significant, e.g.
+//   radix_sort_by_fields(v.begin(), v.end(),
+//                        make_key_field(&Order::tenant),
+//                        make_key_field<SortOrder::Descending>(&Order::price));
+// Stable; every field keeps its own order and sign handling.
+template<details::ContiguousIterator       ContigIter,
+         details::SupportedExecutionPolicy ExPo, details::KeyField... Fields>
+  requires (sizeof...(Fields) > 0)
+void radix_sort_by_fields(ExPo&& policy, ContigIter first, ContigIter last,
+                          Fields&&... fields)
+{
+  const std::tuple<std::decay_t<Fields>...> Fields_tuple {
+    std::forward<Fields>(fields)...
+  };
+  details::Adl_sort_by_field_chunks<sizeof...(Fields)>(policy, first, last,
+                                                       Fields_tuple);
+}
+
+template<details::ContiguousIterator ContigIter, details::KeyField... Fields>
+  requires (sizeof...(Fields) > 0)
+void radix_sort_by_fields(ContigIter first, ContigIter last, Fields&&... fields)
+{
+  radix_sort_by_fields(std::execution::seq, first, last,
+                       std::forward<Fields>(fields)...);
+}
+
+// Byte-wise (unsigned char) lexicographic sort of std::string,
+// std::string_view or anything convertible to std::string_view. Not stable.
+template<details::ContiguousIterator ContigIter,
+         SortOrder                   Order = SortOrder::Ascending>
+  requires details::StringLike<std::iter_value_t<ContigIter>>
+void radix_sort_strings(ContigIter first, ContigIter last)
+{
+  details::Adl_radix_sort_strings<Order, false>(
+      std::to_address(first), static_cast<std::size_t>(last - first));
+}
+
+template<details::ContiguousIterator       ContigIter,
+         details::SupportedExecutionPolicy ExPo,
+         SortOrder                         Order = SortOrder::Ascending>
+  requires details::StringLike<std::iter_value_t<ContigIter>>
+void radix_sort_strings(ExPo&&, ContigIter first, ContigIter last)
+{
+  constexpr bool Is_parallel =
+      std::same_as<std::decay_t<ExPo>, std::execution::parallel_policy> ||
+      std::same_as<std::decay_t<ExPo>,
+                   std::execution::parallel_unsequenced_policy>;
+  details::Adl_radix_sort_strings<Order, Is_parallel>(
+      std::to_address(first), static_cast<std::size_t>(last - first));
 }
 
-// TODO
 namespace experimental {
 // You might use this version, as it has lower memory overhead and high
 // performance when the passed-in type <Value_t> is large.
@@ -2082,7 +3302,7 @@ void radix_sort_indexed_impl(std::execution::sequenced_policy, ContigIter First,
 
   static_assert(
       details::ArithmeticKey<Key_t>,
-      "Key type must be arithmetic (excluding bool and character types)");
+      "Key type must be arithmetic (excluding bool)");
   static_assert(!(sizeof(Key_t) == 1 && Radix_tp.Bucket_size == 65536U),
                 "Cannot use 65536 bucket size with 1-byte key type");
 
@@ -2188,55 +3408,6 @@ void radix_sort_indexed_impl(std::execution::sequenced_policy, ContigIter First,
     }
   }
 }
-enum class SortVariant
-{
-  Improved,
-  Indexed
-};
-constexpr std::size_t L1_CACHE_SIZE = 32 * 1024;
-constexpr std::size_t L2_CACHE_SIZE = 256 * 1024;
-constexpr std::size_t L3_CACHE_SIZE = 8 * 1024 * 1024;
-
-constexpr std::size_t DATA_THRESHOLD   = 10000;
-constexpr std::size_t STRUCT_THRESHOLD = 64;
-
-template<std::size_t StructSize, bool IsPOD>
-constexpr SortVariant select_sort_variant(std::size_t data_size)
-{
-  if (IsPOD) {
-    if (StructSize <= STRUCT_THRESHOLD || data_size < DATA_THRESHOLD) {
-      return SortVariant::Indexed;
-    }
-    return SortVariant::Improved;
-  } else {
-    return StructSize <= STRUCT_THRESHOLD ? SortVariant::Improved
-                                          : SortVariant::Indexed;
-  }
-}
-
-template<details::ContiguousIterator ContigIter>
-void dispatch_radix_sort(std::execution::sequenced_policy policy,
-                         ContigIter first, ContigIter last)
-{
-  using Value_t = std::iter_value_t<ContigIter>;
-
-  const std::size_t     data_size   = std::distance(first, last);
-  constexpr std::size_t struct_size = sizeof(Value_t);
-  constexpr bool        is_pod      = std::is_trivially_copyable_v<Value_t>;
-
-  const SortVariant variant = select_sort_variant<struct_size, is_pod>(data_size);
-
-  switch (variant) {
-  case SortVariant::Improved : break;
-  case SortVariant::Indexed  : break;
-  default :
-#ifdef __GNUC__  // GCC, Clang, ICC
-    __builtin_unreachable();
-#elif defined(_MSC_VER)  // msvc
-    __assume(false);
-#endif
-  }
-}
 }  // namespace experimental
 }  // namespace stdex
 
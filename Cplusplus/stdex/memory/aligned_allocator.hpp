@@ -110,10 +110,10 @@ public:
                    typename AlignedAllocator<void, Align>::const_pointer = 0)
   {
     constexpr size_type alignment = static_cast<size_type>(Align);
-    void* pointer = allocate_aligned_memory(alignment, count * sizeof(Type));
-    if (pointer == nullptr) { throw std::bad_alloc(); }
+    void* memory = allocate_aligned_memory(alignment, count * sizeof(Type));
+    if (memory == nullptr) { throw std::bad_alloc(); }
 
-    return reinterpret_cast<pointer>(pointer);
+    return reinterpret_cast<pointer>(memory);
   }
 
   void deallocate(pointer pointer, size_type) noexcept
@@ -175,10 +175,10 @@ public:
                    typename AlignedAllocator<void, Align>::const_pointer = 0)
   {
     constexpr size_type alignment = static_cast<size_type>(Align);
-    void* pointer = allocate_aligned_memory(alignment, count * sizeof(Type));
-    if (pointer == nullptr) { throw std::bad_alloc(); }
+    void* memory = allocate_aligned_memory(alignment, count * sizeof(Type));
+    if (memory == nullptr) { throw std::bad_alloc(); }
 
-    return reinterpret_cast<pointer>(pointer);
+    return reinterpret_cast<pointer>(memory);
   }
 
   void deallocate(pointer pointer, size_type) noexcept
@@ -0,0 +1,391 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#  include <sys/mman.h>
+#endif
+
+#include "aligned_allocator.hpp"
+
+namespace stdex {
+
+// ============================================================================
+// Huge-Page-Backed Blocks
+// ============================================================================
+
+inline constexpr std::size_t ArenaPageBytes     = 4096;
+inline constexpr std::size_t ArenaHugePageBytes = std::size_t { 2 } << 20;
+
+// Page-aligned memory straight from the OS. On Linux a block of at least one
+// huge page is aligned to ArenaHugePageBytes and advised for transparent huge
+// pages, so that walking a large arena costs one TLB entry per 2 MiB.
+// bytes must be a multiple of ArenaPageBytes.
+inline void* allocate_arena_block(std::size_t bytes)
+{
+#if defined(_WIN32)
+  // Large pages need SeLockMemoryPrivilege, plain pages are good enough here
+  return VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#elif defined(__unix__) || defined(__APPLE__)
+  const std::size_t alignment =
+      bytes >= ArenaHugePageBytes ? ArenaHugePageBytes : ArenaPageBytes;
+  const std::size_t mapped = bytes + alignment - ArenaPageBytes;
+  void* memory = mmap(nullptr, mapped, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED) return nullptr;
+
+  // Trim the mapping down to an aligned run of bytes
+  const auto start = reinterpret_cast<std::uintptr_t>(memory);
+  const auto first = (start + alignment - 1) & ~(alignment - 1);
+  if (first != start) {
+    munmap(memory, first - start);
+  }
+  if (const std::size_t tail = start + mapped - (first + bytes); tail != 0) {
+    munmap(reinterpret_cast<void*>(first + bytes), tail);
+  }
+#  if defined(MADV_HUGEPAGE)
+  if (alignment == ArenaHugePageBytes) {
+    madvise(reinterpret_cast<void*>(first), bytes, MADV_HUGEPAGE);
+  }
+#  endif
+  return reinterpret_cast<void*>(first);
+#else
+  return allocate_aligned_memory(ArenaPageBytes, bytes);
+#endif
+}
+
+inline void deallocate_arena_block(void* pointer, std::size_t bytes) noexcept
+{
+#if defined(_WIN32)
+  (void)bytes;
+  VirtualFree(pointer, 0, MEM_RELEASE);
+#elif defined(__unix__) || defined(__APPLE__)
+  munmap(pointer, bytes);
+#else
+  (void)bytes;
+  deallocate_aligned_memory(pointer);
+#endif
+}
+
+// ============================================================================
+// Monotonic Arena Resource (PMR compatible)
+// ============================================================================
+
+// Bump-pointer arena for "allocate a lot, free everything at once" work such
+// as one request or one frame. Allocation advances a cursor through a chain of
+// blocks of block_bytes (requests that do not fit get a block of their own);
+// deallocate only gives memory back when it undoes the latest allocation.
+// reset() rewinds to the first block in O(1) and keeps every block for reuse,
+// release() returns them to the OS. mark()/rewind() and ArenaScope free
+// everything allocated after a point, nested like a stack.
+// Not synchronized: give each thread its own arena, see thread_arena().
+class ArenaResource : public std::pmr::memory_resource
+{
+  struct Block;
+
+public:
+
+  static constexpr std::size_t DefaultBlockBytes = ArenaHugePageBytes;
+
+  // Chain of blocks and how far the arena got into it; used and high-water
+  // bytes count alignment padding and the unused tails of skipped blocks
+  struct Stats
+  {
+    std::size_t block_count      = 0;
+    std::size_t reserved_bytes   = 0;
+    std::size_t used_bytes       = 0;
+    std::size_t high_water_bytes = 0;
+  };
+
+  // A position in the arena, handed back to rewind()
+  class Marker
+  {
+    friend class ArenaResource;
+
+    Block*        block       = nullptr;
+    char*         cursor      = nullptr;
+    std::size_t   used_before = 0;
+  };
+
+  explicit ArenaResource(std::size_t block_bytes = DefaultBlockBytes)
+      : m_block_bytes(round_to_pages(std::max(block_bytes, ArenaPageBytes)))
+  {
+  }
+
+  ~ArenaResource() override { release(); }
+
+  ArenaResource(const ArenaResource&)             = delete;
+  ArenaResource& operator= (const ArenaResource&) = delete;
+
+  // Frees everything, keeping the blocks for the allocations that follow
+  void reset() noexcept
+  {
+    update_high_water();
+    m_current     = m_first;
+    m_cursor      = m_first != nullptr ? block_data(m_first) : nullptr;
+    m_end         = m_first != nullptr ? block_end(m_first) : nullptr;
+    m_used_before = 0;
+  }
+
+  // Frees everything and returns the blocks to the OS
+  void release() noexcept
+  {
+    update_high_water();
+    Block* block = m_first;
+    while (block != nullptr) {
+      Block* next = block->next;
+      deallocate_arena_block(block, block->bytes);
+      block = next;
+    }
+    m_first = m_current = nullptr;
+    m_cursor = m_end = nullptr;
+    m_used_before = m_block_count = m_reserved_bytes = 0;
+  }
+
+  [[nodiscard]] Marker mark() const noexcept
+  {
+    Marker marker;
+    marker.block       = m_current;
+    marker.cursor      = m_cursor;
+    marker.used_before = m_used_before;
+    return marker;
+  }
+
+  // Frees everything allocated since marker was taken; markers taken after it
+  // are invalidated, as is any marker once reset() or release() ran
+  void rewind(const Marker& marker) noexcept
+  {
+    if (marker.block == nullptr) {
+      // Taken before the first block existed
+      reset();
+      return;
+    }
+    update_high_water();
+    m_current     = marker.block;
+    m_cursor      = marker.cursor;
+    m_end         = block_end(marker.block);
+    m_used_before = marker.used_before;
+  }
+
+  [[nodiscard]] Stats stats() const noexcept
+  {
+    Stats stats;
+    stats.block_count      = m_block_count;
+    stats.reserved_bytes   = m_reserved_bytes;
+    stats.used_bytes       = used_bytes();
+    stats.high_water_bytes = std::max(m_high_water_bytes, stats.used_bytes);
+    return stats;
+  }
+
+protected:
+
+  [[nodiscard]] void* do_allocate(std::size_t bytes,
+                                  std::size_t alignment) override
+  {
+    if ((alignment & (alignment - 1)) != 0) [[unlikely]] {
+      throw std::invalid_argument("alignment must be power of 2");
+    }
+
+    char*             pointer = align_up(m_cursor, alignment);
+    const std::size_t padding = static_cast<std::size_t>(pointer - m_cursor);
+    const std::size_t room    = static_cast<std::size_t>(m_end - m_cursor);
+    if (m_current == nullptr || room < padding || room - padding < bytes)
+        [[unlikely]] {
+      next_block(bytes, alignment);
+      pointer = align_up(m_cursor, alignment);
+    }
+    m_cursor = pointer + bytes;
+    return pointer;
+  }
+
+  void do_deallocate(void* pointer, std::size_t bytes,
+                     std::size_t /*alignment*/) override
+  {
+    // Freeing the latest allocation hands it back, so temporaries freed in
+    // stack order do not use up the arena
+    if (static_cast<char*>(pointer) + bytes == m_cursor) {
+      update_high_water();
+      m_cursor = static_cast<char*>(pointer);
+    }
+  }
+
+  [[nodiscard]] bool
+  do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+  {
+    return this == &other;
+  }
+
+private:
+
+  // Header at the start of every block, data follows at HeaderBytes
+  struct Block
+  {
+    Block*      next;
+    std::size_t bytes;
+  };
+
+  static constexpr std::size_t HeaderBytes =
+      (sizeof(Block) + alignof(std::max_align_t) - 1) &
+      ~(alignof(std::max_align_t) - 1);
+
+  Block*      m_first          = nullptr;
+  Block*      m_current        = nullptr;
+  char*       m_cursor         = nullptr;
+  char*       m_end            = nullptr;
+  std::size_t m_used_before    = 0;  // Capacity of the blocks before m_current
+  std::size_t m_block_bytes;
+  std::size_t m_block_count      = 0;
+  std::size_t m_reserved_bytes   = 0;
+  std::size_t m_high_water_bytes = 0;
+
+  static std::size_t round_to_pages(std::size_t bytes) noexcept
+  {
+    return (bytes + ArenaPageBytes - 1) & ~(ArenaPageBytes - 1);
+  }
+
+  static char* align_up(char* pointer, std::size_t alignment) noexcept
+  {
+    const auto address = reinterpret_cast<std::uintptr_t>(pointer);
+    return pointer + (((address + alignment - 1) & ~(alignment - 1)) - address);
+  }
+
+  static char* block_data(Block* block) noexcept
+  {
+    return reinterpret_cast<char*>(block) + HeaderBytes;
+  }
+
+  static char* block_end(Block* block) noexcept
+  {
+    return reinterpret_cast<char*>(block) + block->bytes;
+  }
+
+  std::size_t used_bytes() const noexcept
+  {
+    return m_current != nullptr
+               ? m_used_before +
+                     static_cast<std::size_t>(m_cursor - block_data(m_current))
+               : 0;
+  }
+
+  void update_high_water() noexcept
+  {
+    m_high_water_bytes = std::max(m_high_water_bytes, used_bytes());
+  }
+
+  // Moves the cursor to the next block kept from before a reset() or
+  // rewind() if the request fits there, or to a new block linked in after
+  // the current one
+  void next_block(std::size_t bytes, std::size_t alignment)
+  {
+    // Data starts HeaderBytes into a page-aligned block
+    const std::size_t padding =
+        alignment > alignof(std::max_align_t) ? alignment - 1 : 0;
+    if (bytes > std::size_t(-1) - HeaderBytes - padding - ArenaPageBytes) {
+      throw std::bad_alloc();
+    }
+    const std::size_t needed = HeaderBytes + padding + bytes;
+
+    Block* next = m_current != nullptr ? m_current->next : m_first;
+    if (next == nullptr || next->bytes < needed) {
+      const std::size_t block_bytes =
+          std::max(m_block_bytes, round_to_pages(needed));
+      Block* block = static_cast<Block*>(allocate_arena_block(block_bytes));
+      if (block == nullptr) throw std::bad_alloc();
+
+      block->bytes = block_bytes;
+      block->next  = next;
+      if (m_current != nullptr) {
+        m_current->next = block;
+      } else {
+        m_first = block;
+      }
+      m_block_count += 1;
+      m_reserved_bytes += block_bytes;
+      next = block;
+    }
+
+    if (m_current != nullptr) {
+      m_used_before += static_cast<std::size_t>(m_end - block_data(m_current));
+    }
+    m_current = next;
+    m_cursor  = block_data(next);
+    m_end     = block_end(next);
+  }
+};
+
+// Rewinds an arena to where it was on construction, for the allocations of
+// one scope:
+//
+//   {
+//     stdex::ArenaScope scope(arena);
+//     std::pmr::vector<int> scratch(&arena);
+//     ...
+//   }  // scratch's memory is free again
+//
+// Containers using the arena must be gone before the scope ends.
+class ArenaScope
+{
+public:
+
+  explicit ArenaScope(ArenaResource& arena) noexcept
+      : m_arena(arena), m_marker(arena.mark())
+  {
+  }
+
+  ~ArenaScope() { m_arena.rewind(m_marker); }
+
+  ArenaScope(const ArenaScope&)             = delete;
+  ArenaScope& operator= (const ArenaScope&) = delete;
+
+private:
+
+  ArenaResource&        m_arena;
+  ArenaResource::Marker m_marker;
+};
+
+// The calling thread's own arena, created on first use and released when the
+// thread exits; its blocks are not touched until something is allocated
+inline ArenaResource& thread_arena()
+{
+  thread_local ArenaResource arena;
+  return arena;
+}
+}  // namespace stdex
+
+/*
+// Usage Examples:
+
+// Example 1: Per-request scratch memory
+void handle_request(const Request& request) {
+    stdex::ArenaResource& arena = stdex::thread_arena();
+    stdex::ArenaScope     scope(arena);
+
+    std::pmr::vector<std::pmr::string> fields(&arena);
+    for (const auto& field : request.fields) {
+        fields.emplace_back(field);
+    }
+    // ...
+}  // everything above is freed at once
+
+// Example 2: Per-frame allocator, reset once a frame
+stdex::ArenaResource frame_arena;
+
+void render_frame() {
+    frame_arena.reset();
+    stdex::PolymorphicAllocator<Vertex> alloc(&frame_arena);
+    std::vector<Vertex, stdex::PolymorphicAllocator<Vertex>> vertices(alloc);
+    // ...
+    auto stats = frame_arena.stats();
+    std::cout << "frame high water: " << stats.high_water_bytes << std::endl;
+}
+*/
@@ -2,14 +2,19 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <memory>
 #include <memory_resource>
 #include <mutex>
 #include <new>
+#include <stdexcept>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 // Use aligned_allocator for aligned memory allocation
 #include "aligned_allocator.hpp"
@@ -68,15 +73,380 @@ struct LockStrategy<true>
 };
 
 // ============================================================================
-// Pool Allocator using Free-List Allocation Strategy
+// Synchronization Strategies for PoolAllocator
+// ============================================================================
+
+// The IsSynchronized parameter of PoolAllocator / PoolResource takes either a
+// bool (false = Unsynchronized, true = Mutex) or one of these
+enum class PoolSync
+{
+  Unsynchronized,  // No locking, single thread only
+  Mutex,           // One std::mutex per free list
+  ThreadCached     // Per-thread magazines over a lock-free central list
+};
+
+template<auto IsSynchronized>
+inline constexpr PoolSync pool_sync_v = [] {
+  if constexpr (std::is_same_v<decltype(IsSynchronized), bool>) {
+    return IsSynchronized ? PoolSync::Mutex : PoolSync::Unsynchronized;
+  } else {
+    static_assert(std::is_same_v<decltype(IsSynchronized), PoolSync>,
+                  "IsSynchronized must be a bool or a PoolSync");
+    return IsSynchronized;
+  }
+}();
+
+// ============================================================================
+// Size Classes
+// ============================================================================
+
+// jemalloc-style size classes: multiples of 16 up to 128 bytes, then four
+// classes per doubling (160, 192, 224, 256, 320, ...) up to MaxBytes. Rounding
+// a request up to its class wastes at most 15 bytes up to 128 bytes and at
+// most 20% above
+struct PoolSizeClasses
+{
+  static constexpr std::size_t MinBytes   = 16;
+  static constexpr std::size_t MaxBytes   = 4096;
+  static constexpr std::size_t ClassCount = 28;
+
+  static constexpr std::size_t size_of(std::size_t index) noexcept
+  {
+    return Sizes [index];
+  }
+
+  // Smallest class holding bytes whose size is a multiple of alignment, so
+  // that every node of a suitably aligned slab is aligned too; ClassCount if
+  // there is none
+  static constexpr std::size_t index_of(std::size_t bytes,
+                                        std::size_t alignment) noexcept
+  {
+    std::size_t index;
+    if (bytes <= 128) {
+      index = bytes <= MinBytes ? 0 : (bytes - 1) / MinBytes;
+    } else if (bytes <= MaxBytes) {
+      const std::size_t lg    = std::bit_width(bytes - 1);
+      const std::size_t shift = lg - 3;
+      index = (lg - 6) * 4 + ((bytes - 1) >> shift) - 4;
+    } else {
+      return ClassCount;
+    }
+    // Every class is a multiple of 16, larger alignments skip ahead
+    if (alignment > MinBytes) [[unlikely]] {
+      while (index < ClassCount && (Sizes [index] & (alignment - 1)) != 0) {
+        ++index;
+      }
+    }
+    return index;
+  }
+
+private:
+
+  static constexpr auto Sizes = [] {
+    std::array<std::size_t, ClassCount> sizes {};
+    for (std::size_t index = 0; index < ClassCount; ++index) {
+      if (index < 8) {
+        sizes [index] = MinBytes * (index + 1);
+      } else {
+        const std::size_t group = (index - 8) / 4;
+        const std::size_t step  = (index - 8) % 4 + 1;
+        sizes [index] = (std::size_t { 128 } << group) +
+            step * (std::size_t { 32 } << group);
+      }
+    }
+    return sizes;
+  }();
+};
+
+static_assert(PoolSizeClasses::size_of(PoolSizeClasses::ClassCount - 1) ==
+              PoolSizeClasses::MaxBytes);
+
+// ============================================================================
+// Thread-Caching Free Lists (PoolSync::ThreadCached)
+// ============================================================================
+
+// Every thread gets its own cache holding two magazines (node lists of up to
+// BatchSize nodes) per size class, so allocate/deallocate normally touch only
+// thread-local memory. A thread that fills both magazines hands one over to a
+// per-class lock-free central stack of batches, and a thread that runs dry
+// takes a whole batch back, so the shared state is touched once per BatchSize
+// operations. The central stack head carries a modification tag against ABA;
+// chunks are recorded on a push-only lock-free list. No path takes a mutex.
+//
+// A thread returns its magazines to the central stacks when it exits. The
+// shared state outlives the allocator while an exiting thread is flushing
+// into it, and a thread that exits after the allocator is gone just drops
+// its cache.
+template<std::size_t Alignment, std::size_t ClassCount,
+         std::uint32_t BatchSize = 32>
+class ThreadCachedFreeLists
+{
+public:
+
+  // Smallest node size: a free node holds the batch header below
+  static constexpr std::size_t MinBytes = 3 * sizeof(void*);
+
+  ThreadCachedFreeLists()
+      : m_state(std::make_shared<SharedState>()),
+        m_id(s_next_id.fetch_add(1, std::memory_order_relaxed))
+  {
+  }
+
+  ThreadCachedFreeLists(const ThreadCachedFreeLists&)             = delete;
+  ThreadCachedFreeLists& operator= (const ThreadCachedFreeLists&) = delete;
+
+  [[nodiscard]] void* allocate(std::size_t index, std::size_t size)
+  {
+    Magazines& magazines = local_cache().classes [index];
+
+    if (magazines.current.count == 0) [[unlikely]] {
+      if (magazines.previous.count != 0) {
+        std::swap(magazines.current, magazines.previous);
+      } else {
+        magazines.current = m_state->pop_batch(index);
+        if (magazines.current.count == 0) {
+          magazines.current = m_state->carve_batch(size);
+        }
+      }
+    }
+
+    Node* node              = magazines.current.head;
+    magazines.current.head  = node->next;
+    magazines.current.count -= 1;
+    return node;
+  }
+
+  void deallocate(void* pointer, std::size_t index)
+  {
+    Magazines& magazines = local_cache().classes [index];
+
+    // previous is always either empty or a full batch
+    if (magazines.current.count == BatchSize) [[unlikely]] {
+      if (magazines.previous.count != 0) {
+        m_state->push_batch(index, magazines.previous);
+      }
+      magazines.previous = magazines.current;
+      magazines.current  = {};
+    }
+
+    Node* node             = static_cast<Node*>(pointer);
+    node->next             = magazines.current.head;
+    magazines.current.head = node;
+    magazines.current.count += 1;
+  }
+
+private:
+
+  // Header written into a free node; the batch fields are only meaningful on
+  // the first node of a batch sitting in the central stack
+  struct Node
+  {
+    Node*         next;
+    Node*         next_batch;
+    std::uint32_t count;
+  };
+
+  static_assert(sizeof(Node) <= MinBytes);
+
+
+  struct Magazine
+  {
+    Node*         head  = nullptr;
+    std::uint32_t count = 0;
+  };
+
+  struct Magazines
+  {
+    Magazine current;
+    Magazine previous;
+  };
+
+  struct ThreadCache
+  {
+    std::array<Magazines, ClassCount> classes {};
+  };
+
+  // Central stack head: pointer in the low bits, modification tag in the rest
+  static constexpr unsigned      PointerBits = sizeof(void*) == 8 ? 48 : 32;
+  static constexpr std::uint64_t PointerMask =
+      (std::uint64_t { 1 } << PointerBits) - 1;
+
+  struct alignas(64) CentralList
+  {
+    std::atomic<std::uint64_t> head { 0 };
+  };
+
+  struct SharedState
+  {
+    std::array<CentralList, ClassCount> central;
+    std::atomic<void*>                  chunks { nullptr };
+
+    ~SharedState()
+    {
+      void* chunk = chunks.load(std::memory_order_acquire);
+      while (chunk != nullptr) {
+        void* next = *static_cast<void**>(chunk);
+        deallocate_aligned_memory(chunk);
+        chunk = next;
+      }
+    }
+
+    Magazine pop_batch(std::size_t index) noexcept
+    {
+      std::atomic<std::uint64_t>& head = central [index].head;
+
+      std::uint64_t old_head = head.load(std::memory_order_acquire);
+      Node*         batch;
+      std::uint64_t new_head;
+      do {
+        batch = reinterpret_cast<Node*>(
+            static_cast<std::uintptr_t>(old_head & PointerMask));
+        if (batch == nullptr) return {};
+        // batch may already be owned by another thread; the read is then
+        // stale but harmless because the tag makes the exchange fail
+        Node* next = std::atomic_ref<Node*>(batch->next_batch)
+                         .load(std::memory_order_relaxed);
+        new_head = ((old_head & ~PointerMask) + (PointerMask + 1)) |
+            reinterpret_cast<std::uintptr_t>(next);
+      } while (!head.compare_exchange_weak(old_head, new_head,
+                                           std::memory_order_acquire,
+                                           std::memory_order_acquire));
+      return { batch, batch->count };
+    }
+
+    void push_batch(std::size_t index, Magazine batch) noexcept
+    {
+      std::atomic<std::uint64_t>& head = central [index].head;
+
+      batch.head->count = batch.count;
+
+      std::uint64_t old_head = head.load(std::memory_order_relaxed);
+      std::uint64_t new_head;
+      do {
+        std::atomic_ref<Node*>(batch.head->next_batch)
+            .store(reinterpret_cast<Node*>(
+                       static_cast<std::uintptr_t>(old_head & PointerMask)),
+                   std::memory_order_relaxed);
+        new_head = ((old_head & ~PointerMask) + (PointerMask + 1)) |
+            reinterpret_cast<std::uintptr_t>(batch.head);
+      } while (!head.compare_exchange_weak(old_head, new_head,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed));
+    }
+
+    // New chunk of one header slot plus BatchSize nodes of the given size
+    Magazine carve_batch(std::size_t size)
+    {
+      char* chunk = static_cast<char*>(allocate_aligned_memory(
+          Alignment, (size * (BatchSize + 1) + Alignment - 1) & ~(Alignment - 1)));
+      if (chunk == nullptr) throw std::bad_alloc();
+
+      void* old_chunks = chunks.load(std::memory_order_relaxed);
+      do {
+        *reinterpret_cast<void**>(chunk) = old_chunks;
+      } while (!chunks.compare_exchange_weak(old_chunks, chunk,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed));
+
+      Node* head = nullptr;
+      for (std::uint32_t i = BatchSize; i > 0; --i) {
+        Node* node = reinterpret_cast<Node*>(chunk + size * i);
+        node->next = head;
+        head       = node;
+      }
+      return { head, BatchSize };
+    }
+
+    void release(ThreadCache& cache) noexcept
+    {
+      for (std::size_t index = 0; index < ClassCount; ++index) {
+        for (Magazine* magazine : { &cache.classes [index].current,
+                                    &cache.classes [index].previous }) {
+          if (magazine->count != 0) push_batch(index, *magazine);
+          *magazine = {};
+        }
+      }
+    }
+  };
+
+  struct CacheSlot
+  {
+    std::uint64_t                id;
+    std::weak_ptr<SharedState>   state;
+    std::unique_ptr<ThreadCache> cache;
+  };
+
+  struct CacheRegistry
+  {
+    std::vector<CacheSlot> slots;
+
+    ~CacheRegistry()
+    {
+      t_last_id = 0;
+      for (CacheSlot& slot : slots) {
+        if (auto state = slot.state.lock()) state->release(*slot.cache);
+      }
+    }
+  };
+
+  // One-entry lookup cache in front of the registry: the common case of a
+  // thread using a single allocator costs one thread-local compare
+  static inline thread_local std::uint64_t t_last_id    = 0;
+  static inline thread_local ThreadCache*  t_last_cache = nullptr;
+  static inline std::atomic<std::uint64_t> s_next_id { 1 };
+
+  std::shared_ptr<SharedState> m_state;
+  std::uint64_t                m_id;
+
+  ThreadCache& local_cache()
+  {
+    if (t_last_id == m_id) [[likely]]
+      return *t_last_cache;
+    return attach_cache();
+  }
+
+  ThreadCache& attach_cache()
+  {
+    static thread_local CacheRegistry registry;
+
+    auto slot = std::find_if(
+        registry.slots.begin(), registry.slots.end(),
+        [this](const CacheSlot& entry) { return entry.id == m_id; });
+
+    if (slot == registry.slots.end()) {
+      // Drop caches of allocators that no longer exist
+      std::erase_if(registry.slots, [](const CacheSlot& entry) {
+        return entry.state.expired();
+      });
+      registry.slots.push_back(
+          { m_id, m_state, std::make_unique<ThreadCache>() });
+      slot = std::prev(registry.slots.end());
+    }
+
+    t_last_id    = m_id;
+    t_last_cache = slot->cache.get();
+    return *t_last_cache;
+  }
+};
+
+// ============================================================================
+// Pool Allocator using Size-Class Slabs
 // ============================================================================
 
 // Optimized for small, frequently allocated objects
-// Combines aligned allocation with free-list management
+// Requests up to PoolSizeClasses::MaxBytes with an alignment of at most
+// Alignment are served from slabs of their size class; larger ones go to the
+// system allocator. A slab is one or more pages, aligned to its own size so
+// that a node finds its slab header by masking its address, and holds at
+// least 8 nodes. Each slab keeps its own free list, a class allocates from
+// the slabs on its partial list, and a slab that empties is returned to the
+// system unless it is the last one with room left in its class.
+// With PoolSync::ThreadCached, nodes move between per-thread caches instead
+// and their memory is only released with the allocator.
 // Similar to FastAllocator: configurable alignment and POD optimization
-template<bool        IsSynchronized = false,
-         std::size_t Alignment      = 64,   // Cache-line alignment by default
-         bool        OptimizePOD    = true  // Skip construction for POD types
+template<auto        IsSynchronized = false,  // bool or PoolSync
+         std::size_t Alignment      = 64,     // Largest alignment served from slabs
+         bool        OptimizePOD    = true    // Skip construction for POD types
          >
 class PoolAllocator
 {
@@ -88,19 +458,30 @@ public:
   static_assert((Alignment & (Alignment - 1)) == 0,
                 "Alignment must be power of 2");
 
-  PoolAllocator() : m_free_lists {}
+  // Memory held in slabs and the part of it handed out, in class sizes
+  struct Stats
+  {
+    std::size_t slab_count      = 0;
+    std::size_t slab_bytes      = 0;
+    std::size_t allocated_bytes = 0;
+  };
+
+  PoolAllocator() : m_classes {}
   {
     static_assert(Alignment > 0, "Alignment must be positive");
   }
 
   virtual ~PoolAllocator()
   {
-    if constexpr (IsSynchronized) {
-      std::lock_guard<std::mutex> global_lock(m_global_mutex);
+    for (SizeClass& size_class : m_classes) {
+      Slab* slab = size_class.all;
+      while (slab != nullptr) {
+        Slab* next = slab->all_next;
+        deallocate_aligned_memory(slab);
+        slab = next;
+      }
+      size_class = {};
     }
-    std::fill(m_free_lists.begin(), m_free_lists.end(), nullptr);
-    std::for_each(m_memory_chunks.begin(), m_memory_chunks.end(),
-                  deallocate_aligned_memory);
   }
 
   PoolAllocator(const PoolAllocator&)             = delete;
@@ -113,28 +494,45 @@ public:
       throw std::invalid_argument("alignment must be power of 2");
     }
 
+    const std::size_t index = class_index(bytes, alignment);
+
     // Large allocations or high alignment requirements go to system allocator
-    if (bytes > MaxBytes || alignment > Alignment) {
-      void* pointer =
-          allocate_aligned_memory(std::max(alignment, Alignment), bytes);
+    if (index == ClassCount) {
+      // aligned_alloc wants the size to be a multiple of the alignment
+      const std::size_t system_alignment = std::max(alignment, Alignment);
+      void*             pointer          = allocate_aligned_memory(
+          system_alignment,
+          (std::max<std::size_t>(bytes, 1) + system_alignment - 1) &
+              ~(system_alignment - 1));
       if (!pointer) throw std::bad_alloc();
       return pointer;
     }
 
-    const std::size_t rounded_bytes = round_up(bytes);
-    const std::size_t index         = free_list_index(rounded_bytes);
+    if constexpr (SyncMode == PoolSync::ThreadCached) {
+      return m_thread_cached.allocate(index, PoolSizeClasses::size_of(index));
+    }
 
-    {
-      auto lock = make_list_lock(index);
+    auto       lock       = make_list_lock(index);
+    SizeClass& size_class = m_classes [index];
 
-      if (Node* current = m_free_lists [index]) {
-        m_free_lists [index] = current->next;
-        return current;
-      }
+    Slab* slab = size_class.partial;
+    if (slab == nullptr) [[unlikely]] {
+      slab = new_slab(index);
     }
 
-    // Free list empty, refill it
-    return refill(rounded_bytes);
+    void* node;
+    if (slab->free != nullptr) {
+      node       = slab->free;
+      slab->free = slab->free->next;
+    } else {
+      node = slab_data(slab) + slab->carved * PoolSizeClasses::size_of(index);
+      slab->carved += 1;
+    }
+    size_class.used += 1;
+    if (++slab->used == SlabCapacity [index]) {
+      unlink_partial(size_class, slab);
+    }
+    return node;
   }
 
   void deallocate(void* pointer, std::size_t bytes, std::size_t alignment)
@@ -142,18 +540,52 @@ public:
     if (pointer == nullptr) [[unlikely]]
       return;
 
-    if (bytes > MaxBytes || alignment > Alignment) {
+    const std::size_t index = class_index(bytes, alignment);
+
+    if (index == ClassCount) {
       deallocate_aligned_memory(pointer);
       return;
     }
 
-    const std::size_t index = free_list_index(round_up(bytes));
+    if constexpr (SyncMode == PoolSync::ThreadCached) {
+      m_thread_cached.deallocate(pointer, index);
+      return;
+    }
+
+    auto       lock       = make_list_lock(index);
+    SizeClass& size_class = m_classes [index];
+    Slab*      slab       = reinterpret_cast<Slab*>(
+        reinterpret_cast<std::uintptr_t>(pointer) & ~(SlabBytes [index] - 1));
 
-    auto lock = make_list_lock(index);
+    Node* released = static_cast<Node*>(pointer);
+    released->next = slab->free;
+    slab->free     = released;
+    size_class.used -= 1;
 
-    Node* released       = reinterpret_cast<Node*>(pointer);
-    released->next       = m_free_lists [index];
-    m_free_lists [index] = released;
+    if (slab->used-- == SlabCapacity [index]) {
+      link_partial(size_class, slab);
+    }
+    // Keep the last slab with room in the class around, so that a class
+    // going back and forth across a slab boundary does not thrash
+    if (slab->used == 0 &&
+        (size_class.partial != slab || slab->next != nullptr)) {
+      unlink_partial(size_class, slab);
+      release_slab(size_class, slab);
+    }
+  }
+
+  [[nodiscard]] Stats stats()
+    requires(pool_sync_v<IsSynchronized> != PoolSync::ThreadCached)
+  {
+    Stats stats;
+    for (std::size_t index = 0; index < ClassCount; ++index) {
+      auto lock = make_list_lock(index);
+      stats.slab_count += m_classes [index].slab_count;
+      stats.slab_bytes += m_classes [index].slab_count * SlabBytes [index];
+      stats.allocated_bytes +=
+          m_classes [index].used * PoolSizeClasses::size_of(index);
+    }
+    return stats;
   }
 
   // Construct with POD optimization (similar to FastAllocator)
@@ -183,102 +615,148 @@ public:
 
 protected:
 
+  static constexpr PoolSync SyncMode  = pool_sync_v<IsSynchronized>;
+  static constexpr bool     UsesMutex = SyncMode == PoolSync::Mutex;
+
+  static constexpr std::size_t ClassCount = PoolSizeClasses::ClassCount;
+
   union Node
   {
     union Node* next;
     char        data [1] alignas(sizeof(void*));
   };
 
-  static constexpr std::size_t MaxBytes        = 128;
-  static constexpr std::size_t FREE_LIST_COUNT = MaxBytes / Alignment;
+  // Header at the start of every slab, nodes follow at HeaderBytes
+  struct Slab
+  {
+    Slab*         prev;      // partial list of the class
+    Slab*         next;
+    Slab*         all_prev;  // every slab of the class
+    Slab*         all_next;
+    Node*         free;      // nodes handed back
+    std::uint32_t used;      // nodes handed out
+    std::uint32_t carved;    // nodes ever handed out, the rest are untouched
+  };
+
+  struct SizeClass
+  {
+    Slab*       partial    = nullptr;  // slabs with a free node
+    Slab*       all        = nullptr;
+    std::size_t slab_count = 0;
+    std::size_t used       = 0;
+  };
+
+  static constexpr std::size_t PageBytes    = 4096;
+  static constexpr std::size_t MinSlabNodes = 8;
+  static constexpr std::size_t HeaderBytes =
+      (sizeof(Slab) + std::max(Alignment, PoolSizeClasses::MinBytes) - 1) &
+      ~(std::max(Alignment, PoolSizeClasses::MinBytes) - 1);
+
+  // Smallest power-of-two number of pages holding MinSlabNodes nodes
+  static constexpr auto SlabBytes = [] {
+    std::array<std::size_t, ClassCount> bytes {};
+    for (std::size_t index = 0; index < ClassCount; ++index) {
+      bytes [index] = PageBytes;
+      while ((bytes [index] - HeaderBytes) / PoolSizeClasses::size_of(index) <
+             MinSlabNodes) {
+        bytes [index] *= 2;
+      }
+    }
+    return bytes;
+  }();
+
+  static constexpr auto SlabCapacity = [] {
+    std::array<std::uint32_t, ClassCount> capacity {};
+    for (std::size_t index = 0; index < ClassCount; ++index) {
+      capacity [index] = static_cast<std::uint32_t>(
+          (SlabBytes [index] - HeaderBytes) / PoolSizeClasses::size_of(index));
+    }
+    return capacity;
+  }();
 
-  std::array<Node*, FREE_LIST_COUNT> m_free_lists;
-  std::vector<char*>                 m_memory_chunks;
+  std::array<SizeClass, ClassCount> m_classes;
 
   using node_lock_arr_t =
-      std::conditional_t<IsSynchronized,
-                         std::array<std::mutex, FREE_LIST_COUNT>, Dummy>;
-  using global_lock_t = std::conditional_t<IsSynchronized, std::mutex, Dummy>;
+      std::conditional_t<UsesMutex, std::array<std::mutex, ClassCount>, dummy>;
+  using thread_cached_t =
+      std::conditional_t<SyncMode == PoolSync::ThreadCached,
+                         ThreadCachedFreeLists<Alignment, ClassCount>, dummy>;
 
   [[no_unique_address]] node_lock_arr_t m_list_mutexes {};
-  [[no_unique_address]] global_lock_t   m_global_mutex;
+  [[no_unique_address]] thread_cached_t m_thread_cached;
 
-  // Compile-time round up to alignment boundary
-  static constexpr std::size_t round_up(std::size_t bytes) noexcept
+  // Class of a request, or ClassCount for the system allocator
+  static constexpr std::size_t class_index(std::size_t bytes,
+                                           std::size_t alignment) noexcept
   {
-    return ((bytes + Alignment - 1) & ~(Alignment - 1));
+    if (alignment > Alignment) return ClassCount;
+    if constexpr (SyncMode == PoolSync::ThreadCached) {
+      bytes = std::max(bytes, thread_cached_t::MinBytes);
+    }
+    return PoolSizeClasses::index_of(bytes, alignment);
   }
 
-  // Compile-time compute free list index
-  static constexpr std::size_t free_list_index(std::size_t bytes) noexcept
+  static char* slab_data(Slab* slab) noexcept
   {
-    return (bytes / Alignment) - 1;
+    return reinterpret_cast<char*>(slab) + HeaderBytes;
   }
 
   // Helper to make lock on specific free list
   auto make_list_lock(std::size_t index)
   {
-    if constexpr (IsSynchronized) {
+    if constexpr (UsesMutex) {
       return std::lock_guard<std::mutex>(m_list_mutexes [index]);
     } else {
       return typename LockStrategy<false>::template EmptyLockGuard<
-          decltype(m_list_mutexes)> {};
+          decltype(m_list_mutexes)>(m_list_mutexes);
     }
   }
 
-  // Allocate memory chunk for free list using aligned allocation
-  char* chunk_alloc(std::size_t size, std::uint32_t& chunk_count)
+  static void link_partial(SizeClass& size_class, Slab* slab) noexcept
   {
-    const std::uint32_t min_chunk_count = 1;
-    while (chunk_count >= min_chunk_count) {
-      // Use aligned allocation (from AlignedAllocator)
-      char* chunk = reinterpret_cast<char*>(
-          allocate_aligned_memory(Alignment, size * chunk_count));
-      if (chunk != nullptr) {
-        if constexpr (IsSynchronized) {
-          std::lock_guard<std::mutex> global_lock(m_global_mutex);
-        }
-        m_memory_chunks.push_back(chunk);
-        return chunk;
-      }
-      // Allocation failed: halve and retry (minimum 1)
-      chunk_count = (chunk_count > min_chunk_count) ? (chunk_count >> 1)
-                                                    : min_chunk_count;
-    }
-    throw std::bad_alloc();
+    slab->prev = nullptr;
+    slab->next = size_class.partial;
+    if (size_class.partial != nullptr) size_class.partial->prev = slab;
+    size_class.partial = slab;
   }
 
-  // Refill free list with new memory chunk
-  void* refill(std::size_t size)
+  static void unlink_partial(SizeClass& size_class, Slab* slab) noexcept
   {
-    std::uint32_t chunk_count = 16;  // Allocate 16 nodes at a time
-    char*         chunk       = chunk_alloc(size, chunk_count);
-
-    // Only allocated 1 node: return directly
-    if (chunk_count == 1) return chunk;
-
-    // Allocated multiple nodes: build free list
-    const std::size_t index = free_list_index(size);
-
-    Node* return_node = reinterpret_cast<Node*>(chunk);
-    Node* head        = reinterpret_cast<Node*>(chunk + size);
-    Node* current     = head;
-
-    // Build linked list from remaining nodes
-    for (std::uint32_t i = 2; i < chunk_count; ++i) {
-      Node* next =
-          reinterpret_cast<Node*>(reinterpret_cast<char*>(current) + size);
-      current->next = next;
-      current       = next;
+    if (slab->prev != nullptr) {
+      slab->prev->next = slab->next;
+    } else {
+      size_class.partial = slab->next;
     }
-    current->next = nullptr;
+    if (slab->next != nullptr) slab->next->prev = slab->prev;
+  }
 
-    {
-      auto lock            = make_list_lock(index);
-      m_free_lists [index] = head;
-    }
+  // New empty slab, put on the partial list of its class
+  Slab* new_slab(std::size_t index)
+  {
+    Slab* slab = static_cast<Slab*>(
+        allocate_aligned_memory(SlabBytes [index], SlabBytes [index]));
+    if (slab == nullptr) throw std::bad_alloc();
+
+    SizeClass& size_class = m_classes [index];
+    *slab          = {};
+    slab->all_next = size_class.all;
+    if (size_class.all != nullptr) size_class.all->all_prev = slab;
+    size_class.all = slab;
+    size_class.slab_count += 1;
+    link_partial(size_class, slab);
+    return slab;
+  }
 
-    return return_node;
+  static void release_slab(SizeClass& size_class, Slab* slab) noexcept
+  {
+    if (slab->all_prev != nullptr) {
+      slab->all_prev->all_next = slab->all_next;
+    } else {
+      size_class.all = slab->all_next;
+    }
+    if (slab->all_next != nullptr) slab->all_next->all_prev = slab->all_prev;
+    size_class.slab_count -= 1;
+    deallocate_aligned_memory(slab);
   }
 };
 
@@ -286,7 +764,7 @@ protected:
 // Pool-Based Memory Resource (PMR compatible)
 // ============================================================================
 
-template<bool IsSynchronized = false>
+template<auto IsSynchronized = false>
 class PoolResource : public std::pmr::memory_resource
 {
 public:
@@ -297,6 +775,15 @@ public:
   PoolResource(const PoolResource&)             = delete;
   PoolResource& operator= (const PoolResource&) = delete;
 
+  using Stats = typename PoolAllocator<IsSynchronized, 64, true>::Stats;
+
+  // Slab usage, to tell how much memory rounding and partly used slabs cost
+  [[nodiscard]] Stats stats()
+    requires(pool_sync_v<IsSynchronized> != PoolSync::ThreadCached)
+  {
+    return m_allocator.stats();
+  }
+
 protected:
 
   [[nodiscard]] void* do_allocate(std::size_t bytes,
@@ -326,6 +813,7 @@ private:
 // Convenience aliases
 using SynchronizedPoolResource   = PoolResource<true>;
 using UnsynchronizedPoolResource = PoolResource<false>;
+using ThreadCachedPoolResource   = PoolResource<PoolSync::ThreadCached>;
 
 // ============================================================================
 // Polymorphic Allocator (PMR compatible)
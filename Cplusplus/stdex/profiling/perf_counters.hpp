@@ -0,0 +1,322 @@
+﻿#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+
+#if defined(__linux__)
+#  define STDEX_PERF_COUNTERS 1
+#  include <atomic>
+#  include <cstring>
+#  include <linux/perf_event.h>
+#  include <sys/mman.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#  if defined(__x86_64__) || defined(__i386__)
+#    include <x86intrin.h>
+#  endif
+#endif
+
+namespace stdex {
+
+// ============================================================================
+// Hardware Performance Counters
+// ============================================================================
+
+enum class PerfEvent : std::size_t
+{
+  Cycles,
+  Instructions,
+  CacheMisses,
+  BranchMisses,
+  LlcLoads,
+  DtlbMisses,
+};
+
+inline constexpr std::size_t PerfEventCount = 6;
+
+inline constexpr std::array<const char*, PerfEventCount> perf_event_names {
+  "cycles",        "instructions", "cache-misses",
+  "branch-misses", "LLC-loads",    "dTLB-misses",
+};
+
+// Counter values at one point, or counted between two once subtracted.
+// valid has bit i set when PerfEvent i is counted on this host. time_enabled
+// and time_running are the nanoseconds the group was enabled and actually on
+// the PMU; when the kernel multiplexed it with other events, running falls
+// behind enabled, and a difference extrapolates its counts by their ratio
+// and sets their bits in scaled. A difference over which the group never
+// ran counted nothing, and has no valid counter.
+struct PerfSample
+{
+  std::array<std::uint64_t, PerfEventCount> values {};
+  std::uint32_t                             valid        = 0;
+  std::uint32_t                             scaled       = 0;
+  std::uint64_t                             time_enabled = 0;
+  std::uint64_t                             time_running = 0;
+
+  bool has(PerfEvent event) const noexcept
+  {
+    return (valid >> static_cast<std::size_t>(event) & 1) != 0;
+  }
+
+  std::uint64_t operator[] (PerfEvent event) const noexcept
+  {
+    return values [static_cast<std::size_t>(event)];
+  }
+
+  friend PerfSample operator- (const PerfSample& end, const PerfSample& begin)
+  {
+    PerfSample delta;
+    delta.valid        = end.valid & begin.valid;
+    delta.time_enabled = end.time_enabled - begin.time_enabled;
+    delta.time_running = end.time_running - begin.time_running;
+    if (delta.time_running == 0) {
+      delta.valid = 0;
+    } else if (delta.time_running < delta.time_enabled) {
+      delta.scaled = delta.valid;
+    }
+    const double scale = delta.scaled != 0
+                             ? static_cast<double>(delta.time_enabled) /
+                                   static_cast<double>(delta.time_running)
+                             : 1.0;
+    for (std::size_t i = 0; i < PerfEventCount; ++i) {
+      const std::uint64_t count = end.values [i] - begin.values [i];
+      delta.values [i] =
+          delta.scaled != 0
+              ? static_cast<std::uint64_t>(static_cast<double>(count) * scale)
+              : count;
+    }
+    return delta;
+  }
+};
+
+// The counters of PerfEvent for the calling thread, user space only, opened
+// as one perf_event_open group so that they are scheduled together. Reading
+// uses rdpmc through each counter's mmap'd page where the kernel allows it
+// (a few ns, no system call) and read(2) otherwise. Events the host does not
+// have are left out of valid; in a container, a VM without a virtual PMU or
+// with perf_event_paranoid too strict, nothing is valid and read() returns an
+// empty sample. The PMU may have fewer counters than the group needs, or
+// share them with other perf users, in which case the kernel time-slices the
+// group and the sample's time_running says for how long it was counted. Only
+// the opening thread is counted: for work spread over a thread pool, read
+// the group of each worker.
+class PerfCounterGroup
+{
+public:
+
+  PerfCounterGroup()
+  {
+#if defined(STDEX_PERF_COUNTERS)
+    static constexpr std::array<std::pair<std::uint32_t, std::uint64_t>,
+                                PerfEventCount>
+        configs { {
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+            { PERF_TYPE_HW_CACHE,
+              PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16) },
+            { PERF_TYPE_HW_CACHE,
+              PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+        } };
+
+    const long page_bytes = sysconf(_SC_PAGESIZE);
+    int        leader     = -1;
+    for (std::size_t i = 0; i < PerfEventCount; ++i) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size           = sizeof(attr);
+      attr.type           = configs [i].first;
+      attr.config         = configs [i].second;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv     = 1;
+      attr.read_format =
+          PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      const int fd = static_cast<int>(
+          syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+      if (fd < 0) continue;
+      if (leader < 0) leader = fd;
+
+      Counter& counter = m_counters [i];
+      counter.fd       = fd;
+      void* page = mmap(nullptr, static_cast<std::size_t>(page_bytes),
+                        PROT_READ, MAP_SHARED, fd, 0);
+      counter.page = page != MAP_FAILED
+                         ? static_cast<const perf_event_mmap_page*>(page)
+                         : nullptr;
+      m_valid |= 1u << i;
+    }
+#endif
+  }
+
+  ~PerfCounterGroup()
+  {
+#if defined(STDEX_PERF_COUNTERS)
+    const long page_bytes = sysconf(_SC_PAGESIZE);
+    // Members before the leader, closing the leader dissolves the group
+    for (std::size_t i = PerfEventCount; i-- > 0;) {
+      Counter& counter = m_counters [i];
+      if (counter.page != nullptr) {
+        munmap(const_cast<perf_event_mmap_page*>(counter.page),
+               static_cast<std::size_t>(page_bytes));
+      }
+      if (counter.fd >= 0) close(counter.fd);
+    }
+#endif
+  }
+
+  PerfCounterGroup(const PerfCounterGroup&)             = delete;
+  PerfCounterGroup& operator= (const PerfCounterGroup&) = delete;
+
+  // The calling thread's group, opened on first use
+  static PerfCounterGroup& this_thread()
+  {
+    thread_local PerfCounterGroup group;
+    return group;
+  }
+
+  bool available() const noexcept { return m_valid != 0; }
+
+  std::uint32_t valid() const noexcept { return m_valid; }
+
+  PerfSample read() const noexcept
+  {
+    PerfSample sample;
+    sample.valid = m_valid;
+#if defined(STDEX_PERF_COUNTERS)
+    bool timed = false;
+    for (std::size_t i = 0; i < PerfEventCount; ++i) {
+      if ((m_valid >> i & 1) != 0) {
+        const Reading reading = read_counter(m_counters [i]);
+        sample.values [i]     = reading.count;
+        // The group is scheduled as a whole, the leader's times are all
+        if (!timed) {
+          sample.time_enabled = reading.time_enabled;
+          sample.time_running = reading.time_running;
+          timed               = true;
+        }
+      }
+    }
+#endif
+    return sample;
+  }
+
+private:
+
+#if defined(STDEX_PERF_COUNTERS)
+  struct Counter
+  {
+    int                         fd   = -1;
+    const perf_event_mmap_page* page = nullptr;
+  };
+
+  std::array<Counter, PerfEventCount> m_counters {};
+
+  struct Reading
+  {
+    std::uint64_t count        = 0;
+    std::uint64_t time_enabled = 0;
+    std::uint64_t time_running = 0;
+  };
+
+  // The self-monitoring sequence of perf_event_mmap_page: the kernel bumps
+  // lock around updates of index, offset and the times, so retry until it
+  // is stable. The times on the page are those of the last context switch;
+  // the TSC conversion fields bring them up to now
+  static Reading read_counter(const Counter& counter) noexcept
+  {
+    Reading reading;
+#  if defined(__x86_64__) || defined(__i386__)
+    const volatile perf_event_mmap_page* page = counter.page;
+    if (page != nullptr && page->cap_user_rdpmc && page->cap_user_time) {
+      std::uint32_t sequence;
+      do {
+        sequence = page->lock;
+        std::atomic_signal_fence(std::memory_order_acq_rel);
+        const std::uint32_t index = page->index;
+        reading.count        = static_cast<std::uint64_t>(page->offset);
+        reading.time_enabled = page->time_enabled;
+        reading.time_running = page->time_running;
+        const std::uint64_t cycles = __rdtsc();
+        const unsigned      shift  = page->time_shift;
+        const std::uint64_t mult   = page->time_mult;
+        const std::uint64_t since =
+            page->time_offset + (cycles >> shift) * mult +
+            (((cycles & ((std::uint64_t { 1 } << shift) - 1)) * mult) >>
+             shift);
+        reading.time_enabled += since;
+        // index is 0 while the group is off the PMU, offset is exact then
+        if (index != 0) {
+          reading.time_running += since;
+          const unsigned width = page->pmc_width;
+          auto           pmc   = static_cast<std::uint64_t>(
+              __rdpmc(static_cast<int>(index - 1)));
+          pmc <<= 64 - width;
+          reading.count += static_cast<std::uint64_t>(
+              static_cast<std::int64_t>(pmc) >> (64 - width));
+        }
+        std::atomic_signal_fence(std::memory_order_acq_rel);
+      } while (page->lock != sequence);
+      return reading;
+    }
+#  endif
+    // read_format lays out value, time_enabled, time_running
+    std::uint64_t values [3] {};
+    if (::read(counter.fd, values, sizeof(values)) == sizeof(values)) {
+      reading = { values [0], values [1], values [2] };
+    }
+    return reading;
+  }
+#endif
+
+  std::uint32_t m_valid = 0;
+};
+
+// Writes the ratios that tell compute-bound from memory-bound code: IPC, and
+// each counter per element of work; "-" for counters the host lacks or that
+// were never scheduled, and the share of time counted when it was multiplexed
+inline void print_perf_sample(std::ostream& out, const PerfSample& delta,
+                              std::uint64_t elements = 1)
+{
+  if (delta.valid == 0 && delta.time_enabled == 0) {
+    out << "(hardware counters unavailable)";
+    return;
+  }
+  const auto flags     = out.flags();
+  const auto precision = out.precision();
+  out << std::fixed << std::setprecision(2);
+  out << "IPC ";
+  if (delta.has(PerfEvent::Cycles) && delta.has(PerfEvent::Instructions) &&
+      delta [PerfEvent::Cycles] != 0) {
+    out << static_cast<double>(delta [PerfEvent::Instructions]) /
+               static_cast<double>(delta [PerfEvent::Cycles]);
+  } else {
+    out << '-';
+  }
+  const double per = elements != 0 ? static_cast<double>(elements) : 1.0;
+  for (std::size_t i = 0; i < PerfEventCount; ++i) {
+    out << ", " << perf_event_names [i] << "/elem ";
+    if ((delta.valid >> i & 1) != 0) {
+      out << static_cast<double>(delta.values [i]) / per;
+    } else {
+      out << '-';
+    }
+  }
+  if (delta.scaled != 0) {
+    out << " (scaled, counted "
+        << 100.0 * static_cast<double>(delta.time_running) /
+               static_cast<double>(delta.time_enabled)
+        << "% of the time)";
+  }
+  out.flags(flags);
+  out.precision(precision);
+}
+}  // namespace stdex
@@ -1,135 +1,1022 @@
 ﻿#pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <map>
-#include <set>
+#include <memory>
+#include <mutex>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#include "perf_counters.hpp"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+    defined(_M_IX86)
+#  define STDEX_PROFILER_RDTSC 1
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#  else
+#    include <cpuid.h>
+#    include <x86intrin.h>
+#  endif
+#endif
+
 namespace stdex {
-// Scope-based profiler for measuring execution time
-// Records timing statistics for different code sections
-class ScopeProfiler
+
+// ============================================================================
+// Profiler Clock
+// ============================================================================
+
+// Raw timestamps for the profiler hot path: the TSC where it ticks at a
+// constant rate across cores and sleep states, steady_clock nanoseconds
+// elsewhere. Ticks are converted to nanoseconds only when they are reported,
+// with a factor calibrated against steady_clock once.
+class ProfilerClock
 {
 public:
 
-  using ClockType = std::chrono::high_resolution_clock;
+  static std::uint64_t now() noexcept
+  {
+#if defined(STDEX_PROFILER_RDTSC)
+    if (s_invariant_tsc) { return __rdtsc(); }
+#endif
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+  }
 
-  struct Record
+  static double nanoseconds_per_tick() noexcept
   {
-    const char* tag;
-    int         microseconds;
-  };
+    static const double factor = calibrate();
+    return factor;
+  }
+
+  static std::uint64_t to_nanoseconds(std::uint64_t ticks) noexcept
+  {
+    return static_cast<std::uint64_t>(static_cast<double>(ticks) *
+                                      nanoseconds_per_tick());
+  }
 
 private:
 
-  inline thread_local static std::vector<Record> m_Records;
+  static bool detect_invariant_tsc() noexcept
+  {
+#if defined(STDEX_PROFILER_RDTSC) && defined(_MSC_VER)
+    int registers [4] {};
+    __cpuid(registers, 0x80000000);
+    if (static_cast<unsigned>(registers [0]) < 0x80000007u) return false;
+    __cpuid(registers, 0x80000007);
+    return (registers [3] & (1 << 8)) != 0;
+#elif defined(STDEX_PROFILER_RDTSC)
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (__get_cpuid_max(0x80000000, nullptr) < 0x80000007u) return false;
+    __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+    return (edx & (1u << 8)) != 0;
+#else
+    return false;
+#endif
+  }
+
+  // Spins for about 10ms, once, the first time a report needs it
+  static double calibrate() noexcept
+  {
+    if (!s_invariant_tsc) return 1.0;
+    using std::chrono::steady_clock;
+    const auto          begin       = steady_clock::now();
+    const std::uint64_t begin_ticks = now();
+    auto                end         = begin;
+    while (end - begin < std::chrono::milliseconds(10)) {
+      end = steady_clock::now();
+    }
+    const std::uint64_t end_ticks = now();
+    const auto          elapsed =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin);
+    return static_cast<double>(elapsed.count()) /
+           static_cast<double>(end_ticks - begin_ticks);
+  }
 
-  ClockType::time_point m_Begin;
-  const char*           m_Tag;
+  inline static const bool s_invariant_tsc = detect_invariant_tsc();
+};
 
-  inline ScopeProfiler(const char* tag, ClockType::time_point start);
-  inline void on_destroy(ClockType::time_point end);
+// ============================================================================
+// Log-Linear Histogram
+// ============================================================================
 
+// HDR-style histogram over 64-bit values: exact below 16, then 16 linear
+// buckets per power of two, so a percentile read from it is off by at most
+// 1/16 of the value. Fixed size, no allocation when recording.
+class LogLinearHistogram
+{
 public:
 
-  explicit ScopeProfiler(const char* tag) : ScopeProfiler(tag, ClockType::now())
+  static constexpr std::size_t SubBucketBits = 4;
+  static constexpr std::size_t SubBuckets    = std::size_t { 1 }
+                                            << SubBucketBits;
+  static constexpr std::size_t BucketCount =
+      (64 - SubBucketBits + 1) * SubBuckets;
+
+  void record(std::uint64_t value) noexcept
   {
+    m_counts [index_of(value)] += 1;
+    m_count += 1;
+    m_total += value;
+    m_min = m_count == 1 ? value : std::min(m_min, value);
+    m_max = std::max(m_max, value);
   }
 
-  ~ScopeProfiler() { on_destroy(ClockType::now()); }
+  std::uint64_t count() const noexcept { return m_count; }
+  std::uint64_t total() const noexcept { return m_total; }
+  std::uint64_t min() const noexcept { return m_min; }
+  std::uint64_t max() const noexcept { return m_max; }
 
-  static const std::vector<Record>& get_records() { return m_Records; }
+  // Value below which a fraction of the recorded values lie, taken as the
+  // middle of its bucket and clamped to the recorded range
+  std::uint64_t percentile(double fraction) const noexcept
+  {
+    if (m_count == 0) return 0;
+    const auto rank = static_cast<std::uint64_t>(
+        fraction * static_cast<double>(m_count - 1));
+    std::uint64_t seen = 0;
+    for (std::size_t index = 0; index < BucketCount; ++index) {
+      seen += m_counts [index];
+      if (seen > rank) {
+        const std::uint64_t lower = lower_bound_of(index);
+        const std::uint64_t upper =
+            index + 1 < BucketCount ? lower_bound_of(index + 1) - 1 : m_max;
+        return std::clamp(lower + (upper - lower) / 2, m_min, m_max);
+      }
+    }
+    return m_max;
+  }
 
-  static void print_log(std::ostream& out = std::cout);
+  static constexpr std::size_t index_of(std::uint64_t value) noexcept
+  {
+    if (value < SubBuckets) return static_cast<std::size_t>(value);
+    const std::size_t exponent = std::bit_width(value) - 1;
+    const std::size_t sub =
+        static_cast<std::size_t>(value >> (exponent - SubBucketBits)) &
+        (SubBuckets - 1);
+    return (exponent - SubBucketBits + 1) * SubBuckets + sub;
+  }
+
+  static constexpr std::uint64_t lower_bound_of(std::size_t index) noexcept
+  {
+    if (index < SubBuckets) return index;
+    const std::size_t exponent = index / SubBuckets + SubBucketBits - 1;
+    const std::size_t sub      = index % SubBuckets;
+    return std::uint64_t { SubBuckets + sub } << (exponent - SubBucketBits);
+  }
+
+private:
+
+  std::array<std::uint64_t, BucketCount> m_counts {};
+  std::uint64_t                          m_count = 0;
+  std::uint64_t                          m_total = 0;
+  std::uint64_t                          m_min   = 0;
+  std::uint64_t                          m_max   = 0;
 };
 
-ScopeProfiler::ScopeProfiler(const char* tag, ClockType::time_point start)
-    : m_Begin(start), m_Tag(tag)
-{
-}
+static_assert(LogLinearHistogram::index_of(~std::uint64_t { 0 }) ==
+              LogLinearHistogram::BucketCount - 1);
 
-void ScopeProfiler::on_destroy(ClockType::time_point end)
-{
-  auto diff = end - m_Begin;
-  int  microseconds =
-      std::chrono::duration_cast<std::chrono::microseconds>(diff).count();
-  m_Records.push_back({ m_Tag, microseconds });
-}
+// ============================================================================
+// Scope Profiler
+// ============================================================================
 
-void ScopeProfiler::print_log(std::ostream& out)
+// Scope-based profiler for measuring execution time
+// Records timing statistics for different code sections. Each thread writes
+// (tag, duration) records into its own fixed-size ring buffer: recording is
+// two timestamps and a store, with no lock and no allocation. The rings are
+// linked into a global registry that collect() drains from any thread into
+// one log-linear histogram per tag, so a reporter thread sees every thread's
+// scopes. A ring that fills up before it is collected overwrites its oldest
+// records, which are counted as dropped.
+// With enable_trace(), sampled scopes also leave a trace event (begin, end,
+// thread, nesting depth) in a second per-thread ring of TraceCapacity events,
+// which TraceWriter streams out as Chrome trace JSON or a binary format.
+// ScopeCounters scopes add hardware counter deltas (see perf_counters.hpp) in
+// a third per-thread ring, reported per element of work next to the times.
+class ScopeProfiler
 {
-  if (m_Records.empty()) { return; }
+public:
 
+  // Records held per thread between two collect() calls
+  static constexpr std::size_t RingCapacity = std::size_t { 1 } << 13;
+
+  // Per-tag summary, in nanoseconds
   struct Statistic
   {
-    int         max_microseconds   = 0;
-    int         min_microseconds   = 0;
-    int         total_microseconds = 0;
-    int         count              = 0;
-    const char* tag                = nullptr;
+    std::string_view tag;
+    std::uint64_t    count    = 0;
+    std::uint64_t    total_ns = 0;
+    std::uint64_t    min_ns   = 0;
+    std::uint64_t    max_ns   = 0;
+    std::uint64_t    p50_ns   = 0;
+    std::uint64_t    p99_ns   = 0;
+    std::uint64_t    p999_ns  = 0;
   };
 
-  std::map<std::string_view, Statistic> statistics;
+  // Events held per thread between two TraceWriter::drain() calls; the
+  // buffer is only allocated once a thread records its first traced scope
+  static constexpr std::size_t TraceCapacity = std::size_t { 1 } << 14;
 
-  for (const auto& [tag, microseconds] : m_Records) {
-    auto& stat = statistics [tag];
-    stat.total_microseconds += microseconds;
-    stat.max_microseconds = std::max(stat.max_microseconds, microseconds);
-    stat.min_microseconds = !stat.count
-        ? microseconds
-        : std::min(stat.min_microseconds, microseconds);
-    stat.count++;
-    stat.tag = tag;
-  }
+  // A traced scope: where and when it ran, in ProfilerClock ticks
+  struct TraceEvent
+  {
+    const char*   tag;
+    std::uint64_t begin;
+    std::uint64_t end;
+    std::uint32_t thread;  // profiler thread number, counted from 1
+    std::uint32_t depth;   // profiled scopes around this one
+  };
+
+  // Counter records held per thread between two collect() calls, for the
+  // scopes of ScopeCounters; allocated on the first one
+  static constexpr std::size_t CounterCapacity = std::size_t { 1 } << 10;
+
+  // Per-tag hardware counter totals of ScopeCounters scopes
+  struct CounterStatistic
+  {
+    std::string_view tag;
+    std::uint64_t    count    = 0;
+    std::uint64_t    elements = 0;
+    PerfSample       totals;  // valid: counted in every one of the scopes,
+                              // scaled: extrapolated in any of them
+  };
+
+private:
+
+  // Fields are relaxed atomics so that a reporter reading a slot the owner is
+  // overwriting is a detected loss and not a data race
+  struct Record
+  {
+    std::atomic<const char*>   tag { nullptr };
+    std::atomic<std::uint64_t> ticks { 0 };
+  };
+
+  struct TraceSlot
+  {
+    std::atomic<const char*>   tag { nullptr };
+    std::atomic<std::uint64_t> begin { 0 };
+    std::atomic<std::uint64_t> end { 0 };
+    std::atomic<std::uint32_t> thread { 0 };
+    std::atomic<std::uint32_t> depth { 0 };
+  };
+
+  struct CounterSlot
+  {
+    std::atomic<const char*>                                tag { nullptr };
+    std::atomic<std::uint64_t>                              elements { 0 };
+    std::atomic<std::uint32_t>                              valid { 0 };
+    std::atomic<std::uint32_t>                              scaled { 0 };
+    std::array<std::atomic<std::uint64_t>, PerfEventCount> values {};
+  };
 
-  struct StatisticCompare
+  struct CounterRing
   {
-    using value_type = std::pair<std::string_view, Statistic>;
+    std::array<CounterSlot, CounterCapacity> samples;
+    std::atomic<std::uint64_t>               head { 0 };
+    std::uint64_t                            tail = 0;
+  };
+
+  struct CounterRecord
+  {
+    const char*   tag;
+    std::uint64_t elements;
+    PerfSample    delta;
+  };
+
+  struct TraceRing
+  {
+    std::array<TraceSlot, TraceCapacity> events;
+    std::atomic<std::uint64_t>           head { 0 };
+    std::uint64_t                        tail = 0;
+  };
+
+  // Single-producer ring, the owning thread writes and collect() reads.
+  // Rings are never freed: a thread that exits hands its ring back, and the
+  // next thread to start profiling takes it over
+  struct ThreadRing
+  {
+    std::array<Record, RingCapacity> records;
+    std::atomic<std::uint64_t>       head { 0 };  // records ever written
+    std::uint64_t                    tail = 0;    // records collected
+    std::atomic<TraceRing*>          trace { nullptr };
+    std::atomic<CounterRing*>        counters { nullptr };
+    std::atomic<bool>                in_use { true };
+    ThreadRing*                      next = nullptr;
 
-    bool operator() (const value_type& lhs, const value_type& rhs) const
+    ~ThreadRing()
     {
-      return lhs.second.total_microseconds > rhs.second.total_microseconds;
+      delete trace.load(std::memory_order_relaxed);
+      delete counters.load(std::memory_order_relaxed);
     }
   };
 
-  std::multiset<std::pair<std::string_view, Statistic>, StatisticCompare>
-      sorted_statistics(statistics.begin(), statistics.end());
+  struct Aggregate
+  {
+    std::mutex                                     mutex;
+    std::map<std::string_view, LogLinearHistogram> histograms;
+    std::map<std::string_view, CounterStatistic>   counters;
+    std::uint64_t                                  dropped       = 0;
+    std::uint64_t                                  trace_dropped = 0;
+  };
+
+  // Hands the ring back when its thread exits
+  struct RingOwner
+  {
+    ThreadRing* ring = nullptr;
 
-  auto format_duration = [&out](int value, int width) {
-    auto threshold = 1;
-    for (int i = 0; i < width - 1; ++i) {
-      threshold *= 10;
+    ~RingOwner()
+    {
+      if (ring != nullptr) ring->in_use.store(false, std::memory_order_release);
     }
+  };
 
-    if (value > threshold) {
-      if (value / 1000 > threshold / 10) {
-        out << std::setw(width - 1) << value / 1000000 << 'M';
-      } else {
-        out << std::setw(width - 1) << value / 1000 << 'k';
+  inline static std::atomic<ThreadRing*>   s_rings { nullptr };
+  inline static std::atomic<std::uint32_t> s_trace_every { 0 };
+  inline static std::atomic<std::uint32_t> s_next_thread { 1 };
+  inline static std::atomic<bool>          s_counters_missing { false };
+  inline thread_local static ThreadRing*   t_ring         = nullptr;
+  inline thread_local static std::uint32_t t_depth        = 0;
+  inline thread_local static std::uint32_t t_thread       = 0;
+  inline thread_local static std::uint32_t t_sample_count = 0;
+  inline thread_local static bool          t_traced       = false;
+
+  std::uint64_t m_begin;
+  const char*   m_tag;
+  std::uint32_t m_depth;
+
+  friend class TraceWriter;
+  friend class ScopeCounters;
+
+  static Aggregate& aggregate()
+  {
+    static Aggregate instance;
+    return instance;
+  }
+
+  static ThreadRing& acquire_ring()
+  {
+    thread_local RingOwner owner;
+
+    ThreadRing* ring = s_rings.load(std::memory_order_acquire);
+    for (; ring != nullptr; ring = ring->next) {
+      bool in_use = false;
+      if (ring->in_use.compare_exchange_strong(in_use, true,
+                                               std::memory_order_acquire)) {
+        break;
+      }
+    }
+    if (ring == nullptr) {
+      ring       = new ThreadRing();
+      ring->next = s_rings.load(std::memory_order_relaxed);
+      while (!s_rings.compare_exchange_weak(ring->next, ring,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {
       }
+    }
+    owner.ring = ring;
+    t_ring     = ring;
+    t_thread   = s_next_thread.fetch_add(1, std::memory_order_relaxed);
+    return *ring;
+  }
+
+  static void record(const char* tag, std::uint64_t ticks) noexcept
+  {
+    ThreadRing* ring = t_ring;
+    if (ring == nullptr) [[unlikely]] {
+      ring = &acquire_ring();
+    }
+    const std::uint64_t head = ring->head.load(std::memory_order_relaxed);
+    Record&             slot = ring->records [head % RingCapacity];
+    // Pairs with the fence in drain_ring(): a reader that sees this
+    // overwrite also sees the head that makes it discard the slot
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.tag.store(tag, std::memory_order_relaxed);
+    slot.ticks.store(ticks, std::memory_order_relaxed);
+    ring->head.store(head + 1, std::memory_order_release);
+  }
+
+  // Called after record(), so the thread has its ring
+  static void record_trace(const char* tag, std::uint64_t begin,
+                           std::uint64_t end, std::uint32_t depth)
+  {
+    ThreadRing& ring  = *t_ring;
+    TraceRing*  trace = ring.trace.load(std::memory_order_relaxed);
+    if (trace == nullptr) [[unlikely]] {
+      trace = new TraceRing();
+      ring.trace.store(trace, std::memory_order_release);
+    }
+    const std::uint64_t head = trace->head.load(std::memory_order_relaxed);
+    TraceSlot&          slot = trace->events [head % TraceCapacity];
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.tag.store(tag, std::memory_order_relaxed);
+    slot.begin.store(begin, std::memory_order_relaxed);
+    slot.end.store(end, std::memory_order_relaxed);
+    slot.thread.store(t_thread, std::memory_order_relaxed);
+    slot.depth.store(depth, std::memory_order_relaxed);
+    trace->head.store(head + 1, std::memory_order_release);
+  }
+
+  static void record_counters(const char* tag, const PerfSample& delta,
+                              std::uint64_t elements)
+  {
+    ThreadRing* ring = t_ring;
+    if (ring == nullptr) [[unlikely]] {
+      ring = &acquire_ring();
+    }
+    CounterRing* counters = ring->counters.load(std::memory_order_relaxed);
+    if (counters == nullptr) [[unlikely]] {
+      counters = new CounterRing();
+      ring->counters.store(counters, std::memory_order_release);
+    }
+    const std::uint64_t head = counters->head.load(std::memory_order_relaxed);
+    CounterSlot&        slot = counters->samples [head % CounterCapacity];
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.tag.store(tag, std::memory_order_relaxed);
+    slot.elements.store(elements, std::memory_order_relaxed);
+    slot.valid.store(delta.valid, std::memory_order_relaxed);
+    slot.scaled.store(delta.scaled, std::memory_order_relaxed);
+    for (std::size_t i = 0; i < PerfEventCount; ++i) {
+      slot.values [i].store(delta.values [i], std::memory_order_relaxed);
+    }
+    counters->head.store(head + 1, std::memory_order_release);
+  }
+
+  // Hands the records of one ring to consume in order, read(index) copying
+  // a slot out; returns how many were lost to the owner lapping the reader.
+  // Caller holds the aggregate mutex
+  template<std::size_t Capacity, typename Read, typename Consume>
+  static std::uint64_t drain_ring(const std::atomic<std::uint64_t>& heads,
+                                  std::uint64_t& tail, Read&& read,
+                                  Consume&& consume)
+  {
+    std::uint64_t       dropped = 0;
+    const std::uint64_t head    = heads.load(std::memory_order_acquire);
+    if (head - tail > Capacity) {
+      dropped += head - tail - Capacity;
+      tail = head - Capacity;
+    }
+    while (tail < head) {
+      auto value = read(tail % Capacity);
+      // Once the owner got a whole ring ahead of this slot it may be
+      // rewriting it, so the slot and everything up to there is lost
+      std::atomic_thread_fence(std::memory_order_acquire);
+      const std::uint64_t now_head = heads.load(std::memory_order_relaxed);
+      if (now_head - tail >= Capacity) {
+        const std::uint64_t valid = now_head - Capacity + 1;
+        dropped += valid - tail;
+        tail = valid;
+        continue;
+      }
+      consume(value);
+      ++tail;
+    }
+    return dropped;
+  }
+
+  static void drain(ThreadRing& ring, Aggregate& into)
+  {
+    into.dropped += drain_ring<RingCapacity>(
+        ring.head, ring.tail,
+        [&ring](std::size_t index) {
+          const Record& slot = ring.records [index];
+          return std::pair { slot.tag.load(std::memory_order_relaxed),
+                             slot.ticks.load(std::memory_order_relaxed) };
+        },
+        [&into](const std::pair<const char*, std::uint64_t>& record) {
+          into.histograms [record.first].record(
+              ProfilerClock::to_nanoseconds(record.second));
+        });
+
+    CounterRing* counters = ring.counters.load(std::memory_order_acquire);
+    if (counters == nullptr) return;
+    into.dropped += drain_ring<CounterCapacity>(
+        counters->head, counters->tail,
+        [counters](std::size_t index) {
+          const CounterSlot& slot = counters->samples [index];
+          CounterRecord      record {
+            slot.tag.load(std::memory_order_relaxed),
+            slot.elements.load(std::memory_order_relaxed),
+            {},
+          };
+          record.delta.valid  = slot.valid.load(std::memory_order_relaxed);
+          record.delta.scaled = slot.scaled.load(std::memory_order_relaxed);
+          for (std::size_t i = 0; i < PerfEventCount; ++i) {
+            record.delta.values [i] =
+                slot.values [i].load(std::memory_order_relaxed);
+          }
+          return record;
+        },
+        [&into](const CounterRecord& record) {
+          CounterStatistic& stat = into.counters [record.tag];
+          stat.totals.valid =
+              stat.count == 0 ? record.delta.valid
+                              : stat.totals.valid & record.delta.valid;
+          stat.totals.scaled |= record.delta.scaled;
+          for (std::size_t i = 0; i < PerfEventCount; ++i) {
+            stat.totals.values [i] += record.delta.values [i];
+          }
+          stat.tag = record.tag;
+          stat.count += 1;
+          stat.elements += record.elements;
+        });
+  }
+
+  // Hands every thread's pending trace events to consume
+  template<typename Consume>
+  static void drain_trace(Consume&& consume)
+  {
+    Aggregate&      into = aggregate();
+    std::lock_guard lock(into.mutex);
+    for (ThreadRing* ring = s_rings.load(std::memory_order_acquire);
+         ring != nullptr; ring = ring->next) {
+      TraceRing* trace = ring->trace.load(std::memory_order_acquire);
+      if (trace == nullptr) continue;
+      into.trace_dropped += drain_ring<TraceCapacity>(
+          trace->head, trace->tail,
+          [trace](std::size_t index) {
+            const TraceSlot& slot = trace->events [index];
+            return TraceEvent {
+              slot.tag.load(std::memory_order_relaxed),
+              slot.begin.load(std::memory_order_relaxed),
+              slot.end.load(std::memory_order_relaxed),
+              slot.thread.load(std::memory_order_relaxed),
+              slot.depth.load(std::memory_order_relaxed),
+            };
+          },
+          consume);
+    }
+  }
+
+public:
+
+  explicit ScopeProfiler(const char* tag)
+      : m_begin(ProfilerClock::now()), m_tag(tag), m_depth(t_depth++)
+  {
+    // Sampling picks whole trees of scopes, so that a traced scope always
+    // shows up inside its traced parent
+    if (m_depth == 0) {
+      const std::uint32_t every = s_trace_every.load(std::memory_order_relaxed);
+      t_traced = every != 0 && ++t_sample_count % every == 0;
+    }
+  }
+
+  ~ScopeProfiler()
+  {
+    const std::uint64_t end = ProfilerClock::now();
+    --t_depth;
+    record(m_tag, end - m_begin);
+    if (t_traced) {
+      record_trace(m_tag, m_begin, end, m_depth);
+    }
+  }
+
+  ScopeProfiler(const ScopeProfiler&)             = delete;
+  ScopeProfiler& operator= (const ScopeProfiler&) = delete;
+
+  // Starts recording a trace event for one in every sample_every outermost
+  // scopes of each thread, and the scopes nested in it; read them out with
+  // TraceWriter
+  static void enable_trace(std::uint32_t sample_every = 1)
+  {
+    s_trace_every.store(std::max<std::uint32_t>(sample_every, 1),
+                        std::memory_order_relaxed);
+  }
+
+  // Scopes already open when this is called still finish their trace
+  static void disable_trace()
+  {
+    s_trace_every.store(0, std::memory_order_relaxed);
+  }
+
+  // Moves every thread's pending records into the per-tag histograms; call
+  // it from a reporter thread often enough that no ring laps
+  static void collect()
+  {
+    Aggregate&  into = aggregate();
+    std::lock_guard lock(into.mutex);
+    for (ThreadRing* ring = s_rings.load(std::memory_order_acquire);
+         ring != nullptr; ring = ring->next) {
+      drain(*ring, into);
+    }
+  }
+
+  // Collects, then summarizes every tag, by descending total time
+  static std::vector<Statistic> statistics()
+  {
+    collect();
+    Aggregate&      from = aggregate();
+    std::lock_guard lock(from.mutex);
+
+    std::vector<Statistic> result;
+    result.reserve(from.histograms.size());
+    for (const auto& [tag, histogram] : from.histograms) {
+      Statistic stat;
+      stat.tag      = tag;
+      stat.count    = histogram.count();
+      stat.total_ns = histogram.total();
+      stat.min_ns   = histogram.min();
+      stat.max_ns   = histogram.max();
+      stat.p50_ns   = histogram.percentile(0.5);
+      stat.p99_ns   = histogram.percentile(0.99);
+      stat.p999_ns  = histogram.percentile(0.999);
+      result.push_back(stat);
+    }
+    std::sort(result.begin(), result.end(),
+              [](const Statistic& lhs, const Statistic& rhs) {
+                return lhs.total_ns > rhs.total_ns;
+              });
+    return result;
+  }
+
+  // Collects, then the hardware counter totals of every ScopeCounters tag, by
+  // descending cycles
+  static std::vector<CounterStatistic> counter_statistics()
+  {
+    collect();
+    Aggregate&      from = aggregate();
+    std::lock_guard lock(from.mutex);
+
+    std::vector<CounterStatistic> result;
+    result.reserve(from.counters.size());
+    for (const auto& [tag, stat] : from.counters) {
+      result.push_back(stat);
+    }
+    std::sort(result.begin(), result.end(),
+              [](const CounterStatistic& lhs, const CounterStatistic& rhs) {
+                return lhs.totals [PerfEvent::Cycles] >
+                       rhs.totals [PerfEvent::Cycles];
+              });
+    return result;
+  }
+
+  // Records lost to full rings so far
+  static std::uint64_t dropped()
+  {
+    Aggregate&      from = aggregate();
+    std::lock_guard lock(from.mutex);
+    return from.dropped;
+  }
+
+  // Trace events lost to full rings so far
+  static std::uint64_t trace_dropped()
+  {
+    Aggregate&      from = aggregate();
+    std::lock_guard lock(from.mutex);
+    return from.trace_dropped;
+  }
+
+  // Forgets everything collected so far; pending records are discarded too
+  static void reset()
+  {
+    collect();
+    Aggregate&      into = aggregate();
+    std::lock_guard lock(into.mutex);
+    into.histograms.clear();
+    into.counters.clear();
+    into.dropped       = 0;
+    into.trace_dropped = 0;
+  }
+
+  static void print_log(std::ostream& out = std::cout);
+};
+
+inline void ScopeProfiler::print_log(std::ostream& out)
+{
+  const std::vector<Statistic> statistics = ScopeProfiler::statistics();
+  if (statistics.empty()) { return; }
+
+  // Nanoseconds scaled to fit width, e.g. "  12.3us"
+  auto format_duration = [&out](std::uint64_t value, int width) {
+    static constexpr std::array<const char*, 4> units { "ns", "us", "ms",
+                                                        "s " };
+    double      scaled = static_cast<double>(value);
+    std::size_t unit   = 0;
+    while (scaled >= 1000.0 && unit + 1 < units.size()) {
+      scaled /= 1000.0;
+      ++unit;
+    }
+    out << std::setw(width - 2) << std::fixed
+        << std::setprecision(unit == 0 ? 0 : 1) << scaled << units [unit];
+  };
+
+  auto format_count = [&out](std::uint64_t value, int width) {
+    if (value >= 10000000) {
+      out << std::setw(width - 1) << value / 1000000 << 'M';
+    } else if (value >= 100000) {
+      out << std::setw(width - 1) << value / 1000 << 'k';
     } else {
       out << std::setw(width) << value;
     }
   };
 
-  out << "   avg   |   min   |   max   |  total  | cnt | tag\n";
-  for (const auto& [tag, stat] : sorted_statistics) {
-    format_duration(stat.total_microseconds / stat.count, 9);
+  const auto flags     = out.flags();
+  const auto precision = out.precision();
+  out << "   avg   |   p50   |   p99   |  p999   |   max   |  total  |  cnt  "
+         "| tag\n";
+  for (const Statistic& stat : statistics) {
+    format_duration(stat.total_ns / stat.count, 9);
+    out << '|';
+    format_duration(stat.p50_ns, 9);
     out << '|';
-    format_duration(stat.min_microseconds, 9);
+    format_duration(stat.p99_ns, 9);
     out << '|';
-    format_duration(stat.max_microseconds, 9);
+    format_duration(stat.p999_ns, 9);
     out << '|';
-    format_duration(stat.total_microseconds, 9);
+    format_duration(stat.max_ns, 9);
     out << '|';
-    format_duration(stat.count, 5);
+    format_duration(stat.total_ns, 9);
     out << '|';
-    out << ' ' << tag << '\n';
+    format_count(stat.count, 7);
+    out << '|';
+    out << ' ' << stat.tag << '\n';
   }
+
+  // Per element of work, "-" where the host lacks the counter
+  const std::vector<CounterStatistic> counters = counter_statistics();
+  auto format_ratio = [&out](const PerfSample& totals, PerfEvent event,
+                             double per, int width) {
+    if (!totals.has(event)) {
+      out << std::setw(width) << '-';
+      return;
+    }
+    const double ratio = static_cast<double>(totals [event]) / per;
+    if (ratio >= 100000.0) {
+      out << std::setw(width - 1) << std::setprecision(1) << ratio / 1000.0
+          << 'k';
+    } else {
+      out << std::setw(width) << std::setprecision(2) << ratio;
+    }
+  };
+  if (!counters.empty()) {
+    out << "\n  IPC  | cyc/el  | inst/el | cmiss/el | brmiss/el | llc/el  "
+           "| dtlb/el | elements | tag\n";
+  }
+  bool any_scaled = false;
+  for (const CounterStatistic& stat : counters) {
+    const PerfSample& totals = stat.totals;
+    if (totals.has(PerfEvent::Cycles) && totals.has(PerfEvent::Instructions) &&
+        totals [PerfEvent::Cycles] != 0) {
+      out << std::setw(7) << std::fixed << std::setprecision(2)
+          << static_cast<double>(totals [PerfEvent::Instructions]) /
+                 static_cast<double>(totals [PerfEvent::Cycles]);
+    } else {
+      out << std::setw(7) << '-';
+    }
+    const double per =
+        stat.elements != 0 ? static_cast<double>(stat.elements) : 1.0;
+    out << '|';
+    format_ratio(totals, PerfEvent::Cycles, per, 9);
+    out << '|';
+    format_ratio(totals, PerfEvent::Instructions, per, 9);
+    out << '|';
+    format_ratio(totals, PerfEvent::CacheMisses, per, 10);
+    out << '|';
+    format_ratio(totals, PerfEvent::BranchMisses, per, 11);
+    out << '|';
+    format_ratio(totals, PerfEvent::LlcLoads, per, 9);
+    out << '|';
+    format_ratio(totals, PerfEvent::DtlbMisses, per, 9);
+    out << '|';
+    format_count(stat.elements, 10);
+    out << '|';
+    out << ' ' << stat.tag;
+    if (totals.scaled != 0) {
+      out << " *";
+      any_scaled = true;
+    }
+    out << '\n';
+  }
+  if (any_scaled) {
+    out << "(* counters multiplexed by the kernel, counts scaled up from the "
+           "time they ran)\n";
+  }
+  if (s_counters_missing.load(std::memory_order_relaxed)) {
+    out << "(hardware counters unavailable, ScopeCounters measured time "
+           "only)\n";
+  }
+  if (const std::uint64_t lost = dropped(); lost != 0) {
+    out << "(" << lost << " records dropped, collect() more often)\n";
+  }
+  out.flags(flags);
+  out.precision(precision);
 }
+
+// Times a scope like ScopeProfiler under the same tag, and also counts the
+// PerfCounterGroup events of the calling thread in it. elements is the
+// amount of work done in the scope (keys sorted, rows filtered, ...), so
+// print_log() can report IPC and cache, branch and TLB misses per element.
+// Where the counters are unavailable it only measures time.
+class ScopeCounters
+{
+public:
+
+  explicit ScopeCounters(const char* tag, std::uint64_t elements = 1)
+      : m_timer(tag), m_tag(tag), m_elements(elements),
+        m_group(PerfCounterGroup::this_thread()), m_begin(m_group.read())
+  {
+  }
+
+  ~ScopeCounters()
+  {
+    const PerfSample end = m_group.read();
+    if (m_group.available()) {
+      ScopeProfiler::record_counters(m_tag, end - m_begin, m_elements);
+    } else {
+      ScopeProfiler::s_counters_missing.store(true, std::memory_order_relaxed);
+    }
+  }
+
+  ScopeCounters(const ScopeCounters&)             = delete;
+  ScopeCounters& operator= (const ScopeCounters&) = delete;
+
+  // For scopes that only learn how much work they did at the end
+  void set_elements(std::uint64_t elements) noexcept { m_elements = elements; }
+
+private:
+
+  // Constructed first and destroyed last, so the counters run inside the
+  // timed interval
+  ScopeProfiler           m_timer;
+  const char*             m_tag;
+  std::uint64_t           m_elements;
+  const PerfCounterGroup& m_group;
+  PerfSample              m_begin;
+};
+
+// ============================================================================
+// Trace Export
+// ============================================================================
+
+enum class TraceFormat
+{
+  ChromeJson,  // Chrome trace event JSON, opens in Perfetto and chrome://tracing
+  Binary,      // Compact stream, see TraceWriter
+};
+
+// Streams the trace events of ScopeProfiler::enable_trace() to out. Call
+// drain() now and then from a reporter thread, more often than a thread fills
+// its TraceCapacity events, and finish() (or let the writer go) to close the
+// stream. Events come out per thread in completion order, not sorted by time.
+//
+// ChromeJson writes one complete ("X") event per scope, timestamps in
+// microseconds since the writer was created and the nesting depth in args.
+//
+// Binary is little-endian: the magic "STDEXTRC", a u32 version (1) and an
+// f64 of nanoseconds per tick, then records that start with a kind byte.
+// Varints are LEB128, the delta is zigzag encoded.
+//   1 tag:   varint id, varint length, name bytes (each tag once, before use)
+//   2 event: varint thread, varint depth, varint tag id,
+//            varint begin ticks minus the previous event's, varint duration
+class TraceWriter
+{
+public:
+
+  explicit TraceWriter(std::ostream& out,
+                       TraceFormat   format = TraceFormat::ChromeJson)
+      : m_out(out), m_format(format), m_epoch(ProfilerClock::now()),
+        m_last_begin(m_epoch)
+  {
+    if (m_format == TraceFormat::ChromeJson) {
+      m_out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    } else {
+      m_out.write("STDEXTRC", 8);
+      write_le(std::uint32_t { 1 });
+      write_le(ProfilerClock::nanoseconds_per_tick());
+    }
+  }
+
+  ~TraceWriter() { finish(); }
+
+  TraceWriter(const TraceWriter&)             = delete;
+  TraceWriter& operator= (const TraceWriter&) = delete;
+
+  // Writes the events recorded since the last call, returns how many
+  std::size_t drain()
+  {
+    std::size_t written = 0;
+    ScopeProfiler::drain_trace([this, &written](const TraceEvent& event) {
+      if (m_format == TraceFormat::ChromeJson) {
+        write_json(event);
+      } else {
+        write_binary(event);
+      }
+      ++written;
+    });
+    return written;
+  }
+
+  // Drains and closes the stream; later calls do nothing
+  void finish()
+  {
+    if (m_finished) return;
+    drain();
+    if (m_format == TraceFormat::ChromeJson) {
+      m_out << "\n]}\n";
+    }
+    m_out.flush();
+    m_finished = true;
+  }
+
+private:
+
+  using TraceEvent = ScopeProfiler::TraceEvent;
+
+  std::ostream&                        m_out;
+  TraceFormat                          m_format;
+  std::uint64_t                        m_epoch;
+  std::uint64_t                        m_last_begin;
+  std::map<const char*, std::uint64_t> m_tag_ids;
+  bool                                 m_first    = true;
+  bool                                 m_finished = false;
+
+  template<typename Value>
+  void write_le(Value value)
+  {
+    unsigned char bytes [sizeof(Value)];
+    std::memcpy(bytes, &value, sizeof(Value));
+    if constexpr (std::endian::native == std::endian::big) {
+      std::reverse(std::begin(bytes), std::end(bytes));
+    }
+    m_out.write(reinterpret_cast<const char*>(bytes), sizeof(Value));
+  }
+
+  void write_varint(std::uint64_t value)
+  {
+    char        bytes [10];
+    std::size_t length = 0;
+    do {
+      const auto low = static_cast<unsigned char>(value & 0x7F);
+      value >>= 7;
+      bytes [length++] = static_cast<char>(value != 0 ? low | 0x80 : low);
+    } while (value != 0);
+    m_out.write(bytes, static_cast<std::streamsize>(length));
+  }
+
+  void write_binary(const TraceEvent& event)
+  {
+    auto [it, inserted] = m_tag_ids.try_emplace(event.tag, m_tag_ids.size());
+    if (inserted) {
+      const std::string_view name(event.tag);
+      m_out.put(1);
+      write_varint(it->second);
+      write_varint(name.size());
+      m_out.write(name.data(), static_cast<std::streamsize>(name.size()));
+    }
+    const auto delta = static_cast<std::int64_t>(event.begin - m_last_begin);
+    m_last_begin     = event.begin;
+    m_out.put(2);
+    write_varint(event.thread);
+    write_varint(event.depth);
+    write_varint(it->second);
+    write_varint((static_cast<std::uint64_t>(delta) << 1) ^
+                 static_cast<std::uint64_t>(delta >> 63));
+    write_varint(event.end - event.begin);
+  }
+
+  void write_json(const TraceEvent& event)
+  {
+    const double microseconds_per_tick =
+        ProfilerClock::nanoseconds_per_tick() / 1000.0;
+    const double begin =
+        static_cast<double>(static_cast<std::int64_t>(event.begin - m_epoch)) *
+        microseconds_per_tick;
+    const double duration =
+        static_cast<double>(event.end - event.begin) * microseconds_per_tick;
+
+    m_out << (m_first ? "\n" : ",\n") << "{\"name\":\"";
+    m_first = false;
+    for (const char* c = event.tag; *c != '\0'; ++c) {
+      if (*c == '"' || *c == '\\') {
+        m_out << '\\' << *c;
+      } else if (static_cast<unsigned char>(*c) < 0x20) {
+        m_out << ' ';
+      } else {
+        m_out << *c;
+      }
+    }
+    const auto flags     = m_out.flags();
+    const auto precision = m_out.precision();
+    m_out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+          << std::fixed << std::setprecision(3) << ",\"ts\":" << begin
+          << ",\"dur\":" << duration << ",\"args\":{\"depth\":" << event.depth
+          << "}}";
+    m_out.flags(flags);
+    m_out.precision(precision);
+  }
+};
 }  // namespace stdex
 
 // Convenience macro for automatic scope profiling
@@ -143,6 +1030,17 @@ void ScopeProfiler::print_log(std::ostream& out)
 #else
 #  define STDEX_SCOPE_PROFILER stdex::ScopeProfiler _scope_profiler(__func__);
 #endif
+// The same with hardware counters, elements being the work done in the scope
+#if defined(__GNUC__) || defined(__clang__)
+#  define STDEX_SCOPE_COUNTERS(elements)                                  \
+    stdex::ScopeCounters _scope_counters(__PRETTY_FUNCTION__, (elements));
+#elif defined(_MSC_VER)
+#  define STDEX_SCOPE_COUNTERS(elements)                          \
+    stdex::ScopeCounters _scope_counters(__FUNCSIG__, (elements));
+#else
+#  define STDEX_SCOPE_COUNTERS(elements) \
+    stdex::ScopeCounters _scope_counters(__func__, (elements));
+#endif
 // Helper function to print profiler results
 inline void print_scope_profiler(std::ostream& out = std::cout)
 {
@@ -160,7 +1058,7 @@ void do_not_optimize(T volatile const& value)
 #if defined(_MSC_VER)
   (void)value;
 #elif defined(__GNUC__) || defined(__clang__)
-  asm volatile("" : "r"(std::addressof(value)) : "cc", "memory");
+  asm volatile("" : : "r"(std::addressof(value)) : "memory");
 #endif
 }
 /*
@@ -180,17 +1078,31 @@ void slow_function() {
 }
 
 int main() {
-    for (int i = 0; i < 5; ++i) {
-        quick_function();
-    }
+    std::thread worker([] {
+        for (int i = 0; i < 5; ++i) {
+            quick_function();
+        }
+    });
 
     for (int i = 0; i < 3; ++i) {
         slow_function();
     }
+    worker.join();
 
-    // Print profiling results
+    // Print profiling results of both threads; a long-running program calls
+    // stdex::ScopeProfiler::collect() from a reporter thread now and then
     print_scope_profiler();
 
+    // Timeline of every 10th outermost scope per thread, for Perfetto
+    std::ofstream trace("trace.json");
+    stdex::TraceWriter writer(trace);
+    stdex::ScopeProfiler::enable_trace(10);
+    for (int i = 0; i < 100; ++i) {
+        quick_function();
+    }
+    stdex::ScopeProfiler::disable_trace();
+    writer.finish();
+
     return 0;
 }
 */
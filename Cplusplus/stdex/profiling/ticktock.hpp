@@ -3,6 +3,8 @@
 #include <chrono>
 #include <iostream>
 
+#include "perf_counters.hpp"
+
 // Simple timing macros for measuring code execution time
 // Usage:
 //   TICK(my_timer);
@@ -18,3 +20,24 @@
                    std::chrono::steady_clock::now() - bench_##x)          \
                    .count();                                              \
   std::cerr << "s\n";
+
+// The same with hardware counters of the calling thread, and their ratios
+// per element of work (elements processed between TICK_PERF and TOCK_PERF)
+// Output: my_timer: 0.123456s, IPC 2.31, cycles/elem 4.12, ...
+
+#define TICK_PERF(x)                                                       \
+  auto perf_##x  = stdex::PerfCounterGroup::this_thread().read();          \
+  auto bench_##x = std::chrono::steady_clock::now();
+
+#define TOCK_PERF(x, elements)                                            \
+  {                                                                       \
+    auto seconds_##x =                                                    \
+        std::chrono::duration_cast<std::chrono::duration<double>>(        \
+            std::chrono::steady_clock::now() - bench_##x)                 \
+            .count();                                                     \
+    auto delta_##x =                                                      \
+        stdex::PerfCounterGroup::this_thread().read() - perf_##x;         \
+    std::cerr << #x ": " << seconds_##x << "s, ";                         \
+    stdex::print_perf_sample(std::cerr, delta_##x, (elements));           \
+    std::cerr << "\n";                                                    \
+  }